@@ -0,0 +1,84 @@
+//! Compares the caret-move bookmark checks through `ConfigManager::with_bookmark_index` against the copy-and-scan of
+//! `get_bookmarks` they replaced, on one document with 5,000 bookmarks and notes.
+//!
+//! Run with `cargo bench -p paperback-core --bench bookmark_lookup`.
+
+use std::{
+	fs,
+	hint::black_box,
+	time::{Duration, Instant},
+};
+
+use paperback_core::config::{Bookmark, ConfigManager};
+
+const BOOKMARK_COUNT: i64 = 5_000;
+const DOCUMENT_LEN: i64 = BOOKMARK_COUNT * 200;
+const QUERIES: i64 = 2_000;
+const PATH: &str = "textbook.epub";
+
+fn linear_entered(bookmarks: &[Bookmark], prev: i64, position: i64) -> (bool, bool) {
+	let inside =
+		|bm: &Bookmark, pos: i64| if bm.start == bm.end { pos == bm.start } else { pos >= bm.start && pos < bm.end };
+	let mut found = (false, false);
+	for bm in bookmarks.iter().filter(|bm| inside(bm, position) && !inside(bm, prev)) {
+		found = (found.0 || bm.note.is_empty(), found.1 || !bm.note.is_empty());
+	}
+	found
+}
+
+fn linear_next(mut bookmarks: Vec<Bookmark>, position: i64) -> Option<i64> {
+	bookmarks.sort_by_key(|bm| bm.start);
+	bookmarks.iter().find(|bm| bm.start > position).map(|bm| bm.start)
+}
+
+fn time(label: &str, mut f: impl FnMut(i64, i64)) -> Duration {
+	let step = DOCUMENT_LEN / QUERIES;
+	let start = Instant::now();
+	for q in 1..=QUERIES {
+		f((q - 1) * step, q * step);
+	}
+	let elapsed = start.elapsed();
+	println!("{label:<28} {:>12.3?} per query", elapsed / u32::try_from(QUERIES).unwrap_or(1));
+	elapsed
+}
+
+fn main() {
+	let dir = std::env::temp_dir().join("paperback_bookmark_lookup_bench");
+	let _ = fs::remove_dir_all(&dir);
+	fs::create_dir_all(&dir).unwrap();
+	let mut config = ConfigManager::new();
+	config.initialize(dir.join("paperback.toml"));
+	for i in 0..BOOKMARK_COUNT {
+		let start = i * 200;
+		let (end, note) = if i % 3 == 0 { (start, format!("note {i}")) } else { (start + 40, String::new()) };
+		config.add_bookmark(PATH, start, end, &note);
+	}
+	println!("{BOOKMARK_COUNT} bookmarks, {QUERIES} queries per case");
+	let pairs: [(&str, Duration, Duration); 2] = [
+		(
+			"caret move sound check",
+			time("  linear sound check", |prev, pos| {
+				black_box(linear_entered(&config.get_bookmarks(PATH), prev, pos));
+			}),
+			time("  indexed sound check", |prev, pos| {
+				black_box(config.with_bookmark_index(PATH, |index| index.entered(prev, pos).count()));
+			}),
+		),
+		(
+			"next bookmark",
+			time("  linear next bookmark", |_, pos| {
+				black_box(linear_next(config.get_bookmarks(PATH), pos));
+			}),
+			time("  indexed next bookmark", |_, pos| {
+				black_box(
+					config.with_bookmark_index(PATH, |index| index.next_after(pos, false).map(|(_, bm)| bm.start)),
+				);
+			}),
+		),
+	];
+	for (label, linear, indexed) in pairs {
+		println!("{label:<28} speedup {:.0}x", linear.as_secs_f64() / indexed.as_secs_f64().max(f64::EPSILON));
+	}
+	drop(config);
+	let _ = fs::remove_dir_all(dir);
+}
@@ -0,0 +1,91 @@
+//! Times `DocumentBuffer::with_content`, which builds the newline and position indexes, on about 16 MB of ASCII,
+//! Latin-1-heavy, CJK and emoji-heavy text. Each input is also indexed in 64 KB appends, the way parsers and streamed
+//! text files grow a buffer. A plain `char_indices` walk over the same text is printed alongside for reference.
+//!
+//! Run with `cargo bench -p paperback-core --bench buffer_indexing`.
+
+use std::{
+	hint::black_box,
+	time::{Duration, Instant},
+};
+
+use paperback_core::document::DocumentBuffer;
+
+const TARGET_BYTES: usize = 16 * 1024 * 1024;
+const APPEND_BYTES: usize = 64 * 1024;
+const RUNS: u32 = 3;
+
+const INPUTS: [(&str, &str); 4] = [
+	("ascii", "The quick brown fox jumps over the lazy dog, again and again.\n"),
+	("latin-1", "Größere Übungen für Anfänger: café, naïve, señor, déjà vu.\n"),
+	("cjk", "東京都の天気は晴れです。明日は雨が降るでしょう。\n"),
+	("emoji", "Launch day 🚀🎉 went well 👍😀, see you soon 🙂✨\n"),
+];
+
+fn repeated(line: &str) -> String {
+	line.repeat(TARGET_BYTES / line.len())
+}
+
+fn split_at_chars(text: &str, len: usize) -> Vec<&str> {
+	let mut parts = Vec::new();
+	let mut rest = text;
+	while !rest.is_empty() {
+		let mut end = len.min(rest.len());
+		while !rest.is_char_boundary(end) {
+			end += 1;
+		}
+		parts.push(&rest[..end]);
+		rest = &rest[end..];
+	}
+	parts
+}
+
+fn best_of(mut f: impl FnMut()) -> Duration {
+	let mut best = Duration::MAX;
+	for _ in 0..RUNS {
+		let start = Instant::now();
+		f();
+		best = best.min(start.elapsed());
+	}
+	best
+}
+
+fn throughput(bytes: usize, elapsed: Duration) -> f64 {
+	bytes as f64 / (1024.0 * 1024.0) / elapsed.as_secs_f64()
+}
+
+fn main() {
+	println!("best of {RUNS} runs, MB/s");
+	for (name, line) in INPUTS {
+		let text = repeated(line);
+		let whole = best_of(|| {
+			black_box(DocumentBuffer::with_content(text.clone()));
+		});
+		let parts = split_at_chars(&text, APPEND_BYTES);
+		let appended = best_of(|| {
+			let mut buffer = DocumentBuffer::new();
+			for part in &parts {
+				buffer.append(part);
+			}
+			black_box(buffer);
+		});
+		let walk = best_of(|| {
+			let mut newlines = Vec::new();
+			let mut utf16 = 0;
+			for (index, (_, ch)) in text.char_indices().enumerate() {
+				if ch == '\n' {
+					newlines.push(index);
+				}
+				utf16 += ch.len_utf16();
+			}
+			black_box((newlines, utf16));
+		});
+		println!(
+			"{name:>8} ({:>5} KB): with_content {:>8.0}  append {:>8.0}  char walk {:>8.0}",
+			text.len() / 1024,
+			throughput(text.len(), whole),
+			throughput(text.len(), appended),
+			throughput(text.len(), walk),
+		);
+	}
+}
@@ -0,0 +1,97 @@
+//! Times CHM topic conversion and table-of-contents parsing on a generated help file with 5,000 topics, from one
+//! conversion worker up to the machine's available parallelism.
+//!
+//! Writing a real CHM needs Microsoft's compiler, so the topics are generated already decompressed; this covers
+//! everything `ChmParser` does after libchm has read the entries.
+//!
+//! Run with `cargo bench -p paperback-core --bench chm_conversion`.
+
+use std::{
+	fmt::Write,
+	hint::black_box,
+	num::NonZeroUsize,
+	thread,
+	time::{Duration, Instant},
+};
+
+use paperback_core::parser::chm::{ChmPage, convert_pages, parse_hhc};
+
+const TOPICS: usize = 5_000;
+const RUNS: u32 = 3;
+
+fn generated_topics() -> Vec<ChmPage> {
+	(0..TOPICS)
+		.map(|i| {
+			let mut html = format!("<html><head><title>Topic {i}</title></head><body><h1 id=\"top\">Topic {i}</h1>");
+			for para in 0..6 {
+				let _ = write!(
+					html,
+					"<p>Paragraph {para} of topic {i} describes a <b>function</b> and its <i>parameters</i>. \
+					 See <a href=\"topic{}.htm#top\">the next topic</a>.</p>",
+					(i + 1) % TOPICS
+				);
+			}
+			html.push_str("<ul><li>First</li><li>Second</li></ul></body></html>");
+			ChmPage { number: i + 1, path: format!("/html/topic{i}.htm"), content: html.into_bytes() }
+		})
+		.collect()
+}
+
+fn generated_hhc() -> String {
+	let mut hhc = String::from("<html><body><ul>");
+	for chapter in 0..TOPICS / 50 {
+		let _ = write!(
+			hhc,
+			"<li><object type=\"text/sitemap\"><param name=\"Name\" value=\"Chapter {chapter}\"></object><ul>"
+		);
+		for i in chapter * 50..(chapter + 1) * 50 {
+			let _ = write!(
+				hhc,
+				"<li><object type=\"text/sitemap\"><param name=\"Name\" value=\"Topic {i}\">\
+				 <param name=\"Local\" value=\"html/topic{i}.htm\"></object>"
+			);
+		}
+		hhc.push_str("</ul>");
+	}
+	hhc.push_str("</ul></body></html>");
+	hhc
+}
+
+fn best_of(mut f: impl FnMut()) -> Duration {
+	let mut best = Duration::MAX;
+	for _ in 0..RUNS {
+		let start = Instant::now();
+		f();
+		best = best.min(start.elapsed());
+	}
+	best
+}
+
+/// Times converting `pages` with `workers` threads. `convert_pages` takes the pages by value, so every run gets a copy
+/// made up front rather than inside the timed region.
+fn time_conversion(pages: &[ChmPage], workers: usize) -> Duration {
+	let mut inputs: Vec<Vec<ChmPage>> = (0..RUNS).map(|_| pages.to_vec()).collect();
+	best_of(|| {
+		black_box(convert_pages(inputs.pop().unwrap(), false, workers));
+	})
+}
+
+fn main() {
+	let pages = generated_topics();
+	let hhc = generated_hhc();
+	println!("{TOPICS} generated topics: best of {RUNS} runs");
+	let toc = best_of(|| {
+		black_box(parse_hhc(&hhc));
+	});
+	println!("  parse .hhc: {toc:>10.2?}");
+	let max_workers = thread::available_parallelism().map_or(1, NonZeroUsize::get);
+	let baseline = time_conversion(&pages, 1);
+	println!("  1 worker:   {baseline:>10.2?}");
+	let mut workers = 2;
+	while workers <= max_workers {
+		let elapsed = time_conversion(&pages, workers);
+		let speedup = baseline.as_secs_f64() / elapsed.as_secs_f64();
+		println!("  {workers} workers: {elapsed:>10.2?}  ({speedup:.2}x)");
+		workers = if workers == max_workers { workers + 1 } else { (workers * 2).min(max_workers) };
+	}
+}
@@ -0,0 +1,115 @@
+//! Histograms how long the calling (UI) thread spends persisting the config after a reading-position change, with
+//! 8,000 documents in the history. "rewrite" is the old flush, which serialized and rewrote the whole file each time.
+//! "flush" is `ConfigManager::flush`, which hands the changed record to the writer thread. "sync" also waits for that
+//! write to reach the disk, the cost the writer thread now pays instead.
+//!
+//! Run with `cargo bench -p paperback-core --bench config_persistence`.
+
+use std::{
+	fs,
+	hint::black_box,
+	path::Path,
+	time::{Duration, Instant},
+};
+
+use paperback_core::config::{ConfigData, ConfigManager, DocumentConfig, StoredBookmark};
+
+const DOCUMENTS: usize = 8_000;
+const REWRITE_SAVES: usize = 100;
+const FLUSH_SAVES: usize = 2_000;
+/// Upper bounds of the histogram buckets, in microseconds.
+const BUCKETS_US: [u64; 7] = [10, 100, 1_000, 10_000, 100_000, 1_000_000, u64::MAX];
+
+fn document_path(index: usize) -> String {
+	format!("C:\\Users\\reader\\Books\\Author {}\\Book title number {index}.epub", index % 300)
+}
+
+fn populated_config() -> ConfigData {
+	let keys = ConfigManager::new();
+	let mut data = ConfigData::default();
+	for index in 0..DOCUMENTS {
+		let path = document_path(index);
+		let key = keys.get_doc_key(&path);
+		let position = i64::try_from(index).unwrap() * 1_000;
+		let doc = DocumentConfig {
+			path: path.clone(),
+			last_position: position,
+			navigation_history: (0..10).map(|step| position + step * 100).collect(),
+			navigation_history_index: 9,
+			bookmarks: (0..3)
+				.map(|step| StoredBookmark { start: step * 500, end: step * 500 + 20, note: format!("note {step}") })
+				.collect(),
+			..DocumentConfig::default()
+		};
+		data.documents.insert(key.clone(), doc);
+		data.path_hashes.insert(path, key);
+	}
+	data.recent_documents = (0..100).map(document_path).collect();
+	data
+}
+
+fn histogram(name: &str, samples: &mut [Duration]) {
+	samples.sort();
+	let percentile = |p: usize| samples[(samples.len() - 1) * p / 100];
+	println!(
+		"{name:>8}: {} saves, p50 {:?}, p99 {:?}, max {:?}",
+		samples.len(),
+		percentile(50),
+		percentile(99),
+		samples[samples.len() - 1]
+	);
+	let mut lower = 0;
+	for upper in BUCKETS_US {
+		let count = samples.iter().filter(|s| (lower..upper).contains(&u64::try_from(s.as_micros()).unwrap())).count();
+		let label = if upper == u64::MAX { format!(">= {lower} us") } else { format!("< {upper} us") };
+		println!("{label:>16} {count:>6} {}", "#".repeat(count * 60 / samples.len()));
+		lower = upper;
+	}
+}
+
+fn timed_saves(config: &ConfigManager, saves: usize, persist: impl Fn(&ConfigManager)) -> Vec<Duration> {
+	(0..saves)
+		.map(|save| {
+			config.set_document_position(&document_path(save % 100), i64::try_from(save).unwrap());
+			let start = Instant::now();
+			persist(config);
+			start.elapsed()
+		})
+		.collect()
+}
+
+fn open(dir: &Path, data: &ConfigData) -> ConfigManager {
+	let _ = fs::remove_dir_all(dir);
+	fs::create_dir_all(dir).unwrap();
+	let path = dir.join("paperback.toml");
+	fs::write(&path, toml::to_string_pretty(data).unwrap()).unwrap();
+	let mut config = ConfigManager::new();
+	config.initialize(path);
+	config
+}
+
+fn main() {
+	let dir = std::env::temp_dir().join("paperback_config_persistence_bench");
+	let data = populated_config();
+	println!("config file: {} KB", toml::to_string_pretty(&data).unwrap().len() / 1024);
+
+	let rewrite_path = dir.join("rewrite.toml");
+	let config = open(&dir, &data);
+	let mut rewrite = timed_saves(&config, REWRITE_SAVES, |_| {
+		black_box(fs::write(&rewrite_path, toml::to_string_pretty(&data).unwrap())).unwrap();
+	});
+	drop(config);
+	histogram("rewrite", &mut rewrite);
+
+	let config = open(&dir, &data);
+	let mut flush = timed_saves(&config, FLUSH_SAVES, ConfigManager::flush);
+	drop(config);
+	histogram("flush", &mut flush);
+
+	let config = open(&dir, &data);
+	let mut sync = timed_saves(&config, REWRITE_SAVES, ConfigManager::sync);
+	drop(config);
+	histogram("sync", &mut sync);
+
+	let _ = fs::remove_dir_all(dir);
+}
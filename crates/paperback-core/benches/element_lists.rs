@@ -0,0 +1,83 @@
+//! Times what opening the Elements dialog costs on a synthetic document with 40,000 links and 2,000 headings, half of
+//! which have no text of their own and are labeled by their line. "rebuild" is the per-open walk the dialog used to
+//! do, copying every label. "first open" builds the handle's cached lists, and "later opens" only borrow from them.
+//!
+//! Run with `cargo bench -p paperback-core --bench element_lists`.
+
+use std::{
+	hint::black_box,
+	time::{Duration, Instant},
+};
+
+use paperback_core::document::{Document, DocumentBuffer, DocumentHandle, Marker, MarkerType, is_heading_marker};
+
+const LINK_COUNT: usize = 40_000;
+const HEADING_EVERY: usize = 20;
+const LINE: &str = "See section 12.4(b) of the agreement for the applicable definitions.\n";
+const RUNS: u32 = 5;
+
+fn synthetic_handle() -> DocumentHandle {
+	let mut buffer = DocumentBuffer::new();
+	buffer.append(&LINE.repeat(LINK_COUNT));
+	for i in 0..LINK_COUNT {
+		let position = i * LINE.len();
+		let link = Marker::new(MarkerType::Link, position + 4);
+		buffer.add_marker(if i % 2 == 0 { link.with_text(format!("section {i}")) } else { link });
+		if i % HEADING_EVERY == 0 {
+			let heading = Marker::new(MarkerType::Heading2, position).with_level(2);
+			buffer.add_marker(if i % 40 == 0 { heading.with_text(format!("Article {i}")) } else { heading });
+		}
+	}
+	let mut doc = Document::new();
+	doc.set_buffer(buffer);
+	DocumentHandle::new(doc)
+}
+
+fn line_text(buffer: &DocumentBuffer, position: usize) -> String {
+	buffer.content[buffer.line_byte_range(position)].to_string()
+}
+
+fn rebuild(handle: &DocumentHandle) -> usize {
+	let buffer = &handle.document().buffer;
+	let label = |m: &Marker| if m.text.is_empty() { line_text(buffer, m.position) } else { m.text.clone() };
+	let links: Vec<(usize, String)> =
+		buffer.markers.iter().filter(|m| m.mtype == MarkerType::Link).map(|m| (m.position, label(m))).collect();
+	let headings: Vec<(usize, String)> =
+		buffer.markers.iter().filter(|m| is_heading_marker(m.mtype)).map(|m| (m.position, label(m))).collect();
+	links.len() + headings.len()
+}
+
+fn borrow_labels(handle: &DocumentHandle) -> usize {
+	let buffer = &handle.document().buffer;
+	let elements = handle.elements();
+	elements.links().iter().chain(elements.headings()).map(|e| e.label(buffer).len()).sum()
+}
+
+fn best_of(mut f: impl FnMut()) -> Duration {
+	let mut best = Duration::MAX;
+	for _ in 0..RUNS {
+		let start = Instant::now();
+		f();
+		best = best.min(start.elapsed());
+	}
+	best
+}
+
+fn main() {
+	println!("{LINK_COUNT} links, {} headings, best of {RUNS} runs", LINK_COUNT / HEADING_EVERY);
+	let handle = synthetic_handle();
+	let rebuilt = best_of(|| {
+		black_box(rebuild(&handle));
+	});
+	let fresh: Vec<DocumentHandle> = (0..RUNS).map(|_| handle.clone()).collect();
+	let mut fresh = fresh.iter();
+	let first = best_of(|| {
+		black_box(borrow_labels(fresh.next().unwrap()));
+	});
+	let later = best_of(|| {
+		black_box(borrow_labels(&handle));
+	});
+	println!("{:<16} {rebuilt:>12.3?}", "rebuild");
+	println!("{:<16} {first:>12.3?}", "first open");
+	println!("{:<16} {later:>12.3?}", "later opens");
+}
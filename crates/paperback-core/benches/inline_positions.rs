@@ -0,0 +1,62 @@
+//! Times `HtmlToText` and `XmlToText` on a synthetic single-paragraph XHTML file of about 1 MB with 100k inline
+//! spans, each of which asks the converter for its current text position. Smaller inputs are timed too, so the
+//! output shows whether conversion time grows linearly with the paragraph length.
+//!
+//! Run with `cargo bench -p paperback-core --bench inline_positions`.
+
+use std::{
+	fmt::Write,
+	hint::black_box,
+	time::{Duration, Instant},
+};
+
+use paperback_core::parser::{
+	html_to_text::{HtmlSourceMode, HtmlToText},
+	xml_to_text::XmlToText,
+};
+
+const SPAN_COUNTS: [usize; 3] = [25_000, 50_000, 100_000];
+const RUNS: u32 = 3;
+
+fn synthetic_paragraph(spans: usize) -> String {
+	let mut xhtml = String::from("<?xml version=\"1.0\" encoding=\"utf-8\"?>\n");
+	xhtml.push_str("<html xmlns=\"http://www.w3.org/1999/xhtml\"><head><title>Bench</title></head><body><p>");
+	for i in 0..spans {
+		// Every fourth span carries an id, like the footnote anchors in an annotated EPUB section.
+		if i % 4 == 0 {
+			let _ = write!(xhtml, "<i id=\"n{i}\">n</i> ");
+		} else {
+			xhtml.push_str("<b>w</b> ");
+		}
+	}
+	xhtml.push_str("</p></body></html>");
+	xhtml
+}
+
+fn best_of(mut f: impl FnMut()) -> Duration {
+	let mut best = Duration::MAX;
+	for _ in 0..RUNS {
+		let start = Instant::now();
+		f();
+		best = best.min(start.elapsed());
+	}
+	best
+}
+
+fn main() {
+	println!("best of {RUNS} runs");
+	for spans in SPAN_COUNTS {
+		let xhtml = synthetic_paragraph(spans);
+		let html = best_of(|| {
+			let mut converter = HtmlToText::new();
+			converter.convert(&xhtml, HtmlSourceMode::NativeHtml);
+			black_box(converter.get_text());
+		});
+		let xml = best_of(|| {
+			let mut converter = XmlToText::new();
+			converter.convert(&xhtml);
+			black_box(converter.get_text());
+		});
+		println!("{spans:>7} spans ({:>5} KB): HtmlToText {html:>10.2?}  XmlToText {xml:>10.2?}", xhtml.len() / 1024);
+	}
+}
@@ -0,0 +1,96 @@
+//! Compares marker navigation through `DocumentHandle`'s per-type index against the linear
+//! marker scans it replaced, on a synthetic document with one million markers.
+//!
+//! Run with `cargo bench -p paperback-core --bench marker_navigation`.
+
+use std::{
+	hint::black_box,
+	time::{Duration, Instant},
+};
+
+use paperback_core::document::{Document, DocumentBuffer, DocumentHandle, Marker, MarkerType};
+
+const MARKER_COUNT: usize = 1_000_000;
+const QUERIES: usize = 200;
+
+fn synthetic_handle() -> DocumentHandle {
+	let mut buffer = DocumentBuffer::new();
+	buffer.append(&"x".repeat(MARKER_COUNT * 4));
+	for i in 0..MARKER_COUNT {
+		let position = i * 4;
+		let marker = match i % 100 {
+			0 => Marker::new(MarkerType::PageBreak, position),
+			1 => Marker::new(MarkerType::Heading2, position).with_level(2),
+			2..=39 => Marker::new(MarkerType::Link, position),
+			40..=69 => Marker::new(MarkerType::Bold, position).with_length(3),
+			_ => Marker::new(MarkerType::Italic, position).with_length(3),
+		};
+		buffer.add_marker(marker);
+	}
+	let mut doc = Document::new();
+	doc.set_buffer(buffer);
+	DocumentHandle::new(doc)
+}
+
+fn linear_next(markers: &[Marker], position: i64, marker_type: MarkerType) -> Option<usize> {
+	markers.iter().position(|m| m.mtype == marker_type && i64::try_from(m.position).unwrap_or(i64::MAX) > position)
+}
+
+fn linear_next_heading(markers: &[Marker], position: i64, level: i32) -> Option<usize> {
+	let mut headings: Vec<(usize, &Marker)> = markers.iter().enumerate().filter(|(_, m)| m.level == level).collect();
+	headings.sort_by_key(|(_, m)| m.position);
+	headings.into_iter().find(|(_, m)| i64::try_from(m.position).unwrap_or(i64::MAX) > position).map(|(idx, _)| idx)
+}
+
+fn linear_page_index(markers: &[Marker], position: usize) -> usize {
+	markers.iter().filter(|m| m.mtype == MarkerType::PageBreak && m.position <= position).count()
+}
+
+fn time(label: &str, mut f: impl FnMut(i64)) -> Duration {
+	let step = i64::try_from(MARKER_COUNT * 4 / QUERIES).unwrap_or(1);
+	let start = Instant::now();
+	for q in 0..i64::try_from(QUERIES).unwrap_or(0) {
+		f(q * step);
+	}
+	let elapsed = start.elapsed();
+	println!("{label:<28} {:>12.3?} per query", elapsed / u32::try_from(QUERIES).unwrap_or(1));
+	elapsed
+}
+
+fn main() {
+	let handle = synthetic_handle();
+	let markers = &handle.document().buffer.markers;
+	println!("{MARKER_COUNT} markers, {QUERIES} queries per case");
+	let pairs: [(&str, Duration, Duration); 3] = [
+		(
+			"next page",
+			time("  linear next page", |p| {
+				black_box(linear_next(markers, p, MarkerType::PageBreak));
+			}),
+			time("  indexed next page", |p| {
+				black_box(handle.next_marker_index(p, MarkerType::PageBreak));
+			}),
+		),
+		(
+			"next heading (level 2)",
+			time("  linear next heading", |p| {
+				black_box(linear_next_heading(markers, p, 2));
+			}),
+			time("  indexed next heading", |p| {
+				black_box(handle.next_heading_marker_index(p, Some(2)));
+			}),
+		),
+		(
+			"page N of M",
+			time("  linear page index", |p| {
+				black_box(linear_page_index(markers, usize::try_from(p).unwrap_or(0)));
+			}),
+			time("  indexed page index", |p| {
+				black_box(handle.page_index(usize::try_from(p).unwrap_or(0)));
+			}),
+		),
+	];
+	for (label, linear, indexed) in pairs {
+		println!("{label:<28} speedup {:.0}x", linear.as_secs_f64() / indexed.as_secs_f64().max(f64::EPSILON));
+	}
+}
@@ -0,0 +1,50 @@
+//! Measures how PDF text extraction scales with the number of extraction workers, from one up to the
+//! machine's available parallelism, on a caller-supplied PDF.
+//!
+//! Run with `cargo bench -p paperback-core --bench pdf_extraction -- path/to/large.pdf`, or set
+//! `PAPERBACK_BENCH_PDF`. Needs the pdfium library to be loadable.
+
+use std::{
+	env,
+	hint::black_box,
+	num::NonZeroUsize,
+	thread,
+	time::{Duration, Instant},
+};
+
+use paperback_core::{document::ParserContext, parser::pdf::PdfParser};
+
+const RUNS: u32 = 3;
+
+fn time_extraction(parser: &PdfParser, context: &ParserContext, workers: usize) -> Duration {
+	let mut best = Duration::MAX;
+	for _ in 0..RUNS {
+		let start = Instant::now();
+		let doc = parser.parse_with_workers(context, workers, None).expect("failed to parse benchmark PDF");
+		black_box(doc);
+		best = best.min(start.elapsed());
+	}
+	best
+}
+
+fn main() {
+	let Some(path) =
+		env::args().skip(1).find(|arg| !arg.starts_with('-')).or_else(|| env::var("PAPERBACK_BENCH_PDF").ok())
+	else {
+		println!("pdf_extraction: no PDF given; pass a path or set PAPERBACK_BENCH_PDF");
+		return;
+	};
+	let context = ParserContext::new(path.clone());
+	let parser = PdfParser;
+	let max_workers = thread::available_parallelism().map_or(1, NonZeroUsize::get);
+	println!("{path}: best of {RUNS} runs");
+	let baseline = time_extraction(&parser, &context, 1);
+	println!("  1 worker:   {baseline:>10.2?}");
+	let mut workers = 2;
+	while workers <= max_workers {
+		let elapsed = time_extraction(&parser, &context, workers);
+		let speedup = baseline.as_secs_f64() / elapsed.as_secs_f64();
+		println!("  {workers} workers: {elapsed:>10.2?}  ({speedup:.2}x)");
+		workers = if workers == max_workers { workers + 1 } else { (workers * 2).min(max_workers) };
+	}
+}
@@ -1,20 +1,37 @@
 use std::{
-	cell::{Cell, RefCell},
+	cell::RefCell,
 	cmp::Ordering,
-	collections::HashMap,
+	collections::{HashMap, HashSet},
 	fs,
+	hash::BuildHasher,
+	mem,
 	path::{Path, PathBuf},
+	sync::atomic::{self, AtomicBool},
+	time::UNIX_EPOCH,
 };
 
 use base64::{Engine, engine::general_purpose::URL_SAFE_NO_PAD};
 use serde::{Deserialize, Serialize};
 use sha1::{Digest, Sha1};
 
-use crate::types::DocumentListItem;
+use crate::{
+	parser::util::parallel::{IN_FLIGHT_PER_WORKER, map_ordered},
+	types::DocumentListItem,
+};
+
+mod bookmarks;
+mod store;
+
+pub use bookmarks::BookmarkIndex;
+use store::{ConfigStore, ConfigWriter};
 
 const CONFIG_VERSION: u32 = 4;
 const DEFAULT_RECENT_DOCUMENTS_TO_SHOW: i64 = 25;
 const MAX_RECENT_DOCUMENTS_TO_SHOW: usize = 100;
+/// Threads used by [`find_missing_documents`]. Existence checks wait on the file system rather than the CPU, and on a
+/// network share mostly on round trips, so there are more of them than cores.
+const EXISTENCE_WORKERS: usize = 16;
+const EXISTENCE_BATCH: usize = 32;
 
 #[derive(Clone, Debug, Default)]
 pub struct Bookmark {
@@ -231,9 +248,53 @@ struct SidecarData {
 	bookmarks: Vec<StoredBookmark>,
 }
 
+/// The parts of a file's metadata that change when the file is rewritten or replaced.
+#[derive(Serialize, Deserialize, Clone, Copy, Debug, PartialEq, Eq)]
+pub struct FileStamp {
+	pub size: i64,
+	/// Modification time in nanoseconds since the Unix epoch.
+	pub modified: i64,
+	/// The inode on Unix and the creation time on Windows, so that a different file moved into place is noticed
+	/// even when its size and modification time match.
+	#[serde(default)]
+	pub file_id: i64,
+}
+
+impl FileStamp {
+	#[must_use]
+	pub fn of(path: &str) -> Option<Self> {
+		let metadata = fs::metadata(path).ok()?;
+		let modified = metadata.modified().ok()?.duration_since(UNIX_EPOCH).ok()?;
+		#[cfg(unix)]
+		let file_id = std::os::unix::fs::MetadataExt::ino(&metadata).cast_signed();
+		#[cfg(windows)]
+		let file_id = std::os::windows::fs::MetadataExt::creation_time(&metadata).cast_signed();
+		#[cfg(not(any(unix, windows)))]
+		let file_id = 0;
+		Some(Self {
+			size: i64::try_from(metadata.len()).unwrap_or(i64::MAX),
+			modified: i64::try_from(modified.as_nanos()).unwrap_or(i64::MAX),
+			file_id,
+		})
+	}
+}
+
+/// The document key computed from a file's content, with the file's stamp at the time. While the stamp still
+/// matches, the key is reused instead of reading and hashing the file again.
+#[derive(Serialize, Deserialize, Clone, Debug, PartialEq, Eq)]
+pub struct FileFingerprint {
+	#[serde(flatten)]
+	pub stamp: FileStamp,
+	pub doc_key: String,
+}
+
 #[derive(Serialize, Deserialize, Clone, Debug)]
 pub struct ConfigData {
 	pub version: u32,
+	/// Counts the compactions that produced this snapshot. A journal is only replayed over the snapshot of its own
+	/// generation, so one left behind by a crash mid-compaction cannot revert newer changes.
+	#[serde(default)]
+	pub journal_generation: u64,
 	#[serde(default)]
 	pub app: AppSettings,
 	#[serde(default)]
@@ -246,26 +307,197 @@ pub struct ConfigData {
 	pub documents: HashMap<String, DocumentConfig>,
 	#[serde(default)]
 	pub path_hashes: HashMap<String, String>,
+	#[serde(default, skip_serializing_if = "HashMap::is_empty")]
+	pub fingerprints: HashMap<String, FileFingerprint>,
 }
 
 impl Default for ConfigData {
 	fn default() -> Self {
 		Self {
 			version: CONFIG_VERSION,
+			journal_generation: 0,
 			app: AppSettings::default(),
 			recent_documents: Vec::new(),
 			opened_documents: Vec::new(),
 			find_history: Vec::new(),
 			documents: HashMap::new(),
 			path_hashes: HashMap::new(),
+			fingerprints: HashMap::new(),
 		}
 	}
 }
 
+/// What has changed since the last flush, so only those records are written.
+#[derive(Default)]
+struct PendingChanges {
+	app: bool,
+	/// Recent and opened documents and find history.
+	lists: bool,
+	/// Document keys that were updated or removed.
+	documents: HashSet<String>,
+	/// Paths whose document key was updated or removed.
+	path_hashes: HashSet<String>,
+	/// Paths whose fingerprint was updated or removed.
+	fingerprints: HashSet<String>,
+}
+
+impl PendingChanges {
+	fn is_empty(&self) -> bool {
+		!self.app
+			&& !self.lists
+			&& self.documents.is_empty()
+			&& self.path_hashes.is_empty()
+			&& self.fingerprints.is_empty()
+	}
+}
+
+/// One flush's worth of changes, holding each changed record whole.
+#[derive(Serialize, Deserialize, Default)]
+struct JournalEntry {
+	#[serde(default, skip_serializing_if = "HashSet::is_empty")]
+	removed_documents: HashSet<String>,
+	#[serde(default, skip_serializing_if = "HashSet::is_empty")]
+	removed_path_hashes: HashSet<String>,
+	#[serde(default, skip_serializing_if = "HashSet::is_empty")]
+	removed_fingerprints: HashSet<String>,
+	#[serde(default, skip_serializing_if = "Option::is_none")]
+	recent_documents: Option<Vec<String>>,
+	#[serde(default, skip_serializing_if = "Option::is_none")]
+	opened_documents: Option<Vec<String>>,
+	#[serde(default, skip_serializing_if = "Option::is_none")]
+	find_history: Option<Vec<String>>,
+	#[serde(default, skip_serializing_if = "Option::is_none")]
+	app: Option<AppSettings>,
+	#[serde(default, skip_serializing_if = "HashMap::is_empty")]
+	documents: HashMap<String, DocumentConfig>,
+	#[serde(default, skip_serializing_if = "HashMap::is_empty")]
+	path_hashes: HashMap<String, String>,
+	#[serde(default, skip_serializing_if = "HashMap::is_empty")]
+	fingerprints: HashMap<String, FileFingerprint>,
+}
+
+impl JournalEntry {
+	fn collect(data: &ConfigData, changes: &PendingChanges) -> Self {
+		let mut entry = Self::default();
+		if changes.app {
+			entry.app = Some(data.app.clone());
+		}
+		if changes.lists {
+			entry.recent_documents = Some(data.recent_documents.clone());
+			entry.opened_documents = Some(data.opened_documents.clone());
+			entry.find_history = Some(data.find_history.clone());
+		}
+		for key in &changes.documents {
+			match data.documents.get(key) {
+				Some(doc) => {
+					entry.documents.insert(key.clone(), doc.clone());
+				}
+				None => {
+					entry.removed_documents.insert(key.clone());
+				}
+			}
+		}
+		for path in &changes.path_hashes {
+			match data.path_hashes.get(path) {
+				Some(key) => {
+					entry.path_hashes.insert(path.clone(), key.clone());
+				}
+				None => {
+					entry.removed_path_hashes.insert(path.clone());
+				}
+			}
+		}
+		for path in &changes.fingerprints {
+			match data.fingerprints.get(path) {
+				Some(fingerprint) => {
+					entry.fingerprints.insert(path.clone(), fingerprint.clone());
+				}
+				None => {
+					entry.removed_fingerprints.insert(path.clone());
+				}
+			}
+		}
+		entry
+	}
+
+	fn apply(self, data: &mut ConfigData) {
+		for key in &self.removed_documents {
+			data.documents.remove(key);
+		}
+		for path in &self.removed_path_hashes {
+			data.path_hashes.remove(path);
+		}
+		for path in &self.removed_fingerprints {
+			data.fingerprints.remove(path);
+		}
+		if let Some(recent) = self.recent_documents {
+			data.recent_documents = recent;
+		}
+		if let Some(opened) = self.opened_documents {
+			data.opened_documents = opened;
+		}
+		if let Some(history) = self.find_history {
+			data.find_history = history;
+		}
+		if let Some(app) = self.app {
+			data.app = app;
+		}
+		data.documents.extend(self.documents);
+		data.path_hashes.extend(self.path_hashes);
+		data.fingerprints.extend(self.fingerprints);
+	}
+
+	/// Folds a later entry into this one, so that applying the result is the same as applying both in order.
+	fn merge(&mut self, later: Self) {
+		for key in later.removed_documents {
+			self.documents.remove(&key);
+			self.removed_documents.insert(key);
+		}
+		for (key, doc) in later.documents {
+			self.removed_documents.remove(&key);
+			self.documents.insert(key, doc);
+		}
+		for path in later.removed_path_hashes {
+			self.path_hashes.remove(&path);
+			self.removed_path_hashes.insert(path);
+		}
+		for (path, key) in later.path_hashes {
+			self.removed_path_hashes.remove(&path);
+			self.path_hashes.insert(path, key);
+		}
+		for path in later.removed_fingerprints {
+			self.fingerprints.remove(&path);
+			self.removed_fingerprints.insert(path);
+		}
+		for (path, fingerprint) in later.fingerprints {
+			self.removed_fingerprints.remove(&path);
+			self.fingerprints.insert(path, fingerprint);
+		}
+		if later.recent_documents.is_some() {
+			self.recent_documents = later.recent_documents;
+		}
+		if later.opened_documents.is_some() {
+			self.opened_documents = later.opened_documents;
+		}
+		if later.find_history.is_some() {
+			self.find_history = later.find_history;
+		}
+		if later.app.is_some() {
+			self.app = later.app;
+		}
+	}
+}
+
+/// Keeps the config as a TOML snapshot plus an append-only journal next to it.
+///
+/// Each flush hands only the records that changed since the last one to a writer thread, which appends them to the
+/// journal and, once the journal outgrows the snapshot, compacts the two into a new snapshot written through a rename.
 pub struct ConfigManager {
 	data: RefCell<ConfigData>,
-	config_path: PathBuf,
-	dirty: Cell<bool>,
+	changes: RefCell<PendingChanges>,
+	/// Bookmark indexes by doc key, built on first use and dropped whenever that document's bookmarks change.
+	bookmark_indexes: RefCell<HashMap<String, BookmarkIndex>>,
+	writer: Option<ConfigWriter>,
 	initialized: bool,
 }
 
@@ -280,31 +512,19 @@ impl ConfigManager {
 	pub fn new() -> Self {
 		Self {
 			data: RefCell::new(ConfigData::default()),
-			config_path: PathBuf::new(),
-			dirty: Cell::new(false),
+			changes: RefCell::new(PendingChanges::default()),
+			bookmark_indexes: RefCell::new(HashMap::new()),
+			writer: None,
 			initialized: false,
 		}
 	}
 
 	pub fn initialize(&mut self, config_path: PathBuf) -> bool {
-		let (data, needs_save) = if config_path.exists() {
-			match fs::read_to_string(&config_path).ok().and_then(|s| toml::from_str::<ConfigData>(&s).ok()) {
-				Some(d) => (d, false),
-				None => (ConfigData::default(), true),
-			}
-		} else {
-			(ConfigData::default(), true)
-		};
-
-		self.config_path = config_path;
+		let store = ConfigStore::open(config_path);
+		*self.data.borrow_mut() = store.data().clone();
+		self.bookmark_indexes.borrow_mut().clear();
+		self.writer = Some(ConfigWriter::spawn(store));
 		self.initialized = true;
-		*self.data.borrow_mut() = data;
-
-		if needs_save {
-			self.dirty.set(true);
-			self.flush();
-		}
-
 		true
 	}
 
@@ -318,9 +538,7 @@ impl ConfigManager {
 				return;
 			}
 		}
-		let digest = compute_document_hash(path);
-		let encoded = URL_SAFE_NO_PAD.encode(digest);
-		let new_key = format!("doc_{encoded}");
+		let new_key = Self::content_doc_key(path);
 
 		let mut data = self.data.borrow_mut();
 		if let Some(old_key) = data.path_hashes.get(path).cloned() {
@@ -328,9 +546,11 @@ impl ConfigManager {
 				if let Some(mut doc) = data.documents.remove(&old_key) {
 					doc.path = path.to_string();
 					data.documents.insert(new_key.clone(), doc);
+					self.mark_document(&old_key);
+					self.mark_document(&new_key);
 				}
 				data.path_hashes.insert(path.to_string(), new_key);
-				self.dirty.set(true);
+				self.mark_path_hash(path);
 			}
 		} else {
 			if !data.documents.contains_key(&new_key) {
@@ -342,21 +562,21 @@ impl ConfigManager {
 				if let Some(mut doc) = data.documents.remove(&old_key) {
 					doc.path = path.to_string();
 					data.documents.insert(new_key.clone(), doc);
+					self.mark_document(&old_key);
+					self.mark_document(&new_key);
 				}
 			}
 			data.path_hashes.insert(path.to_string(), new_key);
-			self.dirty.set(true);
+			self.mark_path_hash(path);
 		}
 	}
 
 	pub fn associate_uri_with_local_file(&self, uri: &str, local_path: &str) {
-		let digest = compute_document_hash(local_path);
-		let encoded = URL_SAFE_NO_PAD.encode(digest);
-		let new_key = format!("doc_{encoded}");
+		let new_key = self.fingerprinted_doc_key(local_path);
 
 		let mut data = self.data.borrow_mut();
 		data.path_hashes.insert(uri.to_string(), new_key);
-		self.dirty.set(true);
+		self.mark_path_hash(uri);
 	}
 
 	pub fn get_doc_key(&self, path: &str) -> String {
@@ -367,9 +587,7 @@ impl ConfigManager {
 			}
 		}
 
-		let digest = compute_document_hash(path);
-		let encoded = URL_SAFE_NO_PAD.encode(digest);
-		let new_key = format!("doc_{encoded}");
+		let new_key = Self::content_doc_key(path);
 
 		let mut data = self.data.borrow_mut();
 		if !data.documents.contains_key(&new_key) {
@@ -380,23 +598,82 @@ impl ConfigManager {
 
 			if let Some(doc) = data.documents.remove(&old_key) {
 				data.documents.insert(new_key.clone(), doc);
+				self.mark_document(&old_key);
+				self.mark_document(&new_key);
+				self.bookmark_indexes.borrow_mut().clear();
 			}
 		}
 
 		data.path_hashes.insert(path.to_string(), new_key.clone());
-		self.dirty.set(true);
+		self.mark_path_hash(path);
 		new_key
 	}
 
+	/// Hands what changed since the last flush to the writer thread, which persists it shortly afterwards. Only the
+	/// changed records are copied here; serializing and writing them happens off the calling thread.
 	pub fn flush(&self) {
-		if !self.initialized || !self.dirty.get() {
+		let Some(writer) = &self.writer else { return };
+		let changes = mem::take(&mut *self.changes.borrow_mut());
+		if changes.is_empty() {
 			return;
 		}
-		let data = self.data.borrow();
-		if let Ok(s) = toml::to_string_pretty(&*data) {
-			let _ = fs::write(&self.config_path, s);
-			self.dirty.set(false);
+		writer.write(JournalEntry::collect(&self.data.borrow(), &changes));
+	}
+
+	/// Flushes and waits until everything is on disk. For exit paths that end the process without dropping the
+	/// manager.
+	pub fn sync(&self) {
+		self.flush();
+		if let Some(writer) = &self.writer {
+			writer.sync();
+		}
+	}
+
+	fn mark_app(&self) {
+		self.changes.borrow_mut().app = true;
+	}
+
+	fn mark_lists(&self) {
+		self.changes.borrow_mut().lists = true;
+	}
+
+	fn mark_document(&self, key: &str) {
+		self.changes.borrow_mut().documents.insert(key.to_string());
+	}
+
+	fn mark_path_hash(&self, path: &str) {
+		self.changes.borrow_mut().path_hashes.insert(path.to_string());
+	}
+
+	fn mark_fingerprint(&self, path: &str) {
+		self.changes.borrow_mut().fingerprints.insert(path.to_string());
+	}
+
+	/// The key derived from the file's content hash, which reads up to 2 MB of the file. Callers record it in
+	/// `path_hashes`, so a path is hashed only the first time it is seen.
+	fn content_doc_key(path: &str) -> String {
+		format!("doc_{}", URL_SAFE_NO_PAD.encode(compute_document_hash(path)))
+	}
+
+	/// [`Self::content_doc_key`] for a local file that stands in for a URI. Only the URI is recorded in `path_hashes`,
+	/// so the key is kept with the local file's fingerprint instead and reused while the file's stamp is unchanged.
+	fn fingerprinted_doc_key(&self, path: &str) -> String {
+		let Some(stamp) = FileStamp::of(path) else {
+			// Files that cannot be read are keyed by a hash of the path, which is cheap.
+			return Self::content_doc_key(path);
+		};
+		if let Some(fingerprint) = self.data.borrow().fingerprints.get(path)
+			&& fingerprint.stamp == stamp
+		{
+			return fingerprint.doc_key.clone();
 		}
+		let doc_key = Self::content_doc_key(path);
+		self.data
+			.borrow_mut()
+			.fingerprints
+			.insert(path.to_string(), FileFingerprint { stamp, doc_key: doc_key.clone() });
+		self.mark_fingerprint(path);
+		doc_key
 	}
 
 	pub fn get_app_string(&self, key: &str, default_value: &str) -> String {
@@ -451,7 +728,7 @@ impl ConfigManager {
 			return;
 		}
 		self.data.borrow_mut().app.extra.insert(key.to_string(), toml::Value::String(value.to_string()));
-		self.dirty.set(true);
+		self.mark_app();
 	}
 
 	pub fn set_app_bool(&self, key: &str, value: bool) {
@@ -473,7 +750,7 @@ impl ConfigManager {
 				}
 			}
 		}
-		self.dirty.set(true);
+		self.mark_app();
 	}
 
 	pub fn set_app_int(&self, key: &str, value: i32) {
@@ -491,7 +768,7 @@ impl ConfigManager {
 				}
 			}
 		}
-		self.dirty.set(true);
+		self.mark_app();
 	}
 
 	pub fn get_readability_font(&self) -> ReadabilityFont {
@@ -532,7 +809,7 @@ impl ConfigManager {
 			data.app.font_color = i64::from(font.color);
 			data.app.extra.insert("font_encoding".to_string(), toml::Value::Integer(i64::from(font.encoding)));
 		}
-		self.dirty.set(true);
+		self.mark_app();
 	}
 
 	pub fn get_line_spacing(&self) -> i32 {
@@ -547,7 +824,7 @@ impl ConfigManager {
 			return;
 		}
 		self.data.borrow_mut().app.line_spacing = i64::from(value);
-		self.dirty.set(true);
+		self.mark_app();
 	}
 
 	pub fn get_bg_color(&self) -> i32 {
@@ -562,7 +839,7 @@ impl ConfigManager {
 			return;
 		}
 		self.data.borrow_mut().app.bg_color = i64::from(color);
-		self.dirty.set(true);
+		self.mark_app();
 	}
 
 	pub fn get_text_alignment(&self) -> i32 {
@@ -577,7 +854,7 @@ impl ConfigManager {
 			return;
 		}
 		self.data.borrow_mut().app.text_alignment = i64::from(value);
-		self.dirty.set(true);
+		self.mark_app();
 	}
 
 	pub fn get_letter_spacing(&self) -> i32 {
@@ -592,7 +869,7 @@ impl ConfigManager {
 			return;
 		}
 		self.data.borrow_mut().app.letter_spacing = i64::from(value);
-		self.dirty.set(true);
+		self.mark_app();
 	}
 
 	pub fn get_paragraph_spacing(&self) -> i32 {
@@ -607,7 +884,7 @@ impl ConfigManager {
 			return;
 		}
 		self.data.borrow_mut().app.paragraph_spacing = i64::from(value);
-		self.dirty.set(true);
+		self.mark_app();
 	}
 
 	pub fn get_hotkey(&self) -> HotkeyConfig {
@@ -622,7 +899,7 @@ impl ConfigManager {
 			return;
 		}
 		self.data.borrow_mut().app.hotkey = hotkey.clone();
-		self.dirty.set(true);
+		self.mark_app();
 	}
 
 	pub fn add_recent_document(&self, path: &str) {
@@ -632,7 +909,7 @@ impl ConfigManager {
 		{
 			let key = self.get_doc_key(path);
 			let mut data = self.data.borrow_mut();
-			Self::doc_entry_mut(&mut data, key, path);
+			self.doc_entry_mut(&mut data, key, path);
 			if let Some(idx) = data.recent_documents.iter().position(|p| p == path) {
 				data.recent_documents.remove(idx);
 			}
@@ -641,7 +918,7 @@ impl ConfigManager {
 				data.recent_documents.pop();
 			}
 		}
-		self.dirty.set(true);
+		self.mark_lists();
 	}
 
 	pub fn get_recent_documents(&self) -> Vec<String> {
@@ -661,7 +938,7 @@ impl ConfigManager {
 				data.opened_documents.push(path.to_string());
 			}
 		}
-		self.dirty.set(true);
+		self.mark_lists();
 	}
 
 	pub fn remove_opened_document(&self, path: &str) {
@@ -674,7 +951,7 @@ impl ConfigManager {
 				data.opened_documents.remove(idx);
 			}
 		}
-		self.dirty.set(true);
+		self.mark_lists();
 	}
 
 	pub fn get_opened_documents(&self) -> Vec<String> {
@@ -685,7 +962,10 @@ impl ConfigManager {
 	}
 
 	pub fn get_opened_documents_existing(&self) -> Vec<String> {
-		self.get_opened_documents().into_iter().filter(|path| Path::new(path).exists()).collect()
+		let opened = self.get_opened_documents();
+		let mut missing = HashSet::new();
+		find_missing_documents(&opened, &AtomicBool::new(false), |batch| missing.extend(batch));
+		opened.into_iter().filter(|path| !missing.contains(path)).collect()
 	}
 
 	pub fn get_find_settings(&self) -> FindSettings {
@@ -727,7 +1007,7 @@ impl ConfigManager {
 				data.find_history.pop();
 			}
 		}
-		self.dirty.set(true);
+		self.mark_lists();
 	}
 
 	pub fn set_document_position(&self, path: &str, position: i64) {
@@ -737,9 +1017,8 @@ impl ConfigManager {
 		{
 			let key = self.get_doc_key(path);
 			let mut data = self.data.borrow_mut();
-			Self::doc_entry_mut(&mut data, key, path).last_position = position;
+			self.doc_entry_mut(&mut data, key, path).last_position = position;
 		}
-		self.dirty.set(true);
 	}
 
 	#[must_use]
@@ -764,11 +1043,10 @@ impl ConfigManager {
 		{
 			let key = self.get_doc_key(path);
 			let mut data = self.data.borrow_mut();
-			let doc = Self::doc_entry_mut(&mut data, key, path);
+			let doc = self.doc_entry_mut(&mut data, key, path);
 			doc.navigation_history = history.to_vec();
 			doc.navigation_history_index = history_index;
 		}
-		self.dirty.set(true);
 	}
 
 	pub fn get_navigation_history(&self, path: &str) -> NavigationHistory {
@@ -792,9 +1070,8 @@ impl ConfigManager {
 		{
 			let key = self.get_doc_key(path);
 			let mut data = self.data.borrow_mut();
-			Self::doc_entry_mut(&mut data, key, path).opened = opened;
+			self.doc_entry_mut(&mut data, key, path).opened = opened;
 		}
-		self.dirty.set(true);
 	}
 
 	pub fn remove_document_history(&self, path: &str) {
@@ -808,8 +1085,10 @@ impl ConfigManager {
 				data.recent_documents.remove(idx);
 			}
 			data.documents.remove(&key);
+			self.mark_document(&key);
+			self.bookmark_indexes.borrow_mut().remove(&key);
 		}
-		self.dirty.set(true);
+		self.mark_lists();
 	}
 
 	pub fn rename_document_path(&self, old_path: &str, new_path: &str) {
@@ -831,9 +1110,12 @@ impl ConfigManager {
 			data.path_hashes.insert(new_path.to_string(), doc_key.clone());
 			if let Some(doc) = data.documents.get_mut(&doc_key) {
 				doc.path = new_path.to_string();
+				self.mark_document(&doc_key);
 			}
+			self.mark_path_hash(old_path);
+			self.mark_path_hash(new_path);
 		}
-		self.dirty.set(true);
+		self.mark_lists();
 	}
 
 	pub fn get_all_documents(&self) -> Vec<String> {
@@ -850,14 +1132,14 @@ impl ConfigManager {
 		{
 			let key = self.get_doc_key(path);
 			let mut data = self.data.borrow_mut();
-			let doc = Self::doc_entry_mut(&mut data, key, path);
+			let doc = self.doc_entry_mut(&mut data, key, path);
 			if doc.bookmarks.iter().any(|bm| bm.start == start && bm.end == end) {
 				return;
 			}
 			doc.bookmarks.push(StoredBookmark { start, end, note: note.to_string() });
 			doc.bookmarks.sort_by_key(|a| a.start);
 		}
-		self.dirty.set(true);
+		self.invalidate_bookmark_index(path);
 	}
 
 	pub fn remove_bookmark(&self, path: &str, start: i64, end: i64) {
@@ -867,16 +1149,16 @@ impl ConfigManager {
 		{
 			let key = self.get_doc_key(path);
 			let mut data = self.data.borrow_mut();
-			let doc = Self::doc_entry_mut(&mut data, key, path);
+			let doc = self.doc_entry_mut(&mut data, key, path);
 			if let Some(idx) = doc.bookmarks.iter().position(|bm| bm.start == start && bm.end == end) {
 				doc.bookmarks.remove(idx);
 			}
 		}
-		self.dirty.set(true);
+		self.invalidate_bookmark_index(path);
 	}
 
 	pub fn toggle_bookmark(&self, path: &str, start: i64, end: i64, note: &str) {
-		if self.get_bookmarks(path).iter().any(|bm| bm.start == start && bm.end == end) {
+		if self.with_bookmark_index(path, |index| index.starting_at(start).any(|bm| bm.end == end)) {
 			self.remove_bookmark(path, start, end);
 		} else {
 			self.add_bookmark(path, start, end, note);
@@ -890,12 +1172,12 @@ impl ConfigManager {
 		{
 			let key = self.get_doc_key(path);
 			let mut data = self.data.borrow_mut();
-			let doc = Self::doc_entry_mut(&mut data, key, path);
+			let doc = self.doc_entry_mut(&mut data, key, path);
 			if let Some(bm) = doc.bookmarks.iter_mut().find(|bm| bm.start == start && bm.end == end) {
 				bm.note = note.to_string();
 			}
 		}
-		self.dirty.set(true);
+		self.invalidate_bookmark_index(path);
 	}
 
 	pub fn get_bookmarks(&self, path: &str) -> Vec<Bookmark> {
@@ -912,6 +1194,26 @@ impl ConfigManager {
 			.unwrap_or_default()
 	}
 
+	/// Runs `f` on the position index of the document's bookmarks, building it if the bookmarks changed since it was
+	/// last used. Nothing is copied, so lookups made on every caret move should use this rather than
+	/// [`Self::get_bookmarks`]. `f` must not change the config.
+	pub fn with_bookmark_index<R>(&self, path: &str, f: impl FnOnce(&BookmarkIndex) -> R) -> R {
+		if !self.initialized {
+			return f(&BookmarkIndex::default());
+		}
+		let key = self.get_doc_key(path);
+		let mut indexes = self.bookmark_indexes.borrow_mut();
+		let index = indexes.entry(key).or_insert_with_key(|key| {
+			self.data.borrow().documents.get(key).map(|d| BookmarkIndex::new(&d.bookmarks)).unwrap_or_default()
+		});
+		f(index)
+	}
+
+	fn invalidate_bookmark_index(&self, path: &str) {
+		let key = self.get_doc_key(path);
+		self.bookmark_indexes.borrow_mut().remove(&key);
+	}
+
 	pub fn set_document_format(&self, path: &str, format: &str) {
 		if !self.initialized {
 			return;
@@ -919,9 +1221,8 @@ impl ConfigManager {
 		{
 			let key = self.get_doc_key(path);
 			let mut data = self.data.borrow_mut();
-			Self::doc_entry_mut(&mut data, key, path).format = format.to_string();
+			self.doc_entry_mut(&mut data, key, path).format = format.to_string();
 		}
-		self.dirty.set(true);
 	}
 
 	pub fn get_document_format(&self, path: &str) -> String {
@@ -939,9 +1240,8 @@ impl ConfigManager {
 		{
 			let key = self.get_doc_key(path);
 			let mut data = self.data.borrow_mut();
-			Self::doc_entry_mut(&mut data, key, path).password = password.to_string();
+			self.doc_entry_mut(&mut data, key, path).password = password.to_string();
 		}
-		self.dirty.set(true);
 	}
 
 	pub fn get_document_password(&self, path: &str) -> String {
@@ -978,8 +1278,9 @@ impl ConfigManager {
 		if !sidecar.bookmarks.is_empty() {
 			let key = self.get_doc_key(doc_path);
 			let mut data = self.data.borrow_mut();
-			Self::doc_entry_mut(&mut data, key, doc_path).bookmarks = sidecar.bookmarks;
-			self.dirty.set(true);
+			self.doc_entry_mut(&mut data, key, doc_path).bookmarks = sidecar.bookmarks;
+			drop(data);
+			self.invalidate_bookmark_index(doc_path);
 		}
 	}
 
@@ -1001,7 +1302,8 @@ impl ConfigManager {
 		}
 	}
 
-	fn doc_entry_mut<'a>(data: &'a mut ConfigData, key: String, path: &str) -> &'a mut DocumentConfig {
+	fn doc_entry_mut<'a>(&self, data: &'a mut ConfigData, key: String, path: &str) -> &'a mut DocumentConfig {
+		self.mark_document(&key);
 		let entry = data.documents.entry(key).or_default();
 		if entry.path.is_empty() {
 			entry.path = path.to_string();
@@ -1016,10 +1318,19 @@ impl Drop for ConfigManager {
 			return;
 		}
 		self.flush();
+		// The writer writes everything still pending before its thread exits.
+		drop(self.writer.take());
 	}
 }
 
-pub fn get_sorted_document_list(config: &ConfigManager, open_paths: &[String], filter: &str) -> Vec<DocumentListItem> {
+/// Lists recent documents first, then the rest by file name. Documents in `missing`, as reported by
+/// [`find_missing_documents`], are marked missing; the files themselves are not checked here.
+pub fn get_sorted_document_list<S: BuildHasher>(
+	config: &ConfigManager,
+	open_paths: &[String],
+	filter: &str,
+	missing: &HashSet<String, S>,
+) -> Vec<DocumentListItem> {
 	use crate::types::{DocumentListItem, DocumentListStatus};
 
 	let recent_docs = config.get_recent_documents();
@@ -1052,7 +1363,7 @@ pub fn get_sorted_document_list(config: &ConfigManager, open_paths: &[String], f
 			if !filter.is_empty() && !filename.to_lowercase().contains(&filter_lower) {
 				return None;
 			}
-			let status = if !path_obj.exists() {
+			let status = if missing.contains(&path) {
 				DocumentListStatus::Missing
 			} else if open_paths.contains(&path) {
 				DocumentListStatus::Open
@@ -1064,6 +1375,30 @@ pub fn get_sorted_document_list(config: &ConfigManager, open_paths: &[String], f
 		.collect()
 }
 
+/// Checks which of `paths` no longer exist, a batch at a time on worker threads, and passes each batch's missing paths
+/// to `on_missing` as soon as the batch is done.
+///
+/// Setting `cancel` stops the checks that have not started yet.
+pub fn find_missing_documents(paths: &[String], cancel: &AtomicBool, mut on_missing: impl FnMut(Vec<String>)) {
+	let cancelled = || cancel.load(atomic::Ordering::Relaxed);
+	map_ordered(
+		paths.chunks(EXISTENCE_BATCH).take_while(|_| !cancelled()),
+		EXISTENCE_WORKERS,
+		EXISTENCE_WORKERS * IN_FLIGHT_PER_WORKER,
+		|batch| {
+			if cancelled() {
+				return Vec::new();
+			}
+			batch.iter().filter(|path| !Path::new(path).exists()).cloned().collect::<Vec<_>>()
+		},
+		|_, missing| {
+			if !missing.is_empty() {
+				on_missing(missing);
+			}
+		},
+	);
+}
+
 #[must_use]
 pub fn compute_document_hash(path: &str) -> [u8; 20] {
 	let mut hasher = Sha1::new();
@@ -1115,6 +1450,8 @@ pub fn compute_document_hash(path: &str) -> [u8; 20] {
 
 #[cfg(test)]
 mod tests {
+	use std::io::Write;
+
 	use super::*;
 
 	#[test]
@@ -1147,4 +1484,201 @@ mod tests {
 		config.set_app_bool("render_tables_inline", true);
 		assert!(config.get_app_bool("render_tables_inline", true));
 	}
+
+	fn temp_config_path(name: &str) -> PathBuf {
+		let nanos = std::time::SystemTime::now().duration_since(std::time::UNIX_EPOCH).unwrap().as_nanos();
+		let dir = std::env::temp_dir().join(format!("paperback_config_test_{name}_{nanos}"));
+		fs::create_dir_all(&dir).unwrap();
+		dir.join("paperback.toml")
+	}
+
+	fn open_config(path: &Path) -> ConfigManager {
+		let mut config = ConfigManager::new();
+		config.initialize(path.to_path_buf());
+		config
+	}
+
+	#[test]
+	fn flushes_append_to_the_journal_and_replay_on_load() {
+		let path = temp_config_path("journal");
+		let config = open_config(&path);
+		let snapshot = fs::read(&path).unwrap();
+		config.set_document_position("a.txt", 42);
+		config.add_bookmark("a.txt", 1, 5, "note");
+		config.add_recent_document("b.txt");
+		config.set_app_bool("word_wrap", true);
+		config.flush();
+		config.remove_document_history("b.txt");
+		config.sync();
+		assert_eq!(fs::read(&path).unwrap(), snapshot);
+		assert!(store::journal_path(&path).exists());
+		drop(config);
+		let config = open_config(&path);
+		assert_eq!(config.get_document_position("a.txt"), 42);
+		assert_eq!(config.get_bookmarks("a.txt").len(), 1);
+		assert!(config.get_recent_documents().is_empty());
+		assert!(!config.get_all_documents().contains(&"b.txt".to_string()));
+		assert!(config.get_app_bool("word_wrap", false));
+		fs::remove_dir_all(path.parent().unwrap()).unwrap();
+	}
+
+	#[test]
+	fn merged_journal_entries_apply_like_the_originals_in_order() {
+		let doc = |position| DocumentConfig { last_position: position, ..DocumentConfig::default() };
+		let mut first = JournalEntry::default();
+		first.documents.insert("a".to_string(), doc(1));
+		first.documents.insert("b".to_string(), doc(2));
+		first.recent_documents = Some(vec!["a".to_string()]);
+		let mut second = JournalEntry::default();
+		second.removed_documents.insert("a".to_string());
+		second.documents.insert("b".to_string(), doc(3));
+		second.path_hashes.insert("b.txt".to_string(), "b".to_string());
+		let mut third = JournalEntry::default();
+		third.documents.insert("a".to_string(), doc(4));
+		third.removed_path_hashes.insert("b.txt".to_string());
+
+		let mut base = ConfigData::default();
+		base.documents.insert("c".to_string(), doc(5));
+		let mut sequential = base.clone();
+		let mut merged = base;
+		let mut combined = JournalEntry::default();
+		for entry in [first, second, third] {
+			toml::from_str::<JournalEntry>(&toml::to_string(&entry).unwrap()).unwrap().apply(&mut sequential);
+			combined.merge(entry);
+		}
+		combined.apply(&mut merged);
+		let summary = |data: &ConfigData| {
+			let mut positions: Vec<_> =
+				data.documents.iter().map(|(key, doc)| (key.clone(), doc.last_position)).collect();
+			positions.sort();
+			(positions, data.path_hashes.clone(), data.recent_documents.clone())
+		};
+		assert_eq!(summary(&merged), summary(&sequential));
+		assert_eq!(merged.documents["a"].last_position, 4);
+		assert!(merged.path_hashes.is_empty());
+	}
+
+	#[test]
+	fn local_file_key_is_reused_until_the_file_changes() {
+		let path = temp_config_path("fingerprint").with_file_name("book.txt");
+		fs::write(&path, "first").unwrap();
+		let path = path.to_str().unwrap();
+		let config = ConfigManager::new();
+		let key = config.get_doc_key(path);
+		// The path's own key lives in path_hashes, so only a URI's local stand-in is fingerprinted.
+		assert!(config.data.borrow().fingerprints.is_empty());
+		config.associate_uri_with_local_file("content://book", path);
+		assert_eq!(config.get_doc_key("content://book"), key);
+		config.data.borrow_mut().fingerprints.get_mut(path).unwrap().doc_key = "doc_cached".to_string();
+		assert_eq!(config.fingerprinted_doc_key(path), "doc_cached");
+		fs::write(path, "second, longer").unwrap();
+		let changed = config.fingerprinted_doc_key(path);
+		assert_ne!(changed, "doc_cached");
+		assert_ne!(changed, key);
+		fs::remove_dir_all(Path::new(path).parent().unwrap()).unwrap();
+	}
+
+	#[test]
+	fn missing_documents_are_found_across_batches() {
+		let path = temp_config_path("exists");
+		fs::write(&path, "").unwrap();
+		let existing = path.to_str().unwrap().to_string();
+		let paths: Vec<String> =
+			(0..200).map(|i| if i % 3 == 0 { format!("{existing}.missing{i}") } else { existing.clone() }).collect();
+		let mut missing = Vec::new();
+		find_missing_documents(&paths, &AtomicBool::new(false), |batch| missing.extend(batch));
+		let expected: Vec<String> = paths.iter().filter(|p| **p != existing).cloned().collect();
+		assert_eq!(missing, expected);
+		let mut after_cancel = Vec::new();
+		find_missing_documents(&paths, &AtomicBool::new(true), |batch| after_cancel.extend(batch));
+		assert!(after_cancel.is_empty());
+		fs::remove_dir_all(path.parent().unwrap()).unwrap();
+	}
+
+	#[test]
+	fn torn_journal_tail_is_dropped_and_compacted() {
+		let path = temp_config_path("torn");
+		let config = open_config(&path);
+		config.set_document_position("a.txt", 7);
+		drop(config);
+		let mut journal = fs::OpenOptions::new().append(true).open(store::journal_path(&path)).unwrap();
+		journal.write_all(b"#entry 500\n[documents.doc_x]\npath = ").unwrap();
+		drop(journal);
+		let config = open_config(&path);
+		assert_eq!(config.get_document_position("a.txt"), 7);
+		assert!(!store::journal_path(&path).exists());
+		let snapshot: ConfigData = toml::from_str(&fs::read_to_string(&path).unwrap()).unwrap();
+		assert!(snapshot.documents.values().any(|doc| doc.last_position == 7));
+		drop(config);
+		fs::remove_dir_all(path.parent().unwrap()).unwrap();
+	}
+
+	#[test]
+	fn journal_left_by_an_interrupted_compaction_is_not_replayed() {
+		let path = temp_config_path("stale");
+		let tear = |path: &Path| {
+			let mut journal = fs::OpenOptions::new().append(true).open(store::journal_path(path)).unwrap();
+			journal.write_all(b"#entry 500\n").unwrap();
+		};
+		let config = open_config(&path);
+		config.set_document_position("a.txt", 1);
+		drop(config);
+		let stale = fs::read(store::journal_path(&path)).unwrap();
+		// Each torn journal makes the next open compact, so the snapshot ends up newer than the saved journal.
+		tear(&path);
+		let config = open_config(&path);
+		config.set_document_position("a.txt", 2);
+		drop(config);
+		tear(&path);
+		drop(open_config(&path));
+		assert!(!store::journal_path(&path).exists());
+		// A crash after the snapshot was renamed into place but before the journal was removed.
+		fs::write(store::journal_path(&path), stale).unwrap();
+		let config = open_config(&path);
+		assert_eq!(config.get_document_position("a.txt"), 2);
+		assert!(!store::journal_path(&path).exists());
+		config.set_document_position("a.txt", 3);
+		drop(config);
+		assert_eq!(open_config(&path).get_document_position("a.txt"), 3);
+		fs::remove_dir_all(path.parent().unwrap()).unwrap();
+	}
+
+	#[test]
+	fn existing_toml_config_is_read_as_the_snapshot() {
+		let path = temp_config_path("legacy");
+		let key = ConfigManager::new().get_doc_key("a.txt");
+		let legacy = format!(
+			"version = 4\nrecent_documents = [\"a.txt\"]\n\n[documents.{key}]\npath = \"a.txt\"\nlast_position = 9\n"
+		);
+		fs::write(&path, legacy).unwrap();
+		let config = open_config(&path);
+		assert_eq!(config.get_document_position("a.txt"), 9);
+		assert_eq!(config.get_recent_documents(), vec!["a.txt".to_string()]);
+		config.set_document_position("a.txt", 10);
+		drop(config);
+		assert_eq!(open_config(&path).get_document_position("a.txt"), 10);
+		fs::remove_dir_all(path.parent().unwrap()).unwrap();
+	}
+
+	#[test]
+	fn bookmark_index_follows_bookmark_changes() {
+		let path = temp_config_path("bookmark_index");
+		let config = open_config(&path);
+		let notes_at = |position| {
+			config.with_bookmark_index("a.txt", |index| {
+				index.containing(position).map(|bm| bm.note.clone()).collect::<Vec<_>>()
+			})
+		};
+		assert!(notes_at(3).is_empty());
+		config.add_bookmark("a.txt", 1, 5, "");
+		config.toggle_bookmark("a.txt", 3, 3, "here");
+		assert_eq!(notes_at(3), vec!["here".to_string(), String::new()]);
+		config.update_bookmark_note("a.txt", 1, 5, "range");
+		config.toggle_bookmark("a.txt", 3, 3, "");
+		assert_eq!(notes_at(3), vec!["range".to_string()]);
+		config.remove_bookmark("a.txt", 1, 5);
+		assert!(notes_at(3).is_empty());
+		drop(config);
+		fs::remove_dir_all(path.parent().unwrap()).unwrap();
+	}
 }
@@ -0,0 +1,195 @@
+//! A document's bookmarks ordered by position, so caret-driven lookups need neither a scan nor a copy of the list.
+
+use super::{Bookmark, StoredBookmark};
+
+/// Bookmarks sorted by start, searchable by position.
+///
+/// The ones containing a position, and the next or previous one, are found by binary search. The index is built from
+/// the stored list and replaced whenever that list changes.
+#[derive(Debug, Default)]
+pub struct BookmarkIndex {
+	bookmarks: Vec<Bookmark>,
+	/// `reach[i]` is the first position past every bookmark in `bookmarks[..=i]`.
+	reach: Vec<i64>,
+	/// Indexes into `bookmarks` of the ones with a note, in the same order.
+	notes: Vec<usize>,
+}
+
+impl BookmarkIndex {
+	#[must_use]
+	pub fn new(stored: &[StoredBookmark]) -> Self {
+		let mut bookmarks: Vec<Bookmark> =
+			stored.iter().map(|bm| Bookmark { start: bm.start, end: bm.end, note: bm.note.clone() }).collect();
+		bookmarks.sort_by_key(|bm| bm.start);
+		let reach = bookmarks
+			.iter()
+			.scan(i64::MIN, |reach, bm| {
+				*reach = (*reach).max(bm.reach());
+				Some(*reach)
+			})
+			.collect();
+		let notes = bookmarks.iter().enumerate().filter(|(_, bm)| !bm.note.is_empty()).map(|(i, _)| i).collect();
+		Self { bookmarks, reach, notes }
+	}
+
+	/// All bookmarks, sorted by start.
+	#[must_use]
+	pub fn bookmarks(&self) -> &[Bookmark] {
+		&self.bookmarks
+	}
+
+	#[must_use]
+	pub const fn is_empty(&self) -> bool {
+		self.bookmarks.is_empty()
+	}
+
+	#[must_use]
+	pub const fn has_notes(&self) -> bool {
+		!self.notes.is_empty()
+	}
+
+	/// Bookmarks containing `position`, latest start first.
+	pub fn containing(&self, position: i64) -> impl Iterator<Item = &Bookmark> {
+		let candidates = self.bookmarks.partition_point(|bm| bm.start <= position);
+		// Once nothing up to `i` reaches past `position`, nothing before it can contain it either.
+		(0..candidates)
+			.rev()
+			.take_while(move |&i| self.reach[i] > position)
+			.map(|i| &self.bookmarks[i])
+			.filter(move |bm| bm.contains(position))
+	}
+
+	/// Bookmarks the caret enters by moving from `from` to `to`: those containing `to` but not `from`.
+	pub fn entered(&self, from: i64, to: i64) -> impl Iterator<Item = &Bookmark> {
+		self.containing(to).filter(move |bm| !bm.contains(from))
+	}
+
+	/// Bookmarks starting exactly at `position`, in stored order.
+	pub fn starting_at(&self, position: i64) -> impl Iterator<Item = &Bookmark> {
+		let first = self.bookmarks.partition_point(|bm| bm.start < position);
+		self.bookmarks[first..].iter().take_while(move |bm| bm.start == position)
+	}
+
+	/// The first bookmark starting after `position`, and its index among all bookmarks or, with `notes_only`, among
+	/// those with a note.
+	#[must_use]
+	pub fn next_after(&self, position: i64, notes_only: bool) -> Option<(usize, &Bookmark)> {
+		let index = self.partition_point(notes_only, |bm| bm.start <= position);
+		self.nth(index, notes_only).map(|bm| (index, bm))
+	}
+
+	/// The last bookmark starting before `position`, indexed as in [`Self::next_after`].
+	#[must_use]
+	pub fn previous_before(&self, position: i64, notes_only: bool) -> Option<(usize, &Bookmark)> {
+		let index = self.partition_point(notes_only, |bm| bm.start < position).checked_sub(1)?;
+		self.nth(index, notes_only).map(|bm| (index, bm))
+	}
+
+	fn partition_point(&self, notes_only: bool, pred: impl Fn(&Bookmark) -> bool) -> usize {
+		if notes_only {
+			self.notes.partition_point(|&i| pred(&self.bookmarks[i]))
+		} else {
+			self.bookmarks.partition_point(pred)
+		}
+	}
+
+	fn nth(&self, index: usize, notes_only: bool) -> Option<&Bookmark> {
+		if notes_only { self.notes.get(index).map(|&i| &self.bookmarks[i]) } else { self.bookmarks.get(index) }
+	}
+}
+
+impl Bookmark {
+	/// Whether the caret at `position` is on this bookmark. A whole-line bookmark (`start == end`) only covers its
+	/// start; a range covers `start..end`.
+	#[must_use]
+	pub const fn contains(&self, position: i64) -> bool {
+		if self.start == self.end { position == self.start } else { self.start <= position && position < self.end }
+	}
+
+	/// The first position past this bookmark.
+	const fn reach(&self) -> i64 {
+		if self.start == self.end { self.start.saturating_add(1) } else { self.end }
+	}
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+
+	fn stored(ranges: &[(i64, i64, &str)]) -> Vec<StoredBookmark> {
+		ranges.iter().map(|&(start, end, note)| StoredBookmark { start, end, note: note.to_string() }).collect()
+	}
+
+	/// Deterministic bookmarks mixing whole lines, short ranges and a few long ranges that overlap many others.
+	fn generated(count: i64) -> Vec<StoredBookmark> {
+		let mut state = 0x2545_f491_u64;
+		let mut next = |bound: i64| {
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			i64::try_from(state % u64::try_from(bound).unwrap()).unwrap()
+		};
+		(0..count)
+			.map(|i| {
+				let start = next(10_000);
+				let end = match i % 4 {
+					0 => start,
+					3 => start + next(3_000),
+					_ => start + next(50),
+				};
+				StoredBookmark { start, end, note: if i % 3 == 0 { format!("note {i}") } else { String::new() } }
+			})
+			.collect()
+	}
+
+	fn starts<'a>(bookmarks: impl Iterator<Item = &'a Bookmark>) -> Vec<(i64, i64)> {
+		let mut starts: Vec<(i64, i64)> = bookmarks.map(|bm| (bm.start, bm.end)).collect();
+		starts.sort_unstable();
+		starts
+	}
+
+	#[test]
+	fn containment_matches_a_linear_scan() {
+		let stored = generated(2_000);
+		let index = BookmarkIndex::new(&stored);
+		for position in (-5..13_100).step_by(7) {
+			let expected = starts(index.bookmarks().iter().filter(|bm| bm.contains(position)));
+			assert_eq!(starts(index.containing(position)), expected, "position {position}");
+		}
+	}
+
+	#[test]
+	fn entered_excludes_bookmarks_already_containing_the_old_position() {
+		let index = BookmarkIndex::new(&stored(&[(10, 20, ""), (15, 15, "n"), (18, 30, "")]));
+		assert_eq!(starts(index.entered(12, 15)), vec![(15, 15)]);
+		assert_eq!(starts(index.entered(15, 19)), vec![(18, 30)]);
+		assert_eq!(starts(index.entered(5, 19)), vec![(10, 20), (18, 30)]);
+		assert!(index.entered(19, 19).next().is_none());
+		assert!(index.entered(25, 20).next().is_none());
+	}
+
+	#[test]
+	fn next_and_previous_match_a_linear_scan() {
+		let stored = generated(500);
+		let index = BookmarkIndex::new(&stored);
+		for notes_only in [false, true] {
+			let list: Vec<&Bookmark> =
+				index.bookmarks().iter().filter(|bm| !notes_only || !bm.note.is_empty()).collect();
+			for position in (-3..13_100).step_by(11) {
+				let next = list.iter().position(|bm| bm.start > position);
+				assert_eq!(index.next_after(position, notes_only).map(|(i, _)| i), next);
+				let previous = list.iter().rposition(|bm| bm.start < position);
+				assert_eq!(index.previous_before(position, notes_only).map(|(i, _)| i), previous);
+			}
+		}
+	}
+
+	#[test]
+	fn starting_at_finds_every_bookmark_at_a_position() {
+		let index = BookmarkIndex::new(&stored(&[(8, 9, ""), (4, 4, ""), (4, 6, "n"), (2, 2, "")]));
+		assert_eq!(starts(index.starting_at(4)), vec![(4, 4), (4, 6)]);
+		assert!(index.starting_at(5).next().is_none());
+		assert!(index.has_notes());
+		assert!(BookmarkIndex::default().is_empty());
+	}
+}
@@ -0,0 +1,236 @@
+//! The config on disk: a TOML snapshot plus an append-only journal of changes, written by a dedicated thread so saving
+//! never blocks the thread that changed the config.
+
+use std::{
+	fs,
+	io::{self, Write},
+	path::{Path, PathBuf},
+	sync::mpsc::{self, Receiver, RecvTimeoutError, Sender},
+	thread::{self, JoinHandle},
+	time::{Duration, Instant},
+};
+
+use super::{ConfigData, JournalEntry};
+
+/// The journal is compacted once it is larger than the snapshot, but never while it is smaller than this.
+const MIN_COMPACTION_LEN: u64 = 256 * 1024;
+/// A journal starts with this header and the generation of the snapshot it applies to, on a line of its own.
+const JOURNAL_GENERATION_HEADER: &str = "#generation ";
+/// Each journal entry is this header and the byte length of the TOML that follows, on a line of its own.
+const JOURNAL_ENTRY_HEADER: &str = "#entry ";
+/// How long the writer holds a change so that changes made shortly after it are written together.
+const WRITE_DELAY: Duration = Duration::from_millis(500);
+
+/// The config files, along with a copy of what they hold so they can be compacted without asking the config's owner.
+pub(super) struct ConfigStore {
+	path: PathBuf,
+	data: ConfigData,
+	snapshot_len: u64,
+	journal_len: u64,
+	/// Set when the snapshot is missing or the journal may end in a partial entry, so the next write rewrites the
+	/// snapshot instead of appending behind it.
+	needs_compaction: bool,
+}
+
+impl ConfigStore {
+	/// Reads the snapshot at `path` and replays its journal over it. A torn entry left by a crash mid-append ends the
+	/// replay, and a journal from an older generation than the snapshot, left by a crash mid-compaction, is ignored.
+	/// A missing or unreadable snapshot, or a torn or stale journal, is compacted right away.
+	pub(super) fn open(path: PathBuf) -> Self {
+		let snapshot = fs::read_to_string(&path).ok().and_then(|s| toml::from_str::<ConfigData>(&s).ok());
+		let mut needs_compaction = snapshot.is_none();
+		let mut data = snapshot.unwrap_or_default();
+		let journal = fs::read(journal_path(&path)).unwrap_or_default();
+		let (generation, entries, complete) = parse_journal(&journal);
+		// Without a snapshot, whatever the journal holds is better than nothing.
+		if needs_compaction || generation == data.journal_generation {
+			for entry in entries {
+				entry.apply(&mut data);
+			}
+			needs_compaction |= !complete;
+		} else {
+			needs_compaction = true;
+		}
+		let snapshot_len = fs::metadata(&path).map_or(0, |m| m.len());
+		let mut store = Self { path, data, snapshot_len, journal_len: journal.len() as u64, needs_compaction };
+		if store.needs_compaction {
+			let _ = store.compact();
+		}
+		store
+	}
+
+	pub(super) const fn data(&self) -> &ConfigData {
+		&self.data
+	}
+
+	/// Appends `entry` to the journal, or compacts instead once the journal has outgrown the snapshot.
+	fn write(&mut self, entry: JournalEntry) {
+		if self.needs_compaction || self.journal_len > self.snapshot_len.max(MIN_COMPACTION_LEN) {
+			entry.apply(&mut self.data);
+			let _ = self.compact();
+		} else {
+			let appended = self.append(&entry);
+			entry.apply(&mut self.data);
+			// A failed append may have left part of the entry behind.
+			self.needs_compaction = appended.is_err();
+		}
+	}
+
+	/// Writes the whole config as a new snapshot of the next generation and drops the journal it supersedes. A crash
+	/// between the two steps leaves a journal that [`Self::open`] recognizes as stale.
+	fn compact(&mut self) -> io::Result<()> {
+		self.needs_compaction = true;
+		self.data.journal_generation += 1;
+		let text = toml::to_string_pretty(&self.data).map_err(io::Error::other)?;
+		write_atomically(&self.path, text.as_bytes())?;
+		self.snapshot_len = text.len() as u64;
+		match fs::remove_file(journal_path(&self.path)) {
+			Err(err) if err.kind() != io::ErrorKind::NotFound => return Err(err),
+			_ => {}
+		}
+		self.journal_len = 0;
+		self.needs_compaction = false;
+		Ok(())
+	}
+
+	fn append(&mut self, entry: &JournalEntry) -> io::Result<()> {
+		let body = toml::to_string(entry).map_err(io::Error::other)?;
+		let header = if self.journal_len == 0 {
+			format!("{JOURNAL_GENERATION_HEADER}{}\n", self.data.journal_generation)
+		} else {
+			String::new()
+		};
+		let record = format!("{header}{JOURNAL_ENTRY_HEADER}{}\n{body}", body.len());
+		let mut file = fs::OpenOptions::new().create(true).append(true).open(journal_path(&self.path))?;
+		file.write_all(record.as_bytes())?;
+		file.sync_data()?;
+		self.journal_len += record.len() as u64;
+		Ok(())
+	}
+}
+
+enum WriterMessage {
+	Write(Box<JournalEntry>),
+	/// Write whatever is pending now and acknowledge once it is on disk.
+	Sync(Sender<()>),
+}
+
+/// Owns a [`ConfigStore`] on a dedicated thread. Entries arriving within [`WRITE_DELAY`] of the first pending one are
+/// merged and written as one. Dropping the writer waits for everything handed to it to be written.
+pub(super) struct ConfigWriter {
+	sender: Option<Sender<WriterMessage>>,
+	thread: Option<JoinHandle<()>>,
+}
+
+impl ConfigWriter {
+	pub(super) fn spawn(store: ConfigStore) -> Self {
+		let (sender, receiver) = mpsc::channel();
+		let thread = thread::spawn(move || run_writer(store, &receiver));
+		Self { sender: Some(sender), thread: Some(thread) }
+	}
+
+	pub(super) fn write(&self, entry: JournalEntry) {
+		if let Some(sender) = &self.sender {
+			let _ = sender.send(WriterMessage::Write(Box::new(entry)));
+		}
+	}
+
+	/// Blocks until everything handed to the writer so far is on disk.
+	pub(super) fn sync(&self) {
+		let (ack, done) = mpsc::channel();
+		if let Some(sender) = &self.sender
+			&& sender.send(WriterMessage::Sync(ack)).is_ok()
+		{
+			let _ = done.recv();
+		}
+	}
+}
+
+impl Drop for ConfigWriter {
+	fn drop(&mut self) {
+		drop(self.sender.take());
+		if let Some(thread) = self.thread.take() {
+			let _ = thread.join();
+		}
+	}
+}
+
+fn run_writer(mut store: ConfigStore, receiver: &Receiver<WriterMessage>) {
+	let mut pending: Option<(JournalEntry, Instant)> = None;
+	loop {
+		let message = match &pending {
+			Some((_, deadline)) => receiver.recv_timeout(deadline.saturating_duration_since(Instant::now())),
+			None => receiver.recv().map_err(|_| RecvTimeoutError::Disconnected),
+		};
+		match message {
+			Ok(WriterMessage::Write(entry)) => match &mut pending {
+				Some((merged, _)) => merged.merge(*entry),
+				None => pending = Some((*entry, Instant::now() + WRITE_DELAY)),
+			},
+			Ok(WriterMessage::Sync(ack)) => {
+				write_pending(&mut store, pending.take());
+				let _ = ack.send(());
+			}
+			Err(RecvTimeoutError::Timeout) => write_pending(&mut store, pending.take()),
+			Err(RecvTimeoutError::Disconnected) => {
+				write_pending(&mut store, pending.take());
+				return;
+			}
+		}
+	}
+}
+
+fn write_pending(store: &mut ConfigStore, pending: Option<(JournalEntry, Instant)>) {
+	if let Some((entry, _)) = pending {
+		store.write(entry);
+	} else if store.needs_compaction {
+		let _ = store.compact();
+	}
+}
+
+pub(super) fn journal_path(config_path: &Path) -> PathBuf {
+	config_path.with_extension("journal")
+}
+
+/// Writes `contents` to a temporary file beside `path` and renames it into place, so readers and crashes only ever
+/// see the old file or the complete new one.
+fn write_atomically(path: &Path, contents: &[u8]) -> io::Result<()> {
+	let temp = path.with_extension("tmp");
+	let mut file = fs::File::create(&temp)?;
+	file.write_all(contents)?;
+	file.sync_all()?;
+	drop(file);
+	fs::rename(&temp, path)
+}
+
+/// Decodes the journal's generation and its entries in order. A journal without a generation header predates them
+/// and belongs to generation 0. Returns `false` as well if the journal ends in an entry that is incomplete or
+/// unreadable, which is where replay stops.
+fn parse_journal(bytes: &[u8]) -> (u64, Vec<JournalEntry>, bool) {
+	let (generation, mut rest) = parse_journal_generation(bytes).unwrap_or((0, bytes));
+	let mut entries = Vec::new();
+	while !rest.is_empty() {
+		let Some((entry, next)) = parse_journal_entry(rest) else {
+			return (generation, entries, false);
+		};
+		entries.push(entry);
+		rest = next;
+	}
+	(generation, entries, true)
+}
+
+fn parse_journal_generation(bytes: &[u8]) -> Option<(u64, &[u8])> {
+	let rest = bytes.strip_prefix(JOURNAL_GENERATION_HEADER.as_bytes())?;
+	let line_end = rest.iter().position(|&b| b == b'\n')?;
+	let generation = std::str::from_utf8(&rest[..line_end]).ok()?.parse().ok()?;
+	Some((generation, &rest[line_end + 1..]))
+}
+
+fn parse_journal_entry(bytes: &[u8]) -> Option<(JournalEntry, &[u8])> {
+	let rest = bytes.strip_prefix(JOURNAL_ENTRY_HEADER.as_bytes())?;
+	let line_end = rest.iter().position(|&b| b == b'\n')?;
+	let len: usize = std::str::from_utf8(&rest[..line_end]).ok()?.parse().ok()?;
+	let rest = &rest[line_end + 1..];
+	let body = std::str::from_utf8(rest.get(..len)?).ok()?;
+	Some((toml::from_str(body).ok()?, &rest[len..]))
+}
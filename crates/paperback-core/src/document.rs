@@ -1,11 +1,15 @@
-use std::collections::HashMap;
+use std::{cmp::Reverse, collections::HashMap, ops::Range, sync::OnceLock};
 
 use bitflags::bitflags;
+use encoding_rs::Encoding;
 
-use crate::{
-	types::HeadingInfo,
-	util::text::{display_len, is_space_like},
-};
+use crate::{types::HeadingInfo, util::text::is_space_like};
+
+mod elements;
+mod positions;
+
+pub use elements::{Element, Elements};
+pub use positions::PositionIndex;
 
 #[derive(Clone, Copy, Debug, PartialEq, Eq)]
 #[repr(i32)]
@@ -120,10 +124,10 @@ impl Marker {
 pub struct DocumentBuffer {
 	pub content: String,
 	pub markers: Vec<Marker>,
-	content_display_len: usize,
-	content_char_count: usize,
 	newline_char_positions: Vec<usize>,
-	char_to_byte_map: Vec<usize>,
+	positions: PositionIndex,
+	stats: DocumentStats,
+	has_carriage_returns: bool,
 }
 
 impl DocumentBuffer {
@@ -132,35 +136,19 @@ impl DocumentBuffer {
 		Self {
 			content: String::new(),
 			markers: Vec::new(),
-			content_display_len: 0,
-			content_char_count: 0,
 			newline_char_positions: Vec::new(),
-			char_to_byte_map: Vec::new(),
+			positions: PositionIndex::new(),
+			stats: DocumentStats::new(),
+			has_carriage_returns: false,
 		}
 	}
 
 	#[must_use]
 	pub fn with_content(content: String) -> Self {
-		let display = display_len(&content);
-		let mut char_count = 0usize;
-		let mut newline_char_positions = Vec::new();
-		let mut char_to_byte_map = Vec::with_capacity(content.len().min(1024));
-		for (byte_idx, c) in content.char_indices() {
-			char_to_byte_map.push(byte_idx);
-			if c == '\n' {
-				newline_char_positions.push(char_count);
-			}
-			char_count += 1;
-		}
-		char_to_byte_map.push(content.len()); // append end boundary
-		Self {
-			content,
-			markers: Vec::new(),
-			content_display_len: display,
-			content_char_count: char_count,
-			newline_char_positions,
-			char_to_byte_map,
-		}
+		let mut buffer = Self::new();
+		buffer.index(&content);
+		buffer.content = content;
+		buffer
 	}
 
 	pub fn add_marker(&mut self, marker: Marker) {
@@ -168,52 +156,110 @@ impl DocumentBuffer {
 	}
 
 	pub fn append(&mut self, text: &str) {
-		let base = self.content_char_count;
-		let mut count = 0usize;
+		self.index(text);
+		self.content.push_str(text);
+	}
 
-		// Remove the end boundary temporarily
-		if !self.char_to_byte_map.is_empty() {
-			self.char_to_byte_map.pop();
+	/// Like [`Self::append`], but takes ownership of `text`, which an empty buffer adopts as its content without
+	/// copying it.
+	pub fn append_owned(&mut self, text: String) {
+		if !self.content.is_empty() {
+			self.append(&text);
+			return;
 		}
+		self.index(&text);
+		self.content = text;
+	}
 
-		let start_byte = self.content.len();
-		for (byte_idx, c) in text.char_indices() {
-			self.char_to_byte_map.push(start_byte + byte_idx);
-			if c == '\n' {
-				self.newline_char_positions.push(base + count);
-			}
-			count += 1;
-		}
-		self.content.push_str(text);
-		self.char_to_byte_map.push(self.content.len()); // append end boundary back
-		self.content_display_len += display_len(text);
-		self.content_char_count += count;
+	/// Extends the position and newline indexes, the stats and the carriage return flag over `text`, which is about to
+	/// be appended to `content`. The stats reuse the char and newline counts the indexing just produced.
+	fn index(&mut self, text: &str) {
+		let previous_last = self.content.chars().next_back();
+		let chars_before = self.positions.char_count();
+		let newlines_before = self.newline_char_positions.len();
+		let newlines = &mut self.newline_char_positions;
+		self.positions.append(text, |pos| newlines.push(pos));
+		let chars = self.positions.char_count() - chars_before;
+		let newlines = self.newline_char_positions.len() - newlines_before;
+		self.stats.append_counted(previous_last, text, chars, newlines);
+		self.has_carriage_returns |= memchr::memchr(b'\r', text.as_bytes()).is_some();
+	}
+
+	/// The display/char/byte/UTF-16 translation index over `content`.
+	#[must_use]
+	pub const fn positions(&self) -> &PositionIndex {
+		&self.positions
 	}
 
 	#[must_use]
 	pub fn byte_index_for_char(&self, char_index: usize) -> usize {
-		self.char_to_byte_map.get(char_index).copied().unwrap_or(self.content.len())
+		self.positions.byte_for_char(&self.content, char_index)
 	}
 
 	#[must_use]
 	pub fn char_index_for_byte(&self, byte_index: usize) -> usize {
-		self.char_to_byte_map.binary_search(&byte_index).unwrap_or_else(|idx| idx)
+		self.positions.char_for_byte(&self.content, byte_index)
+	}
+
+	#[must_use]
+	pub fn char_index_for_display(&self, display_index: usize) -> usize {
+		self.positions.char_for_display(&self.content, display_index)
+	}
+
+	#[must_use]
+	pub fn display_index_for_char(&self, char_index: usize) -> usize {
+		self.positions.display_for_char(&self.content, char_index)
+	}
+
+	#[must_use]
+	pub fn byte_index_for_display(&self, display_index: usize) -> usize {
+		self.positions.byte_for_display(&self.content, display_index)
+	}
+
+	#[must_use]
+	pub fn display_index_for_byte(&self, byte_index: usize) -> usize {
+		self.positions.display_for_byte(&self.content, byte_index)
 	}
 
 	#[must_use]
 	pub const fn current_position(&self) -> usize {
-		self.content_display_len
+		self.positions.display_len()
 	}
 
 	#[must_use]
 	pub const fn char_count(&self) -> usize {
-		self.content_char_count
+		self.positions.char_count()
 	}
 
 	#[must_use]
 	pub fn newline_positions(&self) -> &[usize] {
 		&self.newline_char_positions
 	}
+
+	/// Byte range of the line holding display position `display_index`, without its newline.
+	#[must_use]
+	pub fn line_byte_range(&self, display_index: usize) -> Range<usize> {
+		let pos = self.char_index_for_display(display_index);
+		let line_start = match self.newline_char_positions.partition_point(|&p| p < pos) {
+			0 => 0,
+			idx => self.newline_char_positions[idx - 1] + 1,
+		};
+		let start = self.byte_index_for_char(line_start);
+		let end = self.content[start..].find('\n').map_or(self.content.len(), |i| start + i);
+		start..end
+	}
+
+	/// Word, line and char counts of `content`, kept up to date as text is appended.
+	#[must_use]
+	pub const fn stats(&self) -> &DocumentStats {
+		&self.stats
+	}
+
+	/// Whether `content` holds any `\r`, kept up to date as text is appended so callers need not scan for one.
+	#[must_use]
+	pub const fn has_carriage_returns(&self) -> bool {
+		self.has_carriage_returns
+	}
 }
 
 impl Default for DocumentBuffer {
@@ -222,6 +268,15 @@ impl Default for DocumentBuffer {
 	}
 }
 
+/// A run of text, with the markers that fall in it, reported while a document is still being parsed.
+#[derive(Debug, Clone, Default)]
+pub struct DocumentChunk {
+	/// Display position of the first character of `text` in the finished document.
+	pub start: usize,
+	pub text: String,
+	pub markers: Vec<Marker>,
+}
+
 #[derive(Debug, Clone)]
 pub struct TocItem {
 	pub name: String,
@@ -237,7 +292,7 @@ impl TocItem {
 	}
 }
 
-#[derive(Debug, Clone, Default)]
+#[derive(Debug, Clone, Copy, Default)]
 pub struct DocumentStats {
 	pub word_count: usize,
 	pub line_count: usize,
@@ -246,16 +301,61 @@ pub struct DocumentStats {
 }
 
 impl DocumentStats {
+	#[must_use]
+	pub const fn new() -> Self {
+		Self { word_count: 0, line_count: 0, char_count: 0, char_count_no_whitespace: 0 }
+	}
+
 	#[must_use]
 	pub fn from_text(text: &str) -> Self {
-		let char_count = text.chars().count();
-		let line_count = text.lines().count();
-		let word_count = text.split_whitespace().count();
-		let char_count_no_whitespace = text.chars().filter(|c| !is_space_like(*c)).count();
-		Self { word_count, line_count, char_count, char_count_no_whitespace }
+		let mut stats = Self::new();
+		let newlines = memchr::memchr_iter(b'\n', text.as_bytes()).count();
+		stats.append_counted(None, text, text.chars().count(), newlines);
+		stats
+	}
+
+	/// Updates the counts for `text`, which holds `chars` chars and `newlines` newlines and was appended after content
+	/// whose last character was `previous_last`. Gives the same result as counting the combined text from scratch,
+	/// with one pass over `text` for the words and whitespace.
+	fn append_counted(&mut self, previous_last: Option<char>, text: &str, chars: usize, newlines: usize) {
+		let Some(last) = text.chars().next_back() else {
+			return;
+		};
+		// Like `str::lines`, a final line without a trailing newline still counts.
+		let open_line = |last: Option<char>| usize::from(last.is_some_and(|ch| ch != '\n'));
+		self.line_count = self.line_count - open_line(previous_last) + newlines + open_line(Some(last));
+		self.char_count += chars;
+		let (words, spaces) = count_words_and_spaces(previous_last, text);
+		self.word_count += words;
+		self.char_count_no_whitespace += chars - spaces;
 	}
 }
 
+/// Counts the words in `text` the way `split_whitespace` does, plus the chars that are [`is_space_like`]. A word that
+/// continues from `previous_last` is not counted again.
+fn count_words_and_spaces(previous_last: Option<char>, text: &str) -> (usize, usize) {
+	let mut after_space = previous_last.is_none_or(char::is_whitespace);
+	let mut words = 0;
+	let mut spaces = 0;
+	if text.is_ascii() {
+		for &byte in text.as_bytes() {
+			// The ASCII chars for which both `char::is_whitespace` and `is_space_like` hold.
+			let space = matches!(byte, b'\t' | b'\n' | 0x0B | 0x0C | b'\r' | b' ');
+			words += usize::from(after_space && !space);
+			spaces += usize::from(space);
+			after_space = space;
+		}
+	} else {
+		for ch in text.chars() {
+			let space = ch.is_whitespace();
+			words += usize::from(after_space && !space);
+			spaces += usize::from(is_space_like(ch));
+			after_space = space;
+		}
+	}
+	(words, spaces)
+}
+
 #[derive(Debug, Clone)]
 pub struct Document {
 	pub title: String,
@@ -266,6 +366,12 @@ pub struct Document {
 	pub spine_items: Vec<String>,
 	pub manifest_items: HashMap<String, String>,
 	pub stats: DocumentStats,
+	/// How many bytes of the source file the text was decoded from, set by parsers whose documents can follow a
+	/// growing file.
+	pub source_len: Option<u64>,
+	/// The encoding that text was decoded from, so bytes appended to the file later can be decoded the same way.
+	/// Set alongside `source_len`, and left `None` when no incremental decoder can continue it.
+	pub source_encoding: Option<&'static Encoding>,
 }
 
 impl Document {
@@ -280,6 +386,8 @@ impl Document {
 			spine_items: Vec::new(),
 			manifest_items: HashMap::new(),
 			stats: DocumentStats::default(),
+			source_len: None,
+			source_encoding: None,
 		}
 	}
 
@@ -299,8 +407,9 @@ impl Document {
 		self.buffer = buffer;
 	}
 
+	/// Publishes the counts the buffer kept while its text was appended; this does not rescan the text.
 	pub fn compute_stats(&mut self) {
-		self.stats = DocumentStats::from_text(&self.buffer.content);
+		self.stats = *self.buffer.stats();
 	}
 }
 
@@ -338,16 +447,162 @@ pub struct ContainerSpan {
 	pub mtype: MarkerType,
 }
 
+const MARKER_TYPE_COUNT: usize = MarkerType::Underline as usize + 1;
+
+fn position_key(position: usize) -> i64 {
+	i64::try_from(position).unwrap_or(i64::MAX)
+}
+
+/// Indices of one group of markers (a single type, or all headings of a level) in position order,
+/// with their positions kept alongside so lookups binary-search a contiguous array.
+#[derive(Debug, Clone, Default)]
+struct MarkerList {
+	positions: Vec<usize>,
+	indices: Vec<usize>,
+}
+
+impl MarkerList {
+	fn push(&mut self, index: usize, position: usize) {
+		self.positions.push(position);
+		self.indices.push(index);
+	}
+
+	const fn len(&self) -> usize {
+		self.indices.len()
+	}
+
+	/// The first marker positioned strictly after `position`.
+	fn next(&self, position: i64) -> Option<usize> {
+		let idx = self.positions.partition_point(|&p| position_key(p) <= position);
+		self.indices.get(idx).copied()
+	}
+
+	/// The last marker positioned strictly before `position`.
+	fn previous(&self, position: i64) -> Option<usize> {
+		let idx = self.positions.partition_point(|&p| position_key(p) < position);
+		idx.checked_sub(1).map(|i| self.indices[i])
+	}
+
+	/// How many markers sit at or before `position`.
+	fn count_through(&self, position: usize) -> usize {
+		self.positions.partition_point(|&p| p <= position)
+	}
+
+	/// The last marker positioned at or before `position`.
+	fn current(&self, position: usize) -> Option<usize> {
+		self.count_through(position).checked_sub(1).map(|i| self.indices[i])
+	}
+}
+
+/// Per-type views over a position-sorted marker list, built once when the handle is created so
+/// navigation, counts and "page N of M" queries never walk the full marker vector.
+#[derive(Debug, Clone, Default)]
+struct MarkerIndex {
+	by_type: [MarkerList; MARKER_TYPE_COUNT],
+	headings: MarkerList,
+	heading_levels: HashMap<i32, MarkerList>,
+}
+
+impl MarkerIndex {
+	fn build(markers: &[Marker]) -> Self {
+		let mut index = Self::default();
+		for (idx, marker) in markers.iter().enumerate() {
+			index.by_type[marker.mtype as usize].push(idx, marker.position);
+			if is_heading_marker(marker.mtype) {
+				index.headings.push(idx, marker.position);
+				index.heading_levels.entry(marker.level).or_default().push(idx, marker.position);
+			}
+		}
+		index
+	}
+
+	const fn of_type(&self, marker_type: MarkerType) -> &MarkerList {
+		&self.by_type[marker_type as usize]
+	}
+
+	fn headings(&self, level: Option<i32>) -> Option<&MarkerList> {
+		level.map_or(Some(&self.headings), |lvl| self.heading_levels.get(&lvl))
+	}
+}
+
+/// Container spans ordered by start, then by descending end, with a max-end segment tree over
+/// them. The innermost container around a position is then the rightmost span that starts at or
+/// before it and still covers it, which the tree finds without visiting non-covering spans.
+#[derive(Debug, Clone, Default)]
+struct ContainerIndex {
+	spans: Vec<ContainerSpan>,
+	/// Implicit binary tree: node `n` has children `2n` and `2n + 1`, leaves start at `leaves`.
+	max_end: Vec<usize>,
+	leaves: usize,
+}
+
+impl ContainerIndex {
+	fn build(markers: &[Marker]) -> Self {
+		let mut entries: Vec<(usize, ContainerSpan)> = markers
+			.iter()
+			.enumerate()
+			.filter(|(_, m)| is_container_marker(m.mtype) && m.length > 0)
+			.map(|(idx, m)| (idx, ContainerSpan { start: m.position, end: m.position + m.length, mtype: m.mtype }))
+			.collect();
+		// Identical spans keep the earliest marker rightmost, matching the first-minimum pick of
+		// the original linear scan.
+		entries.sort_by_key(|&(idx, span)| (span.start, Reverse(span.end), Reverse(idx)));
+		let spans: Vec<ContainerSpan> = entries.into_iter().map(|(_, span)| span).collect();
+		let leaves = spans.len().next_power_of_two();
+		let mut max_end = vec![0; leaves * 2];
+		for (slot, span) in max_end[leaves..].iter_mut().zip(&spans) {
+			*slot = span.end;
+		}
+		for node in (1..leaves).rev() {
+			max_end[node] = max_end[node * 2].max(max_end[node * 2 + 1]);
+		}
+		Self { spans, max_end, leaves }
+	}
+
+	fn innermost(&self, position: usize) -> Option<ContainerSpan> {
+		let limit = self.spans.partition_point(|span| span.start <= position);
+		self.rightmost_covering(1, 0, self.leaves, limit, position).map(|idx| self.spans[idx])
+	}
+
+	/// The rightmost span index in `[lo, min(hi, limit))` whose end lies past `position`.
+	fn rightmost_covering(&self, node: usize, lo: usize, hi: usize, limit: usize, position: usize) -> Option<usize> {
+		if lo >= limit || self.max_end[node] <= position {
+			return None;
+		}
+		if hi - lo == 1 {
+			return Some(lo);
+		}
+		let mid = lo + (hi - lo) / 2;
+		self.rightmost_covering(node * 2 + 1, mid, hi, limit, position)
+			.or_else(|| self.rightmost_covering(node * 2, lo, mid, limit, position))
+	}
+}
+
 #[derive(Debug, Clone)]
 pub struct DocumentHandle {
 	doc: Document,
+	index: MarkerIndex,
+	containers: ContainerIndex,
+	/// Built the first time the Elements dialog or its FFI equivalent asks for it.
+	elements: OnceLock<Elements>,
 }
 
 impl DocumentHandle {
 	#[must_use]
 	pub fn new(mut doc: Document) -> Self {
 		doc.buffer.markers.sort_by_key(|m| m.position);
-		Self { doc }
+		let index = MarkerIndex::build(&doc.buffer.markers);
+		let containers = ContainerIndex::build(&doc.buffer.markers);
+		Self { doc, index, containers, elements: OnceLock::new() }
+	}
+
+	/// Appends `text` to a document without markers, such as a followed log file, keeping the buffer's position
+	/// indexes and the stats up to date in time proportional to `text`.
+	pub fn append_text(&mut self, text: &str) {
+		self.doc.buffer.append(text);
+		self.doc.compute_stats();
+		// Labels taken from the last line may have grown.
+		self.elements.take();
 	}
 
 	#[must_use]
@@ -355,63 +610,31 @@ impl DocumentHandle {
 		&self.doc
 	}
 
-	fn markers_by_type(&self, marker_type: MarkerType) -> impl Iterator<Item = (usize, &Marker)> {
-		self.doc.buffer.markers.iter().enumerate().filter(move |(_, m)| m.mtype == marker_type)
-	}
-
-	fn heading_markers(&self, level: Option<i32>) -> Vec<(usize, &Marker)> {
-		let mut result: Vec<(usize, &Marker)> = self
-			.doc
-			.buffer
-			.markers
-			.iter()
-			.enumerate()
-			.filter(|(_, marker)| is_heading_marker(marker.mtype))
-			.filter(|(_, marker)| level.is_none_or(|lvl| marker.level == lvl))
-			.collect();
-		result.sort_by_key(|(_, marker)| marker.position);
-		result
+	/// The heading tree and link list, derived from the markers on first use and kept for the handle's lifetime.
+	#[must_use]
+	pub fn elements(&self) -> &Elements {
+		self.elements.get_or_init(|| {
+			Elements::build(
+				&self.doc.buffer,
+				&self.index.headings.indices,
+				&self.index.of_type(MarkerType::Link).indices,
+			)
+		})
 	}
 
 	#[must_use]
 	pub fn next_marker_index(&self, position: i64, marker_type: MarkerType) -> Option<usize> {
-		self.doc
-			.buffer
-			.markers
-			.iter()
-			.enumerate()
-			.filter(|(_, marker)| {
-				marker.mtype == marker_type && i64::try_from(marker.position).unwrap_or(i64::MAX) > position
-			})
-			.map(|(idx, _)| idx)
-			.next()
+		self.index.of_type(marker_type).next(position)
 	}
 
 	#[must_use]
 	pub fn previous_marker_index(&self, position: i64, marker_type: MarkerType) -> Option<usize> {
-		self.doc
-			.buffer
-			.markers
-			.iter()
-			.enumerate()
-			.filter(|(_, marker)| {
-				marker.mtype == marker_type && i64::try_from(marker.position).unwrap_or(i64::MAX) < position
-			})
-			.map(|(idx, _)| idx)
-			.next_back()
+		self.index.of_type(marker_type).previous(position)
 	}
 
 	#[must_use]
 	pub fn current_marker_index(&self, position: usize, marker_type: MarkerType) -> Option<usize> {
-		let mut result = None;
-		for (idx, marker) in self.doc.buffer.markers.iter().enumerate() {
-			if marker.mtype == marker_type && marker.position <= position {
-				result = Some(idx);
-			} else if marker.position > position {
-				break;
-			}
-		}
-		result
+		self.index.of_type(marker_type).current(position)
 	}
 
 	/// The innermost container (list/table) whose span contains `position`, or `None` when the
@@ -421,33 +644,17 @@ impl DocumentHandle {
 	/// by the smallest end).
 	#[must_use]
 	pub fn enclosing_container(&self, position: usize) -> Option<ContainerSpan> {
-		self.doc
-			.buffer
-			.markers
-			.iter()
-			.filter(|m| is_container_marker(m.mtype) && m.length > 0)
-			.map(|m| ContainerSpan { start: m.position, end: m.position + m.length, mtype: m.mtype })
-			.filter(|span| span.start <= position && position < span.end)
-			.min_by(|a, b| b.start.cmp(&a.start).then_with(|| a.end.cmp(&b.end)))
+		self.containers.innermost(position)
 	}
 
 	#[must_use]
 	pub fn next_heading_marker_index(&self, position: i64, level: Option<i32>) -> Option<usize> {
-		let heading_markers = self.heading_markers(level);
-		heading_markers
-			.into_iter()
-			.find(|(_, m)| i64::try_from(m.position).unwrap_or(i64::MAX) > position)
-			.map(|(idx, _)| idx)
+		self.index.headings(level)?.next(position)
 	}
 
 	#[must_use]
 	pub fn previous_heading_marker_index(&self, position: i64, level: Option<i32>) -> Option<usize> {
-		let heading_markers = self.heading_markers(level);
-		heading_markers
-			.into_iter()
-			.filter(|(_, m)| i64::try_from(m.position).unwrap_or(i64::MAX) < position)
-			.map(|(idx, _)| idx)
-			.next_back()
+		self.index.headings(level)?.previous(position)
 	}
 
 	#[must_use]
@@ -459,8 +666,7 @@ impl DocumentHandle {
 	#[must_use]
 	pub fn heading_info(&self, heading_index: i32) -> Option<HeadingInfo> {
 		let idx = usize::try_from(heading_index).ok()?;
-		let heading_markers = self.heading_markers(None);
-		let (_, marker) = heading_markers.get(idx)?;
+		let marker = self.doc.buffer.markers.get(*self.index.headings.indices.get(idx)?)?;
 		Some(HeadingInfo { offset: marker.position, level: marker.level, text: marker.text.clone() })
 	}
 
@@ -487,37 +693,25 @@ impl DocumentHandle {
 	}
 
 	#[must_use]
-	pub fn count_markers_by_type(&self, marker_type: MarkerType) -> usize {
-		self.doc.buffer.markers.iter().filter(|m| m.mtype == marker_type).count()
+	pub const fn count_markers_by_type(&self, marker_type: MarkerType) -> usize {
+		self.index.of_type(marker_type).len()
 	}
 
 	#[must_use]
 	pub fn get_marker_position_by_index(&self, marker_type: MarkerType, index: i32) -> Option<usize> {
 		let target = usize::try_from(index).ok()?;
-		self.markers_by_type(marker_type).nth(target).map(|(_, marker)| marker.position)
+		self.index.of_type(marker_type).positions.get(target).copied()
 	}
 
 	#[must_use]
 	pub fn section_index(&self, position: usize) -> Option<i32> {
-		let count = self
-			.doc
-			.buffer
-			.markers
-			.iter()
-			.filter(|m| m.mtype == MarkerType::SectionBreak && m.position <= position)
-			.count();
+		let count = self.index.of_type(MarkerType::SectionBreak).count_through(position);
 		if count == 0 { None } else { i32::try_from(count - 1).ok() }
 	}
 
 	#[must_use]
 	pub fn page_index(&self, position: usize) -> Option<i32> {
-		let count = self
-			.doc
-			.buffer
-			.markers
-			.iter()
-			.filter(|m| m.mtype == MarkerType::PageBreak && m.position <= position)
-			.count();
+		let count = self.index.of_type(MarkerType::PageBreak).count_through(position);
 		if count == 0 { None } else { i32::try_from(count - 1).ok() }
 	}
 
@@ -542,6 +736,8 @@ bitflags! {
 		const SUPPORTS_LISTS = 1 << 3;
 		const SUPPORTS_IMAGES = 1 << 4;
 		const SUPPORTS_FIGURES = 1 << 5;
+		/// Plain text that can keep appending what is written to the file after it was opened.
+		const SUPPORTS_FOLLOW = 1 << 6;
 	}
 }
 
@@ -582,6 +778,8 @@ impl ParserContext {
 
 #[cfg(test)]
 mod tests {
+	use rstest::rstest;
+
 	use super::*;
 
 	fn sample_handle() -> DocumentHandle {
@@ -649,6 +847,40 @@ mod tests {
 		assert!(handle.enclosing_container(150).is_none());
 	}
 
+	#[test]
+	fn enclosing_container_matches_linear_scan_on_overlapping_spans() {
+		let mut buffer = DocumentBuffer::new();
+		buffer.append(&"x".repeat(300));
+		let mut seed = 0x2545_f491_u64;
+		let mut next = |bound: u64| {
+			seed = seed.wrapping_mul(6_364_136_223_846_793_005).wrapping_add(1_442_695_040_888_963_407);
+			usize::try_from((seed >> 33) % bound).unwrap()
+		};
+		for _ in 0..200 {
+			let mtype = if next(2) == 0 { MarkerType::List } else { MarkerType::Table };
+			let start = next(250);
+			buffer.add_marker(Marker::new(mtype, start).with_length(next(40)));
+		}
+		// Identical spans of different types: the earlier marker wins, as with the linear scan.
+		buffer.add_marker(Marker::new(MarkerType::Table, 120).with_length(3));
+		buffer.add_marker(Marker::new(MarkerType::List, 120).with_length(3));
+		let mut doc = Document::new();
+		doc.set_buffer(buffer);
+		let handle = DocumentHandle::new(doc);
+		for position in 0..300 {
+			let linear = handle
+				.document()
+				.buffer
+				.markers
+				.iter()
+				.filter(|m| is_container_marker(m.mtype) && m.length > 0)
+				.map(|m| ContainerSpan { start: m.position, end: m.position + m.length, mtype: m.mtype })
+				.filter(|span| span.start <= position && position < span.end)
+				.min_by(|a, b| b.start.cmp(&a.start).then_with(|| a.end.cmp(&b.end)));
+			assert_eq!(handle.enclosing_container(position), linear, "position {position}");
+		}
+	}
+
 	#[test]
 	fn marker_type_round_trip_for_all_known_values() {
 		for raw in 0..=18 {
@@ -682,6 +914,19 @@ mod tests {
 		assert_eq!(buffer.current_position(), 5);
 	}
 
+	#[test]
+	fn document_buffer_append_owned_matches_append() {
+		let mut owned = DocumentBuffer::new();
+		owned.append_owned("a\nb".to_string());
+		owned.append_owned("\u{e9}\n".to_string());
+		let mut borrowed = DocumentBuffer::new();
+		borrowed.append("a\nb");
+		borrowed.append("\u{e9}\n");
+		assert_eq!(owned.content, borrowed.content);
+		assert_eq!(owned.newline_positions(), borrowed.newline_positions());
+		assert_eq!(owned.byte_index_for_char(4), borrowed.byte_index_for_char(4));
+	}
+
 	#[test]
 	fn document_stats_counts_words_lines_and_chars() {
 		let stats = DocumentStats::from_text("a b\nc");
@@ -700,6 +945,32 @@ mod tests {
 		assert_eq!(doc.stats.line_count, 1);
 	}
 
+	#[rstest]
+	#[case(&["one two", " three\n", "four"])]
+	#[case(&["split", "word\n\n", "\n"])]
+	#[case(&["", "a\r\nb", "\u{00A0}c d", ""])]
+	#[case(&["\n", "x"])]
+	#[case(&["tab\there\u{2003}em", "\u{200B}zw\u{0B}vt\u{0C}", "\u{3000}"])]
+	fn stats_append_matches_recounting(#[case] parts: &[&str]) {
+		let recount = |text: &str| {
+			let visible = text.chars().filter(|c| !is_space_like(*c)).count();
+			(text.split_whitespace().count(), text.lines().count(), text.chars().count(), visible)
+		};
+		let counts = |stats: &DocumentStats| {
+			(stats.word_count, stats.line_count, stats.char_count, stats.char_count_no_whitespace)
+		};
+		let mut handle = DocumentHandle::new(Document::new());
+		let mut text = String::new();
+		for part in parts {
+			handle.append_text(part);
+			text.push_str(part);
+			assert_eq!(counts(&handle.document().stats), recount(&text));
+			assert_eq!(counts(&DocumentStats::from_text(&text)), recount(&text));
+			assert_eq!(handle.document().buffer.has_carriage_returns(), text.contains('\r'));
+		}
+		assert_eq!(handle.document().buffer.content, text);
+	}
+
 	#[test]
 	fn heading_marker_helper_matches_heading_types_only() {
 		assert!(is_heading_marker(MarkerType::Heading1));
@@ -809,6 +1080,35 @@ mod tests {
 		assert_eq!(handle.page_index(0), None);
 	}
 
+	#[test]
+	fn marker_index_matches_linear_scan_with_shared_positions() {
+		let mut buffer = DocumentBuffer::new();
+		buffer.append(&"x".repeat(40));
+		for position in [0, 4, 4, 9, 9, 9, 15, 30] {
+			buffer.add_marker(Marker::new(MarkerType::Link, position));
+			buffer.add_marker(Marker::new(MarkerType::Heading3, position).with_level(3));
+		}
+		let mut doc = Document::new();
+		doc.set_buffer(buffer);
+		let handle = DocumentHandle::new(doc);
+		let markers = &handle.document().buffer.markers;
+		for position in -1..=31 {
+			let linear_next = markers
+				.iter()
+				.position(|m| m.mtype == MarkerType::Link && i64::try_from(m.position).unwrap() > position);
+			let linear_previous = markers
+				.iter()
+				.rposition(|m| m.mtype == MarkerType::Link && i64::try_from(m.position).unwrap() < position);
+			assert_eq!(handle.next_marker_index(position, MarkerType::Link), linear_next);
+			assert_eq!(handle.previous_marker_index(position, MarkerType::Link), linear_previous);
+			let heading_next =
+				markers.iter().position(|m| m.level == 3 && i64::try_from(m.position).unwrap() > position);
+			assert_eq!(handle.next_heading_marker_index(position, Some(3)), heading_next);
+		}
+		assert_eq!(handle.current_marker_index(9, MarkerType::Link).map(|idx| markers[idx].position), Some(9));
+		assert_eq!(handle.count_markers_by_type(MarkerType::Heading3), 8);
+	}
+
 	#[test]
 	fn heading_index_helpers_return_none_when_filtered_level_missing() {
 		let handle = sample_handle();
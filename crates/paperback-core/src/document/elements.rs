@@ -0,0 +1,151 @@
+use std::ops::Range;
+
+use super::DocumentBuffer;
+
+/// A heading or link listed by the Elements dialog. Its label is not copied out of the document: it is the marker's
+/// own text, or for markers without text, the line the marker sits on.
+#[derive(Debug, Clone)]
+pub struct Element {
+	pub offset: usize,
+	/// Index of the enclosing heading in the same list. Always `None` for links.
+	pub parent: Option<usize>,
+	label: Label,
+}
+
+#[derive(Debug, Clone)]
+enum Label {
+	/// The text of the marker at this index.
+	Marker(usize),
+	/// This byte range of the content.
+	Line(Range<usize>),
+}
+
+impl Element {
+	fn new(buffer: &DocumentBuffer, marker_index: usize, parent: Option<usize>) -> Self {
+		let marker = &buffer.markers[marker_index];
+		let label = if marker.text.is_empty() {
+			Label::Line(buffer.line_byte_range(marker.position))
+		} else {
+			Label::Marker(marker_index)
+		};
+		Self { offset: marker.position, parent, label }
+	}
+
+	/// The element's text, borrowed from `buffer`, which must be the buffer the element was built from.
+	#[must_use]
+	pub fn label<'a>(&self, buffer: &'a DocumentBuffer) -> &'a str {
+		match &self.label {
+			Label::Marker(index) => &buffer.markers[*index].text,
+			Label::Line(range) => &buffer.content[range.clone()],
+		}
+	}
+}
+
+/// The heading tree and link list of a document, in position order.
+#[derive(Debug, Clone, Default)]
+pub struct Elements {
+	headings: Vec<Element>,
+	links: Vec<Element>,
+}
+
+impl Elements {
+	/// Builds both lists from the indexes of the heading and link markers in `buffer`, each in position order.
+	pub(super) fn build(buffer: &DocumentBuffer, heading_markers: &[usize], link_markers: &[usize]) -> Self {
+		let mut headings = Vec::with_capacity(heading_markers.len());
+		let mut open: Vec<(i32, usize)> = Vec::new(); // (level, index)
+		for &marker_index in heading_markers {
+			let level = buffer.markers[marker_index].level;
+			while open.last().is_some_and(|&(l, _)| l >= level) {
+				open.pop();
+			}
+			let parent = open.last().map(|&(_, index)| index);
+			open.push((level, headings.len()));
+			headings.push(Element::new(buffer, marker_index, parent));
+		}
+		let links = link_markers.iter().map(|&marker_index| Element::new(buffer, marker_index, None)).collect();
+		Self { headings, links }
+	}
+
+	#[must_use]
+	pub fn headings(&self) -> &[Element] {
+		&self.headings
+	}
+
+	#[must_use]
+	pub fn links(&self) -> &[Element] {
+		&self.links
+	}
+
+	/// The heading nearest before `position`: the last one at or before it, or the first of several sharing that
+	/// offset.
+	#[must_use]
+	pub fn closest_heading(&self, position: usize) -> Option<usize> {
+		let last = self.headings.partition_point(|e| e.offset <= position).checked_sub(1)?;
+		let offset = self.headings[last].offset;
+		Some(self.headings.partition_point(|e| e.offset < offset))
+	}
+
+	/// The last link at or before `position`.
+	#[must_use]
+	pub fn closest_link(&self, position: usize) -> Option<usize> {
+		self.links.partition_point(|e| e.offset <= position).checked_sub(1)
+	}
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+	use crate::document::{Document, DocumentHandle, Marker, MarkerType};
+
+	fn handle() -> DocumentHandle {
+		let mut buffer = DocumentBuffer::with_content("Intro\nSetup\nUsage\nFAQ".to_string());
+		buffer.add_marker(Marker::new(MarkerType::Heading1, 0).with_level(1).with_text("Guide".to_string()));
+		buffer.add_marker(Marker::new(MarkerType::Heading2, 6).with_level(2));
+		buffer.add_marker(Marker::new(MarkerType::Heading3, 6).with_level(3).with_text("Install".to_string()));
+		buffer.add_marker(Marker::new(MarkerType::Heading2, 12).with_level(2));
+		buffer.add_marker(Marker::new(MarkerType::Heading1, 18).with_level(1).with_text("FAQ".to_string()));
+		buffer.add_marker(Marker::new(MarkerType::Link, 8).with_text("site".to_string()));
+		buffer.add_marker(Marker::new(MarkerType::Link, 14));
+		let mut doc = Document::new();
+		doc.set_buffer(buffer);
+		DocumentHandle::new(doc)
+	}
+
+	#[test]
+	fn headings_nest_under_the_previous_shallower_heading() {
+		let handle = handle();
+		let buffer = &handle.document().buffer;
+		let headings = handle.elements().headings();
+		let labels: Vec<&str> = headings.iter().map(|e| e.label(buffer)).collect();
+		assert_eq!(labels, ["Guide", "Setup", "Install", "Usage", "FAQ"]);
+		let parents: Vec<Option<usize>> = headings.iter().map(|e| e.parent).collect();
+		assert_eq!(parents, [None, Some(0), Some(1), Some(0), None]);
+	}
+
+	#[test]
+	fn links_take_their_line_when_they_have_no_text() {
+		let handle = handle();
+		let buffer = &handle.document().buffer;
+		let labels: Vec<&str> = handle.elements().links().iter().map(|e| e.label(buffer)).collect();
+		assert_eq!(labels, ["site", "Usage"]);
+	}
+
+	#[test]
+	fn closest_elements_match_a_linear_scan() {
+		let handle = handle();
+		let elements = handle.elements();
+		for position in 0..25 {
+			let mut heading = None;
+			let mut min_distance = usize::MAX;
+			for (index, e) in elements.headings().iter().enumerate() {
+				if e.offset <= position && position - e.offset < min_distance {
+					min_distance = position - e.offset;
+					heading = Some(index);
+				}
+			}
+			assert_eq!(elements.closest_heading(position), heading, "position {position}");
+			let link = elements.links().iter().rposition(|e| e.offset <= position);
+			assert_eq!(elements.closest_link(position), link, "position {position}");
+		}
+	}
+}
@@ -0,0 +1,415 @@
+/// Number of characters between two checkpoints. A lookup scans at most this many characters
+/// past its checkpoint, and the index costs one `usize` per stride of text and per offset space.
+const CHECKPOINT_STRIDE: usize = 64;
+
+/// Translates positions between the offset spaces a document's text is addressed in.
+///
+/// Those are UTF-8 bytes (`String` slicing), chars (line index, GTK text control), UTF-16 code
+/// units (Win32 and Cocoa text controls) and display units, which are whichever of the last two
+/// the platform's text control uses (see [`crate::util::text::display_len`]).
+///
+/// The index only ever grows at the end, alongside the text it describes. Offsets that coincide
+/// are not stored: pure-ASCII text keeps no checkpoints at all, and UTF-16 checkpoints are only
+/// materialized once the first character outside the Basic Multilingual Plane is appended. All
+/// other lookups binary-search a checkpoint and scan at most one stride of text.
+#[derive(Debug, Clone, Default)]
+pub struct PositionIndex {
+	/// Byte offset of char `k * CHECKPOINT_STRIDE`; empty while the text is pure ASCII.
+	byte_checkpoints: Vec<usize>,
+	/// UTF-16 offset of char `k * CHECKPOINT_STRIDE`; empty until the text holds a surrogate pair.
+	utf16_checkpoints: Vec<usize>,
+	char_count: usize,
+	byte_len: usize,
+	utf16_len: usize,
+	multibyte: bool,
+	astral: bool,
+}
+
+impl PositionIndex {
+	#[must_use]
+	pub const fn new() -> Self {
+		Self {
+			byte_checkpoints: Vec::new(),
+			utf16_checkpoints: Vec::new(),
+			char_count: 0,
+			byte_len: 0,
+			utf16_len: 0,
+			multibyte: false,
+			astral: false,
+		}
+	}
+
+	/// Builds the index for a standalone string.
+	#[must_use]
+	pub fn for_text(text: &str) -> Self {
+		let mut index = Self::new();
+		index.append(text, |_| {});
+		index
+	}
+
+	/// Indexes `text`, which has just been appended to the end of the tracked string, and calls
+	/// `on_newline` with the char index of every `'\n'` it contains.
+	///
+	/// Non-ASCII text is scanned a block at a time: [`BlockMasks`] flags every char start, astral
+	/// char start and newline in a block, and the counts and checkpoints fall out of popcounts on
+	/// those masks instead of decoding the text char by char.
+	pub fn append(&mut self, text: &str, mut on_newline: impl FnMut(usize)) {
+		let base_char = self.char_count;
+		if text.is_ascii() {
+			for offset in memchr::memchr_iter(b'\n', text.as_bytes()) {
+				on_newline(base_char + offset);
+			}
+			let first = base_char.div_ceil(CHECKPOINT_STRIDE) * CHECKPOINT_STRIDE;
+			let new_chars = first..base_char + text.len();
+			if self.multibyte {
+				let start_byte = self.byte_len;
+				self.byte_checkpoints
+					.extend(new_chars.clone().step_by(CHECKPOINT_STRIDE).map(|c| start_byte + (c - base_char)));
+			}
+			if self.astral {
+				let start_utf16 = self.utf16_len;
+				self.utf16_checkpoints
+					.extend(new_chars.step_by(CHECKPOINT_STRIDE).map(|c| start_utf16 + (c - base_char)));
+			}
+			self.char_count += text.len();
+			self.byte_len += text.len();
+			self.utf16_len += text.len();
+			return;
+		}
+		if !self.multibyte {
+			// Everything so far was ASCII, so its checkpoints are simply multiples of the stride.
+			self.multibyte = true;
+			self.byte_checkpoints.extend((0..self.char_count).step_by(CHECKPOINT_STRIDE));
+		}
+		let mut block_start = self.byte_len;
+		let mut char_index = base_char;
+		let mut utf16_index = self.utf16_len;
+		for block in text.as_bytes().chunks(BLOCK_LEN) {
+			let masks = BlockMasks::scan(block);
+			if !self.astral && masks.astral_starts != 0 {
+				// Until this block UTF-16 and char offsets coincided; backfill their checkpoints.
+				self.astral = true;
+				self.utf16_checkpoints.extend((0..self.byte_checkpoints.len()).map(|k| k * CHECKPOINT_STRIDE));
+			}
+			let chars = masks.char_starts.count_ones() as usize;
+			let mut checkpoint = char_index.next_multiple_of(CHECKPOINT_STRIDE);
+			while checkpoint < char_index + chars {
+				let bit = nth_set_bit(masks.char_starts, checkpoint - char_index);
+				self.byte_checkpoints.push(block_start + bit);
+				if self.astral {
+					let astral_before = (masks.astral_starts & low_bits(bit)).count_ones() as usize;
+					self.utf16_checkpoints.push(utf16_index + (checkpoint - char_index) + astral_before);
+				}
+				checkpoint += CHECKPOINT_STRIDE;
+			}
+			let mut newlines = masks.newlines;
+			while newlines != 0 {
+				let bit = newlines.trailing_zeros() as usize;
+				on_newline(char_index + (masks.char_starts & low_bits(bit)).count_ones() as usize);
+				newlines &= newlines - 1;
+			}
+			char_index += chars;
+			utf16_index += chars + masks.astral_starts.count_ones() as usize;
+			block_start += block.len();
+		}
+		self.char_count = char_index;
+		self.byte_len += text.len();
+		self.utf16_len = utf16_index;
+	}
+
+	#[must_use]
+	pub const fn char_count(&self) -> usize {
+		self.char_count
+	}
+
+	#[must_use]
+	pub const fn utf16_len(&self) -> usize {
+		self.utf16_len
+	}
+
+	/// Length of the text in display units.
+	#[must_use]
+	pub const fn display_len(&self) -> usize {
+		if cfg!(any(windows, target_os = "macos")) { self.utf16_len } else { self.char_count }
+	}
+
+	/// Byte offset of the char at `char_index` in `text`; past-the-end indices map to `text.len()`.
+	#[must_use]
+	pub fn byte_for_char(&self, text: &str, char_index: usize) -> usize {
+		if char_index >= self.char_count {
+			return self.byte_len;
+		}
+		if !self.multibyte {
+			return char_index;
+		}
+		let start = self.byte_checkpoints[char_index / CHECKPOINT_STRIDE];
+		text[start..].char_indices().nth(char_index % CHECKPOINT_STRIDE).map_or(self.byte_len, |(i, _)| start + i)
+	}
+
+	/// Index of the first char that starts at or after `byte_index`.
+	#[must_use]
+	pub fn char_for_byte(&self, text: &str, byte_index: usize) -> usize {
+		let byte_index = byte_index.min(self.byte_len);
+		if !self.multibyte {
+			return byte_index;
+		}
+		let block = self.byte_checkpoints.partition_point(|&b| b <= byte_index).saturating_sub(1);
+		let start = self.byte_checkpoints.get(block).copied().unwrap_or(0);
+		block * CHECKPOINT_STRIDE + count_char_starts(&text.as_bytes()[start..byte_index])
+	}
+
+	/// UTF-16 offset of the char at `char_index`; past-the-end indices map to the UTF-16 length.
+	#[must_use]
+	pub fn utf16_for_char(&self, text: &str, char_index: usize) -> usize {
+		if char_index >= self.char_count {
+			return self.utf16_len;
+		}
+		if !self.astral {
+			return char_index;
+		}
+		let block = char_index / CHECKPOINT_STRIDE;
+		let start = self.byte_checkpoints[block];
+		let skipped: usize = text[start..].chars().take(char_index % CHECKPOINT_STRIDE).map(char::len_utf16).sum();
+		self.utf16_checkpoints[block] + skipped
+	}
+
+	/// Index of the first char that starts at or after UTF-16 offset `utf16_index`; an offset
+	/// between the halves of a surrogate pair rounds up to the next char.
+	#[must_use]
+	pub fn char_for_utf16(&self, text: &str, utf16_index: usize) -> usize {
+		if utf16_index >= self.utf16_len {
+			return self.char_count;
+		}
+		if !self.astral {
+			return utf16_index;
+		}
+		let block = self.utf16_checkpoints.partition_point(|&u| u <= utf16_index).saturating_sub(1);
+		let mut units = self.utf16_checkpoints[block];
+		let mut char_index = block * CHECKPOINT_STRIDE;
+		for ch in text[self.byte_checkpoints[block]..].chars() {
+			if units >= utf16_index {
+				break;
+			}
+			units += ch.len_utf16();
+			char_index += 1;
+		}
+		char_index
+	}
+
+	#[must_use]
+	pub fn display_for_char(&self, text: &str, char_index: usize) -> usize {
+		if cfg!(any(windows, target_os = "macos")) {
+			self.utf16_for_char(text, char_index)
+		} else {
+			char_index.min(self.char_count)
+		}
+	}
+
+	#[must_use]
+	pub fn char_for_display(&self, text: &str, display_index: usize) -> usize {
+		if cfg!(any(windows, target_os = "macos")) {
+			self.char_for_utf16(text, display_index)
+		} else {
+			display_index.min(self.char_count)
+		}
+	}
+
+	#[must_use]
+	pub fn byte_for_display(&self, text: &str, display_index: usize) -> usize {
+		self.byte_for_char(text, self.char_for_display(text, display_index))
+	}
+
+	#[must_use]
+	pub fn display_for_byte(&self, text: &str, byte_index: usize) -> usize {
+		self.display_for_char(text, self.char_for_byte(text, byte_index))
+	}
+
+	#[must_use]
+	pub fn byte_for_utf16(&self, text: &str, utf16_index: usize) -> usize {
+		self.byte_for_char(text, self.char_for_utf16(text, utf16_index))
+	}
+
+	#[must_use]
+	pub fn utf16_for_byte(&self, text: &str, byte_index: usize) -> usize {
+		self.utf16_for_char(text, self.char_for_byte(text, byte_index))
+	}
+}
+
+/// Bytes scanned per step of [`PositionIndex::append`]; one bit per byte in each of [`BlockMasks`].
+const BLOCK_LEN: usize = 64;
+
+const HIGH_BITS: u64 = 0x8080_8080_8080_8080;
+const LOW_SEVEN_BITS: u64 = 0x7F7F_7F7F_7F7F_7F7F;
+const NEWLINES: u64 = 0x0A0A_0A0A_0A0A_0A0A;
+
+/// Per-byte flags for one block of at most [`BLOCK_LEN`] bytes, where bit `i` describes byte `i`.
+///
+/// The flags are computed eight bytes at a time with plain integer arithmetic on `u64` words, so
+/// the scan is branch-free and needs neither `unsafe` nor a per-CPU code path.
+struct BlockMasks {
+	/// Bytes that begin a char, i.e. everything except `10xxxxxx` continuation bytes.
+	char_starts: u64,
+	/// Lead bytes of four-byte sequences (`11110xxx`), which are two UTF-16 code units wide.
+	astral_starts: u64,
+	newlines: u64,
+}
+
+impl BlockMasks {
+	fn scan(block: &[u8]) -> Self {
+		let mut padded = [0; BLOCK_LEN];
+		let full = <&[u8; BLOCK_LEN]>::try_from(block).unwrap_or_else(|_| {
+			padded[..block.len()].copy_from_slice(block);
+			&padded
+		});
+		let mut masks = Self { char_starts: 0, astral_starts: 0, newlines: 0 };
+		for (index, chunk) in full.as_chunks::<8>().0.iter().enumerate() {
+			let word = u64::from_le_bytes(*chunk);
+			let shift = index * 8;
+			// Shifting left moves bit 6 of every byte into bit 7 of the same byte, and so on.
+			masks.char_starts |= pack_high_bits(!word | (word << 1)) << shift;
+			masks.astral_starts |= pack_high_bits(word & (word << 1) & (word << 2) & (word << 3)) << shift;
+			let diff = word ^ NEWLINES;
+			masks.newlines |= pack_high_bits(!(((diff & LOW_SEVEN_BITS) + LOW_SEVEN_BITS) | diff)) << shift;
+		}
+		// The zero padding of a short last block would otherwise count as chars.
+		let valid = if block.len() == BLOCK_LEN { u64::MAX } else { low_bits(block.len()) };
+		masks.char_starts &= valid;
+		masks.astral_starts &= valid;
+		masks.newlines &= valid;
+		masks
+	}
+}
+
+/// Gathers bit 7 of each byte of `word` into the low eight bits of the result, byte 0 first.
+const fn pack_high_bits(word: u64) -> u64 {
+	((word & HIGH_BITS) >> 7).wrapping_mul(0x0102_0408_1020_4080) >> 56
+}
+
+/// Mask of the bits below `bit`.
+const fn low_bits(bit: usize) -> u64 {
+	(1 << bit) - 1
+}
+
+/// Position of the `n`th (zero-based) set bit of `mask`, which must have more than `n` set bits.
+fn nth_set_bit(mut mask: u64, n: usize) -> usize {
+	for _ in 0..n {
+		mask &= mask - 1;
+	}
+	mask.trailing_zeros() as usize
+}
+
+/// Counts the bytes that begin a UTF-8 sequence, i.e. everything except `10xxxxxx` continuation
+/// bytes. Written as a branch-free filter so the compiler vectorizes it.
+fn count_char_starts(bytes: &[u8]) -> usize {
+	bytes.iter().filter(|&&b| b & 0xC0 != 0x80).count()
+}
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+
+	fn indexed(parts: &[&str]) -> (String, PositionIndex, Vec<usize>) {
+		let mut text = String::new();
+		let mut index = PositionIndex::new();
+		let mut newlines = Vec::new();
+		for part in parts {
+			index.append(part, |c| newlines.push(c));
+			text.push_str(part);
+		}
+		(text, index, newlines)
+	}
+
+	#[test]
+	fn ascii_text_maps_offsets_without_checkpoints() {
+		let (text, index, newlines) = indexed(&["hello\nworld", "\n!"]);
+		assert!(index.byte_checkpoints.is_empty());
+		assert!(index.utf16_checkpoints.is_empty());
+		assert_eq!(index.byte_for_char(&text, 6), 6);
+		assert_eq!(index.char_for_byte(&text, 11), 11);
+		assert_eq!(index.byte_for_char(&text, 99), text.len());
+		assert_eq!(index.utf16_for_char(&text, 99), text.len());
+		assert_eq!(newlines, vec![5, 11]);
+	}
+
+	#[test]
+	fn mixed_appends_match_char_indices() {
+		let ascii = "a".repeat(150);
+		let bmp = "é€\nx".repeat(40);
+		let astral = "é€😀\nx".repeat(70);
+		let (text, index, newlines) = indexed(&[&ascii, &bmp, &astral, "tail\n", &ascii]);
+		let mut utf16 = 0;
+		let mut expected = Vec::new();
+		for (byte, ch) in text.char_indices() {
+			expected.push((byte, utf16));
+			utf16 += ch.len_utf16();
+		}
+		expected.push((text.len(), utf16));
+		assert_eq!(index.char_count(), expected.len() - 1);
+		assert_eq!(index.utf16_len(), utf16);
+		for (char_idx, &(byte_idx, utf16_idx)) in expected.iter().enumerate() {
+			assert_eq!(index.byte_for_char(&text, char_idx), byte_idx);
+			assert_eq!(index.char_for_byte(&text, byte_idx), char_idx);
+			assert_eq!(index.utf16_for_char(&text, char_idx), utf16_idx);
+			assert_eq!(index.char_for_utf16(&text, utf16_idx), char_idx);
+			assert_eq!(index.utf16_for_byte(&text, byte_idx), utf16_idx);
+			assert_eq!(index.byte_for_utf16(&text, utf16_idx), byte_idx);
+		}
+		let expected_newlines: Vec<usize> =
+			text.chars().enumerate().filter(|&(_, c)| c == '\n').map(|(i, _)| i).collect();
+		assert_eq!(newlines, expected_newlines);
+	}
+
+	#[test]
+	fn block_scan_matches_a_char_walk_at_any_split() {
+		let text = "Größe\n東京😀 é\r\n".repeat(30) + &"a".repeat(70) + "\u{10FFFF}\n";
+		for part_len in [1, 7, 63, 64, 65, 200, text.len()] {
+			let mut parts = Vec::new();
+			let mut rest = text.as_str();
+			while !rest.is_empty() {
+				let mut end = part_len.min(rest.len());
+				while !rest.is_char_boundary(end) {
+					end += 1;
+				}
+				parts.push(&rest[..end]);
+				rest = &rest[end..];
+			}
+			let (joined, index, newlines) = indexed(&parts);
+			let mut utf16 = 0;
+			for (char_idx, (byte_idx, ch)) in joined.char_indices().enumerate() {
+				assert_eq!(index.byte_for_char(&joined, char_idx), byte_idx);
+				assert_eq!(index.utf16_for_char(&joined, char_idx), utf16);
+				utf16 += ch.len_utf16();
+			}
+			assert_eq!(index.char_count(), joined.chars().count());
+			assert_eq!(index.utf16_len(), utf16);
+			let expected: Vec<usize> = joined.chars().enumerate().filter(|&(_, c)| c == '\n').map(|(i, _)| i).collect();
+			assert_eq!(newlines, expected);
+		}
+	}
+
+	#[test]
+	fn offsets_inside_a_sequence_round_up_to_next_char() {
+		let (text, index, _) = indexed(&["a€b😀c"]);
+		assert_eq!(index.char_for_byte(&text, 2), 2);
+		assert_eq!(index.char_for_byte(&text, 4), 2);
+		assert_eq!(index.char_for_byte(&text, 5), 3);
+		// "😀" occupies UTF-16 units 3 and 4; unit 4 is its low surrogate.
+		assert_eq!(index.char_for_utf16(&text, 3), 3);
+		assert_eq!(index.char_for_utf16(&text, 4), 4);
+		assert_eq!(index.char_for_utf16(&text, 5), 4);
+	}
+
+	#[test]
+	fn display_offsets_follow_the_platform_unit() {
+		let (text, index, _) = indexed(&["😀a"]);
+		if cfg!(any(windows, target_os = "macos")) {
+			assert_eq!(index.display_len(), 3);
+			assert_eq!(index.display_for_char(&text, 1), 2);
+			assert_eq!(index.byte_for_display(&text, 2), 4);
+		} else {
+			assert_eq!(index.display_len(), 2);
+			assert_eq!(index.display_for_char(&text, 1), 1);
+			assert_eq!(index.byte_for_display(&text, 1), 4);
+		}
+	}
+}
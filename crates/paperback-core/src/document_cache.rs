@@ -0,0 +1,575 @@
+use std::{
+	collections::HashMap,
+	fs::{self, File},
+	path::{Path, PathBuf},
+	sync::{
+		OnceLock,
+		atomic::{AtomicU64, Ordering},
+	},
+	time::{SystemTime, UNIX_EPOCH},
+};
+
+use crate::{
+	document::{Document, DocumentBuffer, DocumentStats, Marker, MarkerType, TocItem},
+	parser::PARSER_VERSION,
+};
+
+/// Size budget used by [`crate::set_document_cache_dir`].
+pub const DEFAULT_MAX_CACHE_BYTES: u64 = 512 * 1024 * 1024;
+
+const MAGIC: [u8; 4] = *b"PBDC";
+/// Revision of the entry layout written by [`encode_entry`]; bump it whenever that layout changes.
+const FORMAT_VERSION: u32 = 2;
+const ENTRY_EXTENSION: &str = "pbcache";
+
+// Smallest encoded size of each repeated record, used to reject impossible counts before allocating.
+const MIN_MARKER_LEN: usize = 40;
+const MIN_TOC_ITEM_LEN: usize = 32;
+const MIN_STRING_PAIR_LEN: usize = 16;
+const MIN_STRING_LEN: usize = 8;
+/// Deepest table of contents nesting an entry may hold. Decoding recurses once per level, so a damaged entry must not
+/// be able to ask for more; documents nested deeper than this are simply not cached.
+const MAX_TOC_DEPTH: usize = 64;
+
+static GLOBAL: OnceLock<DocumentCache> = OnceLock::new();
+static NEXT_TEMP_ID: AtomicU64 = AtomicU64::new(0);
+
+/// Installs the process-wide cache consulted by [`crate::session::DocumentSession`]. Only the first call has any
+/// effect; until then, documents are always parsed from source.
+pub fn init_global(cache: DocumentCache) {
+	let _ = GLOBAL.set(cache);
+}
+
+#[must_use]
+pub fn global() -> Option<&'static DocumentCache> {
+	GLOBAL.get()
+}
+
+/// Identifies the cache entry for one source file parsed with one set of options.
+///
+/// The entry name comes from the file's canonical path plus the options that change parser output, so looking an
+/// entry up costs a few metadata calls and never reads the file itself. The path, size and modification time are
+/// checked against the entry header, which is what tells a changed file, or two paths sharing a name, apart.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct CacheKey {
+	file_name: String,
+	source_path: Vec<u8>,
+	source_len: u64,
+	source_modified: u64,
+}
+
+impl CacheKey {
+	/// Returns `None` when the file cannot be inspected, in which case it is not cached.
+	#[must_use]
+	pub fn for_file(file_path: &str, forced_extension: &str, render_tables_inline: bool) -> Option<Self> {
+		let source_path = fs::canonicalize(file_path).ok()?;
+		let metadata = fs::metadata(&source_path).ok()?;
+		let modified = metadata.modified().ok()?.duration_since(UNIX_EPOCH).ok()?;
+		let source_path = source_path.into_os_string().into_encoded_bytes();
+		let extension: String =
+			forced_extension.chars().filter(char::is_ascii_alphanumeric).map(|c| c.to_ascii_lowercase()).collect();
+		let tables = u8::from(render_tables_inline);
+		Some(Self {
+			file_name: format!("{:016x}-{tables}{extension}.{ENTRY_EXTENSION}", checksum(&source_path)),
+			source_path,
+			source_len: metadata.len(),
+			source_modified: u64::try_from(modified.as_nanos()).unwrap_or(u64::MAX),
+		})
+	}
+}
+
+/// A size-bounded directory of parsed documents in a compact binary form.
+///
+/// Entries are evicted least recently used first. Every entry carries a checksum; an entry that fails it, or that an
+/// older parser wrote, is deleted on sight. All failures are silent: a cache that cannot be read or written just means the document is parsed again.
+#[derive(Debug, Clone)]
+pub struct DocumentCache {
+	dir: PathBuf,
+	max_bytes: u64,
+}
+
+impl DocumentCache {
+	#[must_use]
+	pub const fn new(dir: PathBuf, max_bytes: u64) -> Self {
+		Self { dir, max_bytes }
+	}
+
+	#[must_use]
+	pub fn load(&self, key: &CacheKey) -> Option<Document> {
+		let path = self.dir.join(&key.file_name);
+		let bytes = fs::read(&path).ok()?;
+		let Some(doc) = decode_entry(&bytes, key) else {
+			let _ = fs::remove_file(&path);
+			return None;
+		};
+		// Entry mtimes double as the LRU clock.
+		let _ = File::options().write(true).open(&path).and_then(|file| file.set_modified(SystemTime::now()));
+		Some(doc)
+	}
+
+	pub fn store(&self, key: &CacheKey, doc: &Document) {
+		// The entry holds at least the text, so skip encoding a second copy of a document that could never fit.
+		if u64::try_from(doc.buffer.content.len()).unwrap_or(u64::MAX) > self.max_bytes
+			|| toc_depth(&doc.toc_items) > MAX_TOC_DEPTH
+		{
+			return;
+		}
+		let bytes = encode_entry(doc, key);
+		if u64::try_from(bytes.len()).unwrap_or(u64::MAX) > self.max_bytes || fs::create_dir_all(&self.dir).is_err() {
+			return;
+		}
+		let path = self.dir.join(&key.file_name);
+		// Loader workers may store concurrently, so each write goes through its own temporary file and a rename.
+		let temp_id = NEXT_TEMP_ID.fetch_add(1, Ordering::Relaxed);
+		let temp = self.dir.join(format!("{}.{}-{temp_id}.tmp", key.file_name, std::process::id()));
+		if fs::write(&temp, &bytes).and_then(|()| fs::rename(&temp, &path)).is_err() {
+			let _ = fs::remove_file(&temp);
+			return;
+		}
+		self.evict(&path);
+	}
+
+	/// Deletes the least recently used entries until the cache fits its budget, never touching `keep`.
+	fn evict(&self, keep: &Path) {
+		let Ok(dir) = fs::read_dir(&self.dir) else {
+			return;
+		};
+		let mut entries: Vec<(SystemTime, u64, PathBuf)> = dir
+			.filter_map(Result::ok)
+			.map(|entry| entry.path())
+			.filter(|path| path.extension().is_some_and(|ext| ext == ENTRY_EXTENSION))
+			.filter_map(|path| {
+				let metadata = fs::metadata(&path).ok()?;
+				Some((metadata.modified().unwrap_or(UNIX_EPOCH), metadata.len(), path))
+			})
+			.collect();
+		let mut total: u64 = entries.iter().map(|&(_, len, _)| len).sum();
+		if total <= self.max_bytes {
+			return;
+		}
+		entries.sort_by_key(|&(modified, _, _)| modified);
+		for (_, len, path) in entries {
+			if total <= self.max_bytes {
+				break;
+			}
+			if path != keep && fs::remove_file(&path).is_ok() {
+				total -= len;
+			}
+		}
+	}
+}
+
+/// Cheap 64-bit checksum over an entry's payload. It catches truncated and damaged files, not deliberate tampering,
+/// and mixes eight bytes per step so verifying a large entry costs little next to reading it.
+fn checksum(bytes: &[u8]) -> u64 {
+	const MULTIPLIER: u64 = 0x9E37_79B9_7F4A_7C15;
+	let mut hash = u64::try_from(bytes.len()).unwrap_or(u64::MAX) ^ 0xCBF2_9CE4_8422_2325;
+	let mut words = bytes.chunks_exact(8);
+	for chunk in &mut words {
+		let mut word = [0; 8];
+		word.copy_from_slice(chunk);
+		hash = (hash ^ u64::from_le_bytes(word)).wrapping_mul(MULTIPLIER).rotate_left(29);
+	}
+	for &byte in words.remainder() {
+		hash = (hash ^ u64::from(byte)).wrapping_mul(MULTIPLIER);
+	}
+	hash
+}
+
+/// Layout: magic, format version, parser version, source path, size and mtime, payload length, payload checksum, then
+/// the payload. All integers are little-endian; sizes and offsets are stored as `u64`.
+fn encode_entry(doc: &Document, key: &CacheKey) -> Vec<u8> {
+	let mut payload = Encoder::with_capacity(doc.buffer.content.len() + doc.buffer.markers.len() * MIN_MARKER_LEN);
+	encode_document(&mut payload, doc);
+	let payload = payload.bytes;
+	let mut entry = Encoder::with_capacity(payload.len() + key.source_path.len() + 56);
+	entry.bytes.extend_from_slice(&MAGIC);
+	entry.u32(FORMAT_VERSION);
+	entry.u32(PARSER_VERSION);
+	entry.slice(&key.source_path);
+	entry.u64(key.source_len);
+	entry.u64(key.source_modified);
+	entry.usize(payload.len());
+	entry.u64(checksum(&payload));
+	entry.bytes.extend_from_slice(&payload);
+	entry.bytes
+}
+
+fn decode_entry(bytes: &[u8], key: &CacheKey) -> Option<Document> {
+	let mut header = Decoder { bytes };
+	if header.take(MAGIC.len())? != MAGIC.as_slice()
+		|| header.u32()? != FORMAT_VERSION
+		|| header.u32()? != PARSER_VERSION
+		|| header.slice()? != key.source_path.as_slice()
+		|| header.u64()? != key.source_len
+		|| header.u64()? != key.source_modified
+	{
+		return None;
+	}
+	let payload_len = header.usize()?;
+	let expected = header.u64()?;
+	let payload = header.take(payload_len)?;
+	if !header.bytes.is_empty() || checksum(payload) != expected {
+		return None;
+	}
+	decode_document(&mut Decoder { bytes: payload })
+}
+
+fn encode_document(out: &mut Encoder, doc: &Document) {
+	out.str(&doc.title);
+	out.str(&doc.author);
+	out.str(&doc.buffer.content);
+	out.usize(doc.buffer.markers.len());
+	for marker in &doc.buffer.markers {
+		out.i32(i32::from(marker.mtype));
+		out.usize(marker.position);
+		out.str(&marker.text);
+		out.str(&marker.reference);
+		out.i32(marker.level);
+		out.usize(marker.length);
+	}
+	encode_toc(out, &doc.toc_items);
+	out.usize(doc.id_positions.len());
+	for (id, &position) in &doc.id_positions {
+		out.str(id);
+		out.usize(position);
+	}
+	out.usize(doc.spine_items.len());
+	for item in &doc.spine_items {
+		out.str(item);
+	}
+	out.usize(doc.manifest_items.len());
+	for (id, href) in &doc.manifest_items {
+		out.str(id);
+		out.str(href);
+	}
+	out.usize(doc.stats.word_count);
+	out.usize(doc.stats.line_count);
+	out.usize(doc.stats.char_count);
+	out.usize(doc.stats.char_count_no_whitespace);
+}
+
+fn encode_toc(out: &mut Encoder, items: &[TocItem]) {
+	out.usize(items.len());
+	for item in items {
+		out.str(&item.name);
+		out.str(&item.reference);
+		out.usize(item.offset);
+		encode_toc(out, &item.children);
+	}
+}
+
+/// Number of nested levels in `items`; 0 when there are none.
+fn toc_depth(items: &[TocItem]) -> usize {
+	items.iter().map(|item| 1 + toc_depth(&item.children)).max().unwrap_or(0)
+}
+
+fn decode_document(input: &mut Decoder<'_>) -> Option<Document> {
+	let title = input.string()?;
+	let author = input.string()?;
+	// Rebuilding the position index from the text is a single linear pass, and keeps it out of the on-disk format.
+	let mut buffer = DocumentBuffer::with_content(input.string()?);
+	let marker_count = input.count(MIN_MARKER_LEN)?;
+	buffer.markers.reserve_exact(marker_count);
+	for _ in 0..marker_count {
+		let mtype = MarkerType::try_from(input.i32()?).ok()?;
+		let position = input.usize()?;
+		let text = input.string()?;
+		let reference = input.string()?;
+		let level = input.i32()?;
+		let length = input.usize()?;
+		buffer.add_marker(
+			Marker::new(mtype, position)
+				.with_text(text)
+				.with_reference(reference)
+				.with_level(level)
+				.with_length(length),
+		);
+	}
+	let toc_items = decode_toc(input, 1)?;
+	let id_count = input.count(MIN_STRING_PAIR_LEN)?;
+	let mut id_positions = HashMap::with_capacity(id_count);
+	for _ in 0..id_count {
+		id_positions.insert(input.string()?, input.usize()?);
+	}
+	let spine_count = input.count(MIN_STRING_LEN)?;
+	let mut spine_items = Vec::with_capacity(spine_count);
+	for _ in 0..spine_count {
+		spine_items.push(input.string()?);
+	}
+	let manifest_count = input.count(MIN_STRING_PAIR_LEN)?;
+	let mut manifest_items = HashMap::with_capacity(manifest_count);
+	for _ in 0..manifest_count {
+		manifest_items.insert(input.string()?, input.string()?);
+	}
+	let stats = DocumentStats {
+		word_count: input.usize()?,
+		line_count: input.usize()?,
+		char_count: input.usize()?,
+		char_count_no_whitespace: input.usize()?,
+	};
+	if !input.bytes.is_empty() {
+		return None;
+	}
+	let mut doc = Document::new().with_title(title).with_author(author);
+	doc.set_buffer(buffer);
+	doc.toc_items = toc_items;
+	doc.id_positions = id_positions;
+	doc.spine_items = spine_items;
+	doc.manifest_items = manifest_items;
+	doc.stats = stats;
+	Some(doc)
+}
+
+/// Decodes one level of the table of contents, `depth` being 1 for the top level.
+fn decode_toc(input: &mut Decoder<'_>, depth: usize) -> Option<Vec<TocItem>> {
+	let count = input.count(MIN_TOC_ITEM_LEN)?;
+	if count > 0 && depth > MAX_TOC_DEPTH {
+		return None;
+	}
+	let mut items = Vec::with_capacity(count);
+	for _ in 0..count {
+		let mut item = TocItem::new(input.string()?, input.string()?, input.usize()?);
+		item.children = decode_toc(input, depth + 1)?;
+		items.push(item);
+	}
+	Some(items)
+}
+
+struct Encoder {
+	bytes: Vec<u8>,
+}
+
+impl Encoder {
+	fn with_capacity(capacity: usize) -> Self {
+		Self { bytes: Vec::with_capacity(capacity) }
+	}
+
+	fn u32(&mut self, value: u32) {
+		self.bytes.extend_from_slice(&value.to_le_bytes());
+	}
+
+	fn i32(&mut self, value: i32) {
+		self.bytes.extend_from_slice(&value.to_le_bytes());
+	}
+
+	fn u64(&mut self, value: u64) {
+		self.bytes.extend_from_slice(&value.to_le_bytes());
+	}
+
+	fn usize(&mut self, value: usize) {
+		self.u64(u64::try_from(value).unwrap_or(u64::MAX));
+	}
+
+	fn slice(&mut self, value: &[u8]) {
+		self.usize(value.len());
+		self.bytes.extend_from_slice(value);
+	}
+
+	fn str(&mut self, value: &str) {
+		self.slice(value.as_bytes());
+	}
+}
+
+/// Reads the fields written by [`Encoder`]; every read returns `None` once the input runs short.
+struct Decoder<'a> {
+	bytes: &'a [u8],
+}
+
+impl<'a> Decoder<'a> {
+	const fn take(&mut self, len: usize) -> Option<&'a [u8]> {
+		if len > self.bytes.len() {
+			return None;
+		}
+		let (head, rest) = self.bytes.split_at(len);
+		self.bytes = rest;
+		Some(head)
+	}
+
+	fn array<const N: usize>(&mut self) -> Option<[u8; N]> {
+		self.take(N)?.try_into().ok()
+	}
+
+	fn u32(&mut self) -> Option<u32> {
+		self.array().map(u32::from_le_bytes)
+	}
+
+	fn i32(&mut self) -> Option<i32> {
+		self.array().map(i32::from_le_bytes)
+	}
+
+	fn u64(&mut self) -> Option<u64> {
+		self.array().map(u64::from_le_bytes)
+	}
+
+	fn usize(&mut self) -> Option<usize> {
+		usize::try_from(self.u64()?).ok()
+	}
+
+	fn slice(&mut self) -> Option<&'a [u8]> {
+		let len = self.usize()?;
+		self.take(len)
+	}
+
+	fn string(&mut self) -> Option<String> {
+		String::from_utf8(self.slice()?.to_vec()).ok()
+	}
+
+	/// A record count, rejected when that many records of at least `min_len` bytes cannot fit in the rest.
+	fn count(&mut self, min_len: usize) -> Option<usize> {
+		let count = self.usize()?;
+		(count.checked_mul(min_len)? <= self.bytes.len()).then_some(count)
+	}
+}
+
+#[cfg(test)]
+mod tests {
+	use std::time::Duration;
+
+	use super::*;
+
+	fn unique_temp_dir(name: &str) -> PathBuf {
+		let nanos = SystemTime::now().duration_since(UNIX_EPOCH).unwrap().as_nanos();
+		std::env::temp_dir().join(format!("paperback_cache_test_{name}_{nanos}"))
+	}
+
+	fn sample_document() -> Document {
+		let mut buffer = DocumentBuffer::new();
+		buffer.append("Chapter one\nCafé 😀 text\n");
+		buffer.add_marker(Marker::new(MarkerType::Heading1, 0).with_level(1).with_text("Chapter one".to_string()));
+		buffer.add_marker(Marker::new(MarkerType::Link, 12).with_reference("#note".to_string()).with_length(4));
+		let mut doc = Document::new().with_title("Title".to_string()).with_author("Author".to_string());
+		doc.set_buffer(buffer);
+		let mut part = TocItem::new("Part".to_string(), "part.xhtml".to_string(), 0);
+		part.children.push(TocItem::new("Chapter".to_string(), "ch1.xhtml#c1".to_string(), 12));
+		doc.toc_items = vec![part];
+		doc.id_positions.insert("note".to_string(), 12);
+		doc.spine_items = vec!["part".to_string()];
+		doc.manifest_items.insert("part".to_string(), "part.xhtml".to_string());
+		doc.compute_stats();
+		doc
+	}
+
+	fn key(name: &str) -> CacheKey {
+		CacheKey {
+			file_name: format!("{name}.{ENTRY_EXTENSION}"),
+			source_path: format!("/books/{name}.epub").into_bytes(),
+			source_len: 100,
+			source_modified: 42,
+		}
+	}
+
+	#[test]
+	fn entry_round_trips_every_document_field() {
+		let doc = sample_document();
+		let decoded = decode_entry(&encode_entry(&doc, &key("a")), &key("a")).expect("decodes");
+		assert_eq!(decoded.title, doc.title);
+		assert_eq!(decoded.author, doc.author);
+		assert_eq!(decoded.buffer.content, doc.buffer.content);
+		assert_eq!(decoded.buffer.current_position(), doc.buffer.current_position());
+		assert_eq!(decoded.buffer.newline_positions(), doc.buffer.newline_positions());
+		let markers = |d: &Document| {
+			d.buffer
+				.markers
+				.iter()
+				.map(|m| (m.mtype, m.position, m.text.clone(), m.reference.clone(), m.level, m.length))
+				.collect::<Vec<_>>()
+		};
+		assert_eq!(markers(&decoded), markers(&doc));
+		assert_eq!(decoded.toc_items[0].children[0].reference, "ch1.xhtml#c1");
+		assert_eq!(decoded.toc_items[0].children[0].offset, 12);
+		assert_eq!(decoded.id_positions, doc.id_positions);
+		assert_eq!(decoded.spine_items, doc.spine_items);
+		assert_eq!(decoded.manifest_items, doc.manifest_items);
+		assert_eq!(decoded.stats.word_count, doc.stats.word_count);
+		assert_eq!(decoded.stats.char_count_no_whitespace, doc.stats.char_count_no_whitespace);
+	}
+
+	#[test]
+	fn entry_for_changed_source_is_rejected() {
+		let bytes = encode_entry(&sample_document(), &key("a"));
+		let touched = CacheKey { source_modified: 43, ..key("a") };
+		assert!(decode_entry(&bytes, &touched).is_none());
+		let elsewhere = CacheKey { file_name: key("a").file_name, ..key("b") };
+		assert!(decode_entry(&bytes, &elsewhere).is_none());
+	}
+
+	#[test]
+	fn key_follows_the_canonical_path_and_options() {
+		let dir = unique_temp_dir("key");
+		fs::create_dir_all(dir.join("sub")).unwrap();
+		let file = dir.join("book.txt");
+		fs::write(&file, "text").unwrap();
+		let direct = CacheKey::for_file(file.to_str().unwrap(), "", false).unwrap();
+		let roundabout = CacheKey::for_file(dir.join("sub/../book.txt").to_str().unwrap(), "", false).unwrap();
+		assert_eq!(direct, roundabout);
+		assert_eq!(direct.source_len, 4);
+		assert_ne!(CacheKey::for_file(file.to_str().unwrap(), "md", false).unwrap().file_name, direct.file_name);
+		assert_ne!(CacheKey::for_file(file.to_str().unwrap(), "", true).unwrap().file_name, direct.file_name);
+		assert!(CacheKey::for_file(dir.join("missing.txt").to_str().unwrap(), "", false).is_none());
+		let _ = fs::remove_dir_all(&dir);
+	}
+
+	#[test]
+	fn damaged_or_truncated_entries_are_rejected() {
+		let bytes = encode_entry(&sample_document(), &key("a"));
+		let mut flipped = bytes.clone();
+		let last = flipped.len() - 20;
+		flipped[last] ^= 0x01;
+		assert!(decode_entry(&flipped, &key("a")).is_none());
+		assert!(decode_entry(&bytes[..bytes.len() - 1], &key("a")).is_none());
+	}
+
+	#[test]
+	fn toc_nested_past_the_depth_limit_is_rejected() {
+		let nested = |depth: usize| {
+			let mut doc = sample_document();
+			doc.toc_items = (0..depth).fold(Vec::new(), |children, level| {
+				let mut item = TocItem::new(format!("Level {level}"), String::new(), 0);
+				item.children = children;
+				vec![item]
+			});
+			doc
+		};
+		let deepest = nested(MAX_TOC_DEPTH);
+		assert_eq!(toc_depth(&deepest.toc_items), MAX_TOC_DEPTH);
+		assert!(decode_entry(&encode_entry(&deepest, &key("a")), &key("a")).is_some());
+		assert!(decode_entry(&encode_entry(&nested(MAX_TOC_DEPTH + 1), &key("a")), &key("a")).is_none());
+	}
+
+	#[test]
+	fn store_then_load_hits_and_corrupt_file_is_removed() {
+		let dir = unique_temp_dir("store");
+		let cache = DocumentCache::new(dir.clone(), DEFAULT_MAX_CACHE_BYTES);
+		assert!(cache.load(&key("a")).is_none());
+		cache.store(&key("a"), &sample_document());
+		assert_eq!(cache.load(&key("a")).expect("cache hit").buffer.content, sample_document().buffer.content);
+		let path = dir.join(&key("a").file_name);
+		fs::write(&path, b"PBDC garbage").unwrap();
+		assert!(cache.load(&key("a")).is_none());
+		assert!(!path.exists());
+		let _ = fs::remove_dir_all(&dir);
+	}
+
+	#[test]
+	fn store_evicts_least_recently_used_entries_over_budget() {
+		let dir = unique_temp_dir("evict");
+		let entry_len = u64::try_from(encode_entry(&sample_document(), &key("a")).len()).unwrap();
+		let cache = DocumentCache::new(dir.clone(), entry_len * 2);
+		cache.store(&key("a"), &sample_document());
+		cache.store(&key("b"), &sample_document());
+		let age = |name: &str, secs: u64| {
+			let file = File::options().write(true).open(dir.join(&key(name).file_name)).unwrap();
+			file.set_modified(UNIX_EPOCH + Duration::from_secs(secs)).unwrap();
+		};
+		age("a", 1_000);
+		age("b", 2_000);
+		// Reading "a" makes "b" the least recently used entry.
+		assert!(cache.load(&key("a")).is_some());
+		cache.store(&key("c"), &sample_document());
+		assert!(dir.join(&key("a").file_name).exists());
+		assert!(!dir.join(&key("b").file_name).exists());
+		assert!(dir.join(&key("c").file_name).exists());
+		let _ = fs::remove_dir_all(&dir);
+	}
+}
@@ -115,8 +115,9 @@ impl ConfigManagerFfi {
 		self.inner.lock().unwrap().export_document_settings(&doc_path, &export_path);
 	}
 
+	/// Waits for the write to reach the disk, since mobile apps can be killed in the background without unwinding.
 	pub fn flush(&self) {
-		self.inner.lock().unwrap().flush();
+		self.inner.lock().unwrap().sync();
 	}
 }
 
@@ -0,0 +1,179 @@
+//! Following a text file that keeps growing, such as a service log, after it has been opened.
+
+use std::{
+	fs::{File, Metadata},
+	io::{self, Read, Seek, SeekFrom},
+	path::PathBuf,
+};
+
+use encoding_rs::{Decoder, Encoding};
+
+use crate::util::text::strip_soft_hyphens;
+
+#[derive(Debug, PartialEq, Eq)]
+pub enum FollowUpdate {
+	Unchanged,
+	/// Text decoded from the bytes written since the last poll.
+	Appended(String),
+	/// The file is now shorter than what has been read, or a different file has taken its place.
+	Truncated,
+}
+
+/// Reads whatever is appended to a file past a known offset, decoding it in the encoding the parser read the file as.
+///
+/// A multi-byte character split across two writes is held in the decoder until its remaining bytes arrive.
+pub struct FileFollower {
+	path: PathBuf,
+	offset: u64,
+	decoder: Decoder,
+	identity: Option<FileIdentity>,
+}
+
+/// Tells apart two files that were at the same path, such as a log before and after rotation, even when the new one
+/// has already grown past the old one's length.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+struct FileIdentity(u64, u64);
+
+impl FileIdentity {
+	#[cfg(unix)]
+	fn of(metadata: &Metadata) -> Option<Self> {
+		use std::os::unix::fs::MetadataExt;
+		Some(Self(metadata.dev(), metadata.ino()))
+	}
+
+	/// The file index is not exposed on stable Rust, so Windows falls back to the creation time. A file recreated
+	/// under the same name within seconds can inherit the old one's (file system tunneling), which the length check
+	/// still covers when the new file is shorter.
+	#[cfg(windows)]
+	fn of(metadata: &Metadata) -> Option<Self> {
+		use std::os::windows::fs::MetadataExt;
+		Some(Self(0, metadata.creation_time()))
+	}
+
+	#[cfg(not(any(unix, windows)))]
+	fn of(_metadata: &Metadata) -> Option<Self> {
+		None
+	}
+}
+
+impl FileFollower {
+	/// Starts following `path` from byte `offset`, the length that has already been read as `encoding`. Returns `None`
+	/// if the file cannot be opened.
+	///
+	/// The encoding is the one the parser settled on for the whole file, not sniffed again here: a file that only
+	/// turned out not to be UTF-8 past its first few kilobytes was read as Windows-1252, and so must its new lines be.
+	#[must_use]
+	pub fn new(path: PathBuf, offset: u64, encoding: &'static Encoding) -> Option<Self> {
+		let file = File::open(&path).ok()?;
+		let identity = FileIdentity::of(&file.metadata().ok()?);
+		// Any BOM is behind `offset`, so the appended bytes are decoded without sniffing for one.
+		Some(Self { path, offset, decoder: encoding.new_decoder_without_bom_handling(), identity })
+	}
+
+	/// Checks the file's length and decodes anything written since the last call. Costs one `stat` when nothing
+	/// changed, and otherwise work proportional to the new bytes only.
+	///
+	/// # Errors
+	///
+	/// Returns an error if the file can no longer be read.
+	pub fn poll(&mut self) -> io::Result<FollowUpdate> {
+		let mut file = File::open(&self.path)?;
+		let metadata = file.metadata()?;
+		let len = metadata.len();
+		if len < self.offset || FileIdentity::of(&metadata) != self.identity {
+			return Ok(FollowUpdate::Truncated);
+		}
+		if len == self.offset {
+			return Ok(FollowUpdate::Unchanged);
+		}
+		file.seek(SeekFrom::Start(self.offset))?;
+		let mut bytes = Vec::with_capacity(usize::try_from(len - self.offset).unwrap_or(0));
+		file.take(len - self.offset).read_to_end(&mut bytes)?;
+		self.offset += u64::try_from(bytes.len()).unwrap_or(0);
+		let mut text = String::with_capacity(self.decoder.max_utf8_buffer_length(bytes.len()).unwrap_or(bytes.len()));
+		let _ = self.decoder.decode_to_string(&bytes, &mut text, false);
+		strip_soft_hyphens(&mut text);
+		Ok(if text.is_empty() { FollowUpdate::Unchanged } else { FollowUpdate::Appended(text) })
+	}
+
+	/// Byte offset up to which the file has been read.
+	#[must_use]
+	pub const fn offset(&self) -> u64 {
+		self.offset
+	}
+}
+
+#[cfg(test)]
+mod tests {
+	use std::{fs, io::Write};
+
+	use encoding_rs::{UTF_8, UTF_16LE, WINDOWS_1252};
+
+	use super::*;
+
+	fn temp_file(name: &str, contents: &[u8]) -> PathBuf {
+		let nanos = std::time::SystemTime::now().duration_since(std::time::UNIX_EPOCH).unwrap().as_nanos();
+		let path = std::env::temp_dir().join(format!("paperback_follow_test_{name}_{nanos}.log"));
+		fs::write(&path, contents).unwrap();
+		path
+	}
+
+	fn append(path: &PathBuf, bytes: &[u8]) {
+		fs::OpenOptions::new().append(true).open(path).unwrap().write_all(bytes).unwrap();
+	}
+
+	#[test]
+	fn appended_text_is_decoded_across_split_characters() {
+		let path = temp_file("split", b"first line\n");
+		let mut follower = FileFollower::new(path.clone(), 11, UTF_8).unwrap();
+		assert_eq!(follower.poll().unwrap(), FollowUpdate::Unchanged);
+		append(&path, "caf\u{e9}".as_bytes().split_last().unwrap().1);
+		assert_eq!(follower.poll().unwrap(), FollowUpdate::Appended("caf".to_string()));
+		append(&path, &[0xA9, b'\n']);
+		assert_eq!(follower.poll().unwrap(), FollowUpdate::Appended("\u{e9}\n".to_string()));
+		assert_eq!(follower.offset(), fs::metadata(&path).unwrap().len());
+		fs::remove_file(path).unwrap();
+	}
+
+	#[test]
+	fn utf16_with_bom_keeps_its_encoding() {
+		let path = temp_file("utf16", &[0xFF, 0xFE, b'a', 0]);
+		let mut follower = FileFollower::new(path.clone(), 4, UTF_16LE).unwrap();
+		append(&path, &[b'b', 0, b'\n', 0]);
+		assert_eq!(follower.poll().unwrap(), FollowUpdate::Appended("b\n".to_string()));
+		fs::remove_file(path).unwrap();
+	}
+
+	#[test]
+	fn appended_bytes_use_the_encoding_the_file_was_read_as() {
+		// The start is valid UTF-8, but a malformed sequence further in had the whole file read as Windows-1252.
+		let path = temp_file("cp1252", b"plain start\n");
+		let mut follower = FileFollower::new(path.clone(), 12, WINDOWS_1252).unwrap();
+		append(&path, b"caf\xE9\n");
+		assert_eq!(follower.poll().unwrap(), FollowUpdate::Appended("caf\u{e9}\n".to_string()));
+		fs::remove_file(path).unwrap();
+	}
+
+	#[test]
+	fn truncation_is_reported() {
+		let path = temp_file("truncate", b"0123456789");
+		let mut follower = FileFollower::new(path.clone(), 10, UTF_8).unwrap();
+		fs::write(&path, b"new").unwrap();
+		assert_eq!(follower.poll().unwrap(), FollowUpdate::Truncated);
+		fs::remove_file(path).unwrap();
+	}
+
+	#[cfg(unix)]
+	#[test]
+	fn replacement_by_a_longer_file_is_reported() {
+		let path = temp_file("rotate", b"0123456789");
+		let mut follower = FileFollower::new(path.clone(), 10, UTF_8).unwrap();
+		// Rotation: the old log is moved aside and a new one, already longer, takes its name.
+		let rotated = path.with_extension("log.1");
+		fs::rename(&path, &rotated).unwrap();
+		fs::write(&path, b"a new log that is longer than the old one\n").unwrap();
+		assert_eq!(follower.poll().unwrap(), FollowUpdate::Truncated);
+		fs::remove_file(path).unwrap();
+		fs::remove_file(rotated).unwrap();
+	}
+}
@@ -2,8 +2,10 @@
 
 pub mod config;
 pub mod document;
+pub mod document_cache;
 pub mod export;
 pub mod ffi_config;
+pub mod follow;
 pub mod parser;
 pub mod reader_core;
 pub mod session;
@@ -14,9 +16,9 @@ pub mod version;
 pub use crate::{
 	ffi_config::ConfigManagerFfi,
 	session::{
-		DocumentError, DocumentSession, DocumentStatsFfi, HeadingTreeFfi, HeadingTreeItemFfi, LineMarker, LinkAction,
-		LinkActivationResult, LinkListFfi, LinkListItemFfi, MarkerTypeFfi, SearchOptionsFfi, SearchResultFfi,
-		SegmentDirectionFfi, SegmentTypeFfi, StatusInfo, TextSegmentFfi, TocEntry,
+		DocumentError, DocumentSession, DocumentStatsFfi, FindAllHitFfi, FindAllListener, FindAllTask, HeadingTreeFfi,
+		HeadingTreeItemFfi, LineMarker, LinkAction, LinkActivationResult, LinkListFfi, LinkListItemFfi, MarkerTypeFfi,
+		SearchOptionsFfi, SearchResultFfi, SegmentDirectionFfi, SegmentTypeFfi, StatusInfo, TextSegmentFfi, TocEntry,
 	},
 };
 
@@ -27,6 +29,14 @@ pub fn set_pdfium_library_path(path: String) {
 	pdfium::set_library_location(&path);
 }
 
+/// Enables the parsed-document cache in `path`, capped at [`document_cache::DEFAULT_MAX_CACHE_BYTES`].
+pub fn set_document_cache_dir(path: String) {
+	document_cache::init_global(document_cache::DocumentCache::new(
+		path.into(),
+		document_cache::DEFAULT_MAX_CACHE_BYTES,
+	));
+}
+
 /// Translates library-internal strings (e.g. document content labels, parser error messages).
 ///
 /// `patois`'s "ui" feature (which pulls in wxdragon) is never enabled here, so this stays free
@@ -8,7 +8,7 @@ use std::{
 use anyhow::Result;
 
 use crate::{
-	document::{Document, DocumentBuffer, Marker, MarkerType, ParserContext, ParserFlags},
+	document::{Document, DocumentBuffer, DocumentChunk, Marker, MarkerType, ParserContext, ParserFlags},
 	t,
 	types::{FormatInfo, HeadingInfo, ImageInfo, LinkInfo, ListInfo, ListItemInfo, SeparatorInfo, TableInfo},
 };
@@ -34,6 +34,10 @@ pub mod xml_to_text;
 
 pub const PASSWORD_REQUIRED_ERROR_PREFIX: &str = "[password_required]";
 
+/// Revision of the documents the parsers produce. Bump it whenever a parser change alters the output for an existing
+/// file, so [`crate::document_cache`] entries written by older builds are not reused.
+pub const PARSER_VERSION: u32 = 2;
+
 pub trait Parser: Send + Sync {
 	fn name(&self) -> &str;
 	fn extensions(&self) -> &[&str];
@@ -44,6 +48,58 @@ pub trait Parser: Send + Sync {
 	///
 	/// Returns an error if the file cannot be read or parsed.
 	fn parse(&self, context: &ParserContext) -> Result<Document>;
+	/// Parse a document, handing each page or section to `on_chunk` as soon as it is in the buffer. With no `on_chunk`
+	/// this is [`Self::parse`], and no chunk is built.
+	///
+	/// Chunks arrive in document order and their text concatenates to a prefix of the returned document's
+	/// content, unless the parser finds partway through that its guess at the encoding was wrong: it then stops
+	/// emitting, and the chunks so far are only a preview. Markers that can only be placed once the whole document is known, such as headings derived from
+	/// the TOC, appear only in the returned document. The default implementation reports no chunks.
+	///
+	/// # Errors
+	///
+	/// Returns an error if the file cannot be read or parsed.
+	fn parse_streaming(
+		&self,
+		context: &ParserContext,
+		on_chunk: Option<&mut dyn FnMut(DocumentChunk)>,
+	) -> Result<Document> {
+		let _ = on_chunk;
+		self.parse(context)
+	}
+}
+
+/// Reports whatever has been appended to a growing [`DocumentBuffer`] since the last call as a [`DocumentChunk`].
+/// Without a listener it does nothing, so a plain parse does not copy its text into chunks nobody reads.
+pub struct ChunkEmitter<'a> {
+	on_chunk: Option<&'a mut dyn FnMut(DocumentChunk)>,
+	reported_bytes: usize,
+	reported_markers: usize,
+	reported_position: usize,
+}
+
+impl<'a> ChunkEmitter<'a> {
+	pub fn new(on_chunk: Option<&'a mut dyn FnMut(DocumentChunk)>) -> Self {
+		Self { on_chunk, reported_bytes: 0, reported_markers: 0, reported_position: 0 }
+	}
+
+	pub fn emit(&mut self, buffer: &DocumentBuffer) {
+		let Some(on_chunk) = self.on_chunk.as_mut() else {
+			return;
+		};
+		if buffer.content.len() == self.reported_bytes && buffer.markers.len() == self.reported_markers {
+			return;
+		}
+		let chunk = DocumentChunk {
+			start: self.reported_position,
+			text: buffer.content[self.reported_bytes..].to_string(),
+			markers: buffer.markers[self.reported_markers..].to_vec(),
+		};
+		self.reported_bytes = buffer.content.len();
+		self.reported_markers = buffer.markers.len();
+		self.reported_position = buffer.current_position();
+		on_chunk(chunk);
+	}
 }
 
 pub struct ParserInfo {
@@ -124,6 +180,25 @@ impl ParserRegistry {
 /// - No parser is available for the file extension
 /// - The parser fails to parse the file
 pub fn parse_document(context: &ParserContext) -> Result<Document> {
+	parse_document_with(context, None)
+}
+
+/// Parse a document, reporting pages or sections to `on_chunk` as they are parsed.
+///
+/// Only the first parser tried for the extension streams; if it fails and a fallback parser succeeds, the
+/// fallback's document arrives without chunks, so callers must treat chunks as a preview of the returned document.
+///
+/// # Errors
+///
+/// Same as [`parse_document`].
+pub fn parse_document_streaming(context: &ParserContext, on_chunk: &mut dyn FnMut(DocumentChunk)) -> Result<Document> {
+	parse_document_with(context, Some(on_chunk))
+}
+
+fn parse_document_with(
+	context: &ParserContext,
+	mut on_chunk: Option<&mut dyn FnMut(DocumentChunk)>,
+) -> Result<Document> {
 	let path = Path::new(&context.file_path);
 	let extension = context.forced_extension.as_ref().map_or_else(
 		|| {
@@ -140,8 +215,10 @@ pub fn parse_document(context: &ParserContext) -> Result<Document> {
 		return Err(anyhow::anyhow!(t("No parser found for extension: .{}").replace("{}", extension)));
 	}
 	let mut last_error = None;
-	for parser in parsers {
-		match parser.parse(context) {
+	for (attempt, parser) in parsers.into_iter().enumerate() {
+		let parsed =
+			if attempt == 0 { parser.parse_streaming(context, on_chunk.take()) } else { parser.parse(context) };
+		match parsed {
 			Ok(mut doc) => {
 				doc.compute_stats();
 				return Ok(doc);
@@ -258,77 +335,179 @@ pub trait ConverterOutput {
 	fn get_underlines(&self) -> &[FormatInfo];
 }
 
-fn add_headings(buffer: &mut DocumentBuffer, converter: &dyn ConverterOutput, offset: usize) {
-	for heading in converter.get_headings() {
-		let marker_type = util::toc::heading_level_to_marker_type(heading.level);
-		buffer.add_marker(
-			Marker::new(marker_type, offset + heading.offset).with_text(heading.text.clone()).with_level(heading.level),
+/// Everything a converter produced, moved out of it by `into_parts` so the text and the marker strings reach the
+/// [`DocumentBuffer`] without being copied.
+#[derive(Debug, Default)]
+pub struct ConverterParts {
+	pub text: String,
+	pub headings: Vec<HeadingInfo>,
+	pub links: Vec<LinkInfo>,
+	pub images: Vec<ImageInfo>,
+	pub figures: Vec<ImageInfo>,
+	pub tables: Vec<TableInfo>,
+	pub separators: Vec<SeparatorInfo>,
+	pub lists: Vec<ListInfo>,
+	pub list_items: Vec<ListItemInfo>,
+	pub bolds: Vec<FormatInfo>,
+	pub italics: Vec<FormatInfo>,
+	pub underlines: Vec<FormatInfo>,
+	pub id_positions: HashMap<String, usize>,
+}
+
+impl ConverterParts {
+	/// Moves every marker into `buffer`, offset by `offset`, leaving the marker lists empty. `text` and
+	/// `id_positions` are left for the caller.
+	pub fn move_markers_into(&mut self, buffer: &mut DocumentBuffer, offset: usize) {
+		self.move_markers(buffer, offset, true);
+	}
+
+	/// Like [`Self::move_markers_into`] but keeps `links`, for parsers that resolve link hrefs specially.
+	pub fn move_markers_excluding_links_into(&mut self, buffer: &mut DocumentBuffer, offset: usize) {
+		self.move_markers(buffer, offset, false);
+	}
+
+	fn move_markers(&mut self, buffer: &mut DocumentBuffer, offset: usize, include_links: bool) {
+		let markers = &mut buffer.markers;
+		markers.reserve(
+			self.headings.len()
+				+ if include_links { self.links.len() } else { 0 }
+				+ self.images.len()
+				+ self.figures.len()
+				+ self.tables.len()
+				+ self.separators.len()
+				+ self.lists.len()
+				+ self.list_items.len()
+				+ self.bolds.len()
+				+ self.italics.len()
+				+ self.underlines.len(),
+		);
+		markers.extend(self.headings.drain(..).map(|heading| heading_marker(heading, offset)));
+		if include_links {
+			markers.extend(self.links.drain(..).map(|link| link_marker(link, offset)));
+		}
+		markers.extend(self.images.drain(..).map(|image| image_marker(MarkerType::Image, image, offset)));
+		markers.extend(self.figures.drain(..).map(|figure| image_marker(MarkerType::Figure, figure, offset)));
+		markers.extend(self.tables.drain(..).map(|table| table_marker(table, offset)));
+		markers.extend(self.separators.drain(..).map(|separator| separator_marker(&separator, offset)));
+		markers.extend(self.lists.drain(..).map(|list| list_marker(&list, offset)));
+		markers.extend(self.list_items.drain(..).map(|list_item| list_item_marker(list_item, offset)));
+		markers.extend(self.bolds.drain(..).map(|bold| format_marker(MarkerType::Bold, &bold, offset)));
+		markers.extend(self.italics.drain(..).map(|italic| format_marker(MarkerType::Italic, &italic, offset)));
+		markers.extend(
+			self.underlines.drain(..).map(|underline| format_marker(MarkerType::Underline, &underline, offset)),
 		);
 	}
 }
 
-fn add_links(buffer: &mut DocumentBuffer, converter: &dyn ConverterOutput, offset: usize) {
-	for link in converter.get_links() {
-		buffer.add_marker(
-			Marker::new(MarkerType::Link, offset + link.offset)
-				.with_text(link.text.clone())
-				.with_reference(link.reference.clone()),
-		);
+impl ConverterOutput for ConverterParts {
+	fn get_headings(&self) -> &[HeadingInfo] {
+		&self.headings
+	}
+	fn get_links(&self) -> &[LinkInfo] {
+		&self.links
 	}
+	fn get_images(&self) -> &[ImageInfo] {
+		&self.images
+	}
+	fn get_figures(&self) -> &[ImageInfo] {
+		&self.figures
+	}
+	fn get_tables(&self) -> &[TableInfo] {
+		&self.tables
+	}
+	fn get_separators(&self) -> &[SeparatorInfo] {
+		&self.separators
+	}
+	fn get_lists(&self) -> &[ListInfo] {
+		&self.lists
+	}
+	fn get_list_items(&self) -> &[ListItemInfo] {
+		&self.list_items
+	}
+	fn get_bolds(&self) -> &[FormatInfo] {
+		&self.bolds
+	}
+	fn get_italics(&self) -> &[FormatInfo] {
+		&self.italics
+	}
+	fn get_underlines(&self) -> &[FormatInfo] {
+		&self.underlines
+	}
+}
+
+fn heading_marker(heading: HeadingInfo, offset: usize) -> Marker {
+	let marker_type = util::toc::heading_level_to_marker_type(heading.level);
+	Marker::new(marker_type, offset + heading.offset).with_text(heading.text).with_level(heading.level)
+}
+
+fn link_marker(link: LinkInfo, offset: usize) -> Marker {
+	Marker::new(MarkerType::Link, offset + link.offset).with_text(link.text).with_reference(link.reference)
+}
+
+fn image_marker(marker_type: MarkerType, image: ImageInfo, offset: usize) -> Marker {
+	Marker::new(marker_type, offset + image.offset).with_text(image.alt_text)
+}
+
+fn table_marker(table: TableInfo, offset: usize) -> Marker {
+	Marker::new(MarkerType::Table, offset + table.offset)
+		.with_text(table.text)
+		.with_reference(table.html_content)
+		.with_length(table.length)
+}
+
+fn separator_marker(separator: &SeparatorInfo, offset: usize) -> Marker {
+	Marker::new(MarkerType::Separator, offset + separator.offset)
+		.with_text("Separator".to_string())
+		.with_length(separator.length)
+}
+
+const fn list_marker(list: &ListInfo, offset: usize) -> Marker {
+	Marker::new(MarkerType::List, offset + list.offset).with_level(list.item_count).with_length(list.length)
+}
+
+fn list_item_marker(list_item: ListItemInfo, offset: usize) -> Marker {
+	Marker::new(MarkerType::ListItem, offset + list_item.offset).with_text(list_item.text).with_level(list_item.level)
+}
+
+const fn format_marker(marker_type: MarkerType, format: &FormatInfo, offset: usize) -> Marker {
+	Marker::new(marker_type, offset + format.offset).with_length(format.length)
+}
+
+fn add_headings(buffer: &mut DocumentBuffer, converter: &dyn ConverterOutput, offset: usize) {
+	buffer.markers.extend(converter.get_headings().iter().cloned().map(|heading| heading_marker(heading, offset)));
+}
+
+fn add_links(buffer: &mut DocumentBuffer, converter: &dyn ConverterOutput, offset: usize) {
+	buffer.markers.extend(converter.get_links().iter().cloned().map(|link| link_marker(link, offset)));
 }
 
 fn add_images(buffer: &mut DocumentBuffer, converter: &dyn ConverterOutput, offset: usize) {
-	for image in converter.get_images() {
-		buffer.add_marker(Marker::new(MarkerType::Image, offset + image.offset).with_text(image.alt_text.clone()));
-	}
+	buffer
+		.markers
+		.extend(converter.get_images().iter().cloned().map(|image| image_marker(MarkerType::Image, image, offset)));
 }
 
 fn add_figures(buffer: &mut DocumentBuffer, converter: &dyn ConverterOutput, offset: usize) {
-	for figure in converter.get_figures() {
-		buffer.add_marker(Marker::new(MarkerType::Figure, offset + figure.offset).with_text(figure.alt_text.clone()));
-	}
+	buffer
+		.markers
+		.extend(converter.get_figures().iter().cloned().map(|figure| image_marker(MarkerType::Figure, figure, offset)));
 }
 
 fn add_tables_separators_lists(buffer: &mut DocumentBuffer, converter: &dyn ConverterOutput, offset: usize) {
-	for table in converter.get_tables() {
-		buffer.add_marker(
-			Marker::new(MarkerType::Table, offset + table.offset)
-				.with_text(table.text.clone())
-				.with_reference(table.html_content.clone())
-				.with_length(table.length),
-		);
-	}
-	for separator in converter.get_separators() {
-		buffer.add_marker(
-			Marker::new(MarkerType::Separator, offset + separator.offset)
-				.with_text("Separator".to_string())
-				.with_length(separator.length),
-		);
-	}
-	for list in converter.get_lists() {
-		buffer.add_marker(
-			Marker::new(MarkerType::List, offset + list.offset).with_level(list.item_count).with_length(list.length),
-		);
-	}
-	for list_item in converter.get_list_items() {
-		buffer.add_marker(
-			Marker::new(MarkerType::ListItem, offset + list_item.offset)
-				.with_text(list_item.text.clone())
-				.with_level(list_item.level),
-		);
-	}
+	let markers = &mut buffer.markers;
+	markers.extend(converter.get_tables().iter().cloned().map(|table| table_marker(table, offset)));
+	markers.extend(converter.get_separators().iter().map(|separator| separator_marker(separator, offset)));
+	markers.extend(converter.get_lists().iter().map(|list| list_marker(list, offset)));
+	markers.extend(converter.get_list_items().iter().cloned().map(|list_item| list_item_marker(list_item, offset)));
 }
 
 fn add_formatting(buffer: &mut DocumentBuffer, converter: &dyn ConverterOutput, offset: usize) {
-	for bold in converter.get_bolds() {
-		buffer.add_marker(Marker::new(MarkerType::Bold, offset + bold.offset).with_length(bold.length));
-	}
-	for italic in converter.get_italics() {
-		buffer.add_marker(Marker::new(MarkerType::Italic, offset + italic.offset).with_length(italic.length));
-	}
-	for underline in converter.get_underlines() {
-		buffer.add_marker(Marker::new(MarkerType::Underline, offset + underline.offset).with_length(underline.length));
-	}
+	let markers = &mut buffer.markers;
+	markers.extend(converter.get_bolds().iter().map(|bold| format_marker(MarkerType::Bold, bold, offset)));
+	markers.extend(converter.get_italics().iter().map(|italic| format_marker(MarkerType::Italic, italic, offset)));
+	markers.extend(
+		converter.get_underlines().iter().map(|underline| format_marker(MarkerType::Underline, underline, offset)),
+	);
 }
 
 /// Transfer all converter markers to a `DocumentBuffer`.
@@ -531,6 +710,37 @@ mod tests {
 		assert!(buffer.markers.iter().all(|marker| marker.mtype != MarkerType::Link));
 	}
 
+	#[test]
+	fn converter_parts_move_the_same_markers_that_add_converter_markers_copies() {
+		let converter = sample_converter();
+		let mut copied = DocumentBuffer::new();
+		add_converter_markers(&mut copied, &converter, 100);
+		let mut parts = ConverterParts {
+			headings: converter.headings,
+			links: converter.links,
+			tables: converter.tables,
+			separators: converter.separators,
+			lists: converter.lists,
+			list_items: converter.list_items,
+			..ConverterParts::default()
+		};
+		let mut moved = DocumentBuffer::new();
+		parts.move_markers_excluding_links_into(&mut moved, 100);
+		assert_eq!(parts.links.len(), 1, "links are left for the caller to resolve");
+		assert!(parts.headings.is_empty() && parts.tables.is_empty());
+		parts.move_markers_into(&mut moved, 100);
+		let summary = |buffer: &DocumentBuffer| {
+			let mut markers: Vec<_> = buffer
+				.markers
+				.iter()
+				.map(|m| (m.position, i32::from(m.mtype), m.text.clone(), m.reference.clone(), m.level, m.length))
+				.collect();
+			markers.sort();
+			markers
+		};
+		assert_eq!(summary(&moved), summary(&copied));
+	}
+
 	#[test]
 	fn add_converter_markers_handles_empty_converter_output() {
 		let converter = MockConverter {
@@ -576,6 +786,25 @@ mod tests {
 		let filter = build_file_filter_string();
 		assert!(filter.contains("Text Files ("));
 	}
+
+	#[test]
+	fn chunk_emitter_reports_only_what_was_appended_since_the_last_chunk() {
+		let mut chunks = Vec::new();
+		let mut on_chunk = |chunk: DocumentChunk| chunks.push(chunk);
+		let mut emitter = ChunkEmitter::new(Some(&mut on_chunk));
+		let mut buffer = DocumentBuffer::new();
+		buffer.add_marker(Marker::new(MarkerType::PageBreak, 0));
+		buffer.append("caf\u{e9}\n");
+		emitter.emit(&buffer);
+		emitter.emit(&buffer);
+		buffer.add_marker(Marker::new(MarkerType::PageBreak, buffer.current_position()));
+		buffer.append("two\n");
+		emitter.emit(&buffer);
+		assert_eq!(chunks.len(), 2, "an unchanged buffer must not produce an empty chunk");
+		assert_eq!((chunks[0].start, chunks[0].text.as_str(), chunks[0].markers.len()), (0, "caf\u{e9}\n", 1));
+		assert_eq!((chunks[1].start, chunks[1].text.as_str()), (5, "two\n"));
+		assert_eq!(chunks[1].markers[0].position, 5);
+	}
 	/// `add_tables_separators_lists` sets the Table marker's `length` to `table.length`
 	/// (display units) and offsets it by the base offset.
 	#[test]
@@ -1,4 +1,8 @@
-use std::collections::{HashMap, HashSet};
+use std::{
+	collections::{HashMap, HashSet},
+	mem,
+	sync::LazyLock,
+};
 
 use anyhow::{Context, Result};
 use libchm::{ChmFile, EntryCategory, EntrySel};
@@ -7,14 +11,17 @@ use scraper::{ElementRef, Html, Selector};
 use crate::{
 	document::{Document, DocumentBuffer, Marker, MarkerType, ParserContext, ParserFlags, TocItem},
 	parser::{
-		Parser, add_converter_markers_excluding_links,
+		Parser,
 		html_to_text::{HtmlSourceMode, HtmlToText},
 		is_external_url,
-		util::path::extract_title_from_path,
+		util::{parallel, path::extract_title_from_path},
 	},
 	util::encoding::convert_to_utf8,
 };
 
+/// Below this many pages, spinning up conversion workers costs more than it saves.
+const PARALLEL_MIN_PAGES: usize = 16;
+
 pub struct ChmParser;
 
 impl Parser for ChmParser {
@@ -35,6 +42,18 @@ impl Parser for ChmParser {
 	}
 
 	fn parse(&self, context: &ParserContext) -> Result<Document> {
+		self.parse_with_workers(context, parallel::default_workers())
+	}
+}
+
+impl ChmParser {
+	/// Parses with up to `max_workers` threads converting pages concurrently. The pages are still decompressed one
+	/// at a time on the calling thread, because libchm needs `&mut` access to read.
+	///
+	/// # Errors
+	///
+	/// Returns an error if the file cannot be opened as a CHM or its table of contents cannot be read.
+	pub fn parse_with_workers(&self, context: &ParserContext, max_workers: usize) -> Result<Document> {
 		let mut chm = ChmFile::open(&context.file_path)
 			.with_context(|| format!("Failed to open CHM file: {}", context.file_path))?;
 		let mut html_files = Vec::new();
@@ -53,56 +72,93 @@ impl Parser for ChmParser {
 		let title = parse_system_file(&mut chm).unwrap_or_else(|| extract_title_from_path(&context.file_path));
 		let mut toc_items = if hhc_file.is_empty() { Vec::new() } else { parse_hhc_file(&mut chm, &hhc_file)? };
 		let ordered_files = build_ordered_file_list(&html_files, &toc_items);
-		let mut buffer = DocumentBuffer::new();
-		let mut id_positions = HashMap::new();
-		let mut file_positions = HashMap::new();
-		for (idx, file_path) in ordered_files.iter().enumerate() {
+		let workers = if ordered_files.len() < PARALLEL_MIN_PAGES { 1 } else { max_workers };
+		// Pages are decompressed only as the workers get to them; see `convert_pages`.
+		let pages = ordered_files.into_iter().enumerate().filter_map(|(idx, path)| {
+			let content = chm.find(&path).and_then(|e| chm.read(&e)).ok().filter(|bytes| !bytes.is_empty())?;
+			Some(ChmPage { number: idx + 1, path, content })
+		});
+		let converted = convert_pages(pages, context.render_tables_inline, workers);
+		calculate_toc_offsets(&mut toc_items, &converted.file_positions, &converted.id_positions);
+		let mut document = Document::new().with_title(title);
+		document.set_buffer(converted.buffer);
+		document.id_positions = converted.id_positions;
+		document.toc_items = toc_items;
+		Ok(document)
+	}
+}
+
+/// A decompressed topic page, in reading order.
+#[derive(Clone)]
+pub struct ChmPage {
+	/// 1-based position in the ordered file list, which names the page's section break.
+	pub number: usize,
+	pub path: String,
+	pub content: Vec<u8>,
+}
+
+pub struct ConvertedPages {
+	pub buffer: DocumentBuffer,
+	pub id_positions: HashMap<String, usize>,
+	pub file_positions: HashMap<String, usize>,
+}
+
+/// Converts `pages` on up to `workers` threads and merges them into one buffer in the order given. Pages that fail
+/// to convert are skipped.
+///
+/// Only a few pages per worker are pulled from `pages` ahead of the merge, and each page's markup is dropped once it
+/// has been converted, so a lazily read file never has all of its topics in memory at once.
+#[must_use]
+pub fn convert_pages(
+	pages: impl IntoIterator<Item = ChmPage>,
+	render_tables_inline: bool,
+	workers: usize,
+) -> ConvertedPages {
+	let mut buffer = DocumentBuffer::new();
+	let mut id_positions = HashMap::new();
+	let mut file_positions = HashMap::new();
+	parallel::map_ordered(
+		pages,
+		workers,
+		workers * parallel::IN_FLIGHT_PER_WORKER,
+		|page| {
+			let utf8_content = convert_to_utf8(&page.content);
+			let mut converter = HtmlToText::with_render_tables_inline(render_tables_inline);
+			let parts = converter.convert(&utf8_content, HtmlSourceMode::NativeHtml).then(|| converter.into_parts());
+			(page.number, page.path, parts)
+		},
+		|_, (number, path, parts)| {
+			let Some(mut parts) = parts else { return };
 			let section_start = buffer.current_position();
-			let Ok(content_bytes) = chm.find(file_path).and_then(|e| chm.read(&e)) else { continue };
-			if content_bytes.is_empty() {
-				continue;
-			}
-			let utf8_content = convert_to_utf8(&content_bytes);
-			let mut converter = HtmlToText::with_render_tables_inline(context.render_tables_inline);
-			if !converter.convert(&utf8_content, HtmlSourceMode::NativeHtml) {
-				continue;
-			}
-			let text = converter.get_text();
-			let section_id_positions = converter.get_id_positions();
-			let normalized_path = normalize_path(file_path);
+			let normalized_path = normalize_path(&path);
 			file_positions.insert(normalized_path.clone(), section_start);
 			// Store file-level position so fragment-less internal links can be resolved.
 			id_positions.insert(normalized_path.clone(), section_start);
-			for (id, relative_pos) in section_id_positions {
+			for (id, relative_pos) in mem::take(&mut parts.id_positions) {
 				let absolute_pos = section_start + relative_pos;
 				id_positions.insert(format!("{normalized_path}#{id}"), absolute_pos);
 			}
-			buffer.append(&text);
+			buffer.append_owned(mem::take(&mut parts.text));
 			buffer.add_marker(
 				Marker::new(MarkerType::SectionBreak, section_start)
-					.with_text(format!("Section {}", idx + 1))
-					.with_reference(file_path.clone()),
+					.with_text(format!("Section {number}"))
+					.with_reference(path.clone()),
 			);
-			add_converter_markers_excluding_links(&mut buffer, &converter, section_start);
-			for link in converter.get_links() {
-				let resolved_href = resolve_chm_href(file_path, &link.reference);
+			parts.move_markers_excluding_links_into(&mut buffer, section_start);
+			for link in parts.links {
+				let resolved_href = resolve_chm_href(&path, &link.reference);
 				buffer.add_marker(
 					Marker::new(MarkerType::Link, section_start + link.offset)
-						.with_text(link.text.clone())
+						.with_text(link.text)
 						.with_reference(resolved_href),
 				);
 			}
 			if !buffer.content.ends_with('\n') {
 				buffer.append("\n");
 			}
-		}
-		calculate_toc_offsets(&mut toc_items, &file_positions, &id_positions);
-		let mut document = Document::new().with_title(title);
-		document.set_buffer(buffer);
-		document.id_positions = id_positions;
-		document.toc_items = toc_items;
-		Ok(document)
-	}
+		},
+	);
+	ConvertedPages { buffer, id_positions, file_positions }
 }
 
 fn parse_system_file(chm: &mut ChmFile) -> Option<String> {
@@ -141,23 +197,31 @@ fn parse_hhc_file(chm: &mut ChmFile, hhc_path: &str) -> Result<Vec<TocItem>> {
 	if content_bytes.is_empty() {
 		return Ok(Vec::new());
 	}
-	let content = convert_to_utf8(&content_bytes);
-	let document = Html::parse_document(&content);
-	let body_selector = Selector::parse("body").unwrap();
-	let Some(body) = document.select(&body_selector).next() else {
-		return Ok(Vec::new());
+	Ok(parse_hhc(&convert_to_utf8(&content_bytes)))
+}
+
+/// Builds the table of contents from the markup of a `.hhc` sitemap. Offsets are left at `usize::MAX` until the pages
+/// have been converted.
+#[must_use]
+pub fn parse_hhc(content: &str) -> Vec<TocItem> {
+	static BODY_SELECTOR: LazyLock<Selector> = LazyLock::new(|| Selector::parse("body").unwrap());
+	let document = Html::parse_document(content);
+	let Some(body) = document.select(&BODY_SELECTOR).next() else {
+		return Vec::new();
 	};
 	let mut toc_items = Vec::new();
 	parse_hhc_node(body, &mut toc_items);
-	Ok(toc_items)
+	toc_items
 }
 
 fn parse_hhc_node(node: ElementRef, items: &mut Vec<TocItem>) {
-	let param_selector = Selector::parse("param").unwrap();
+	static PARAM_SELECTOR: LazyLock<Selector> = LazyLock::new(|| Selector::parse("param").unwrap());
 	let children: Vec<_> = node.children().collect();
-	let mut consumed_indices = HashSet::new();
+	// A sibling UL is only ever claimed by the LI just before it, with no other LI in between, so the most recent
+	// claim is the only one still ahead of the loop.
+	let mut consumed_index = None;
 	for (index, child) in children.iter().enumerate() {
-		if consumed_indices.contains(&index) {
+		if consumed_index == Some(index) {
 			continue;
 		}
 		let Some(child_element) = child.value().as_element() else {
@@ -178,7 +242,7 @@ fn parse_hhc_node(node: ElementRef, items: &mut Vec<TocItem>) {
 						&& obj_element.name() == "object"
 						&& let Some(object_ref) = ElementRef::wrap(obj_child)
 					{
-						for param in object_ref.select(&param_selector) {
+						for param in object_ref.select(&PARAM_SELECTOR) {
 							let param_name = param.value().attr("name").unwrap_or("").to_lowercase();
 							let param_value = param.value().attr("value").unwrap_or("");
 							match param_name.as_str() {
@@ -219,7 +283,7 @@ fn parse_hhc_node(node: ElementRef, items: &mut Vec<TocItem>) {
 							&& let Some(sibling_ref) = ElementRef::wrap(sibling_node)
 						{
 							parse_hhc_node(sibling_ref, &mut item.children);
-							consumed_indices.insert(ul_index); // Mark as consumed
+							consumed_index = Some(ul_index);
 						}
 					}
 					items.push(item);
@@ -342,3 +406,55 @@ fn calculate_offset_from_reference(
 	}
 	file_positions.get(&normalized_path).copied().unwrap_or(usize::MAX)
 }
+
+#[cfg(test)]
+mod tests {
+	use super::*;
+
+	#[test]
+	fn parse_hhc_nests_child_and_sibling_lists() {
+		let hhc = r#"<html><body><ul>
+			<li><object type="text/sitemap"><param name="Name" value="Intro"><param name="Local" value="intro.htm"></object>
+				<ul><li><object type="text/sitemap"><param name="Name" value="Setup"><param name="Local" value="setup.htm"></object></ul>
+			<li><object type="text/sitemap"><param name="Name" value="API"><param name="Local" value="api.htm"></object></li>
+			<ul><li><object type="text/sitemap"><param name="Name" value="Calls"><param name="Local" value="calls.htm#top"></object></ul>
+			<li><object type="text/sitemap"><param name="Name" value="Index"><param name="Local" value="index.htm"></object>
+		</ul></body></html>"#;
+		let toc = parse_hhc(hhc);
+		let names: Vec<_> = toc.iter().map(|item| item.name.as_str()).collect();
+		assert_eq!(names, ["Intro", "API", "Index"]);
+		assert_eq!(toc[0].children[0].name, "Setup");
+		assert_eq!(toc[1].children[0].reference, "calls.htm#top");
+		assert!(toc[2].children.is_empty());
+	}
+
+	#[test]
+	fn convert_pages_matches_sequential_conversion() {
+		let pages: Vec<ChmPage> = (0..40)
+			.map(|i| ChmPage {
+				number: i + 1,
+				path: format!("/topics/t{i}.htm"),
+				content: format!(
+					"<html><body><h1 id=\"h{i}\">Topic {i}</h1><p><a href=\"t{}.htm\">next</a></p></body></html>",
+					i + 1
+				)
+				.into_bytes(),
+			})
+			.collect();
+		let sequential = convert_pages(pages.clone(), false, 1);
+		let parallel = convert_pages(pages, false, 4);
+		assert_eq!(parallel.buffer.content, sequential.buffer.content);
+		let summary = |converted: &ConvertedPages| {
+			converted
+				.buffer
+				.markers
+				.iter()
+				.map(|m| (m.position, i32::from(m.mtype), m.text.clone(), m.reference.clone()))
+				.collect::<Vec<_>>()
+		};
+		assert_eq!(summary(&parallel), summary(&sequential));
+		assert_eq!(parallel.id_positions, sequential.id_positions);
+		assert_eq!(parallel.file_positions, sequential.file_positions);
+		assert!(sequential.id_positions["/topics/t3.htm#h3"] >= sequential.file_positions["/topics/t3.htm"]);
+	}
+}
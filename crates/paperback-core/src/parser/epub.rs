@@ -2,6 +2,7 @@ use std::{
 	collections::HashMap,
 	fs::File,
 	io::{BufReader, Read, Seek},
+	mem,
 	path::{Component, Path, PathBuf},
 };
 
@@ -10,73 +11,23 @@ use roxmltree::{Document as XmlDocument, Node, NodeType, ParsingOptions};
 use zip::ZipArchive;
 
 use crate::{
-	document::{Document, DocumentBuffer, Marker, MarkerType, ParserContext, ParserFlags, TocItem},
+	document::{Document, DocumentBuffer, DocumentChunk, Marker, MarkerType, ParserContext, ParserFlags, TocItem},
 	parser::{
-		ConverterOutput, Parser, add_converter_markers_excluding_links,
+		ChunkEmitter, ConverterParts, Parser,
 		html_to_text::{HtmlSourceMode, HtmlToText},
 		is_external_url,
-		util::path::extract_title_from_path,
+		util::{parallel, path::extract_title_from_path},
 		xml_to_text::XmlToText,
 	},
 	t,
-	types::{FormatInfo, HeadingInfo, ImageInfo, LinkInfo, ListInfo, ListItemInfo, SeparatorInfo, TableInfo},
 	util::{
 		text::{collapse_whitespace, trim_string, url_decode},
 		zip::read_zip_entry_by_name,
 	},
 };
 
-struct SectionContent {
-	text: String,
-	headings: Vec<HeadingInfo>,
-	links: Vec<LinkInfo>,
-	images: Vec<ImageInfo>,
-	figures: Vec<ImageInfo>,
-	tables: Vec<TableInfo>,
-	separators: Vec<SeparatorInfo>,
-	lists: Vec<ListInfo>,
-	list_items: Vec<ListItemInfo>,
-	bolds: Vec<FormatInfo>,
-	italics: Vec<FormatInfo>,
-	underlines: Vec<FormatInfo>,
-	id_positions: HashMap<String, usize>,
-}
-
-impl ConverterOutput for SectionContent {
-	fn get_headings(&self) -> &[HeadingInfo] {
-		&self.headings
-	}
-	fn get_links(&self) -> &[LinkInfo] {
-		&self.links
-	}
-	fn get_images(&self) -> &[ImageInfo] {
-		&self.images
-	}
-	fn get_figures(&self) -> &[ImageInfo] {
-		&self.figures
-	}
-	fn get_tables(&self) -> &[TableInfo] {
-		&self.tables
-	}
-	fn get_separators(&self) -> &[SeparatorInfo] {
-		&self.separators
-	}
-	fn get_lists(&self) -> &[ListInfo] {
-		&self.lists
-	}
-	fn get_list_items(&self) -> &[ListItemInfo] {
-		&self.list_items
-	}
-	fn get_bolds(&self) -> &[FormatInfo] {
-		&self.bolds
-	}
-	fn get_italics(&self) -> &[FormatInfo] {
-		&self.italics
-	}
-	fn get_underlines(&self) -> &[FormatInfo] {
-		&self.underlines
-	}
-}
+/// Below this many spine items, spinning up conversion workers costs more than it saves.
+const PARALLEL_MIN_SECTIONS: usize = 4;
 
 struct SectionMeta {
 	path: String,
@@ -119,6 +70,15 @@ impl Parser for EpubParser {
 	}
 
 	fn parse(&self, context: &ParserContext) -> Result<Document> {
+		self.parse_streaming(context, None)
+	}
+
+	/// Emits one chunk per spine item as it is converted; page-list markers arrive only with the document.
+	fn parse_streaming(
+		&self,
+		context: &ParserContext,
+		on_chunk: Option<&mut dyn FnMut(DocumentChunk)>,
+	) -> Result<Document> {
 		let file = File::open(&context.file_path)
 			.with_context(|| format!("Failed to open EPUB file '{}'", context.file_path))?;
 		let mut archive = ZipArchive::new(BufReader::new(file))
@@ -137,7 +97,9 @@ impl Parser for EpubParser {
 			// TRANSLATORS: Error shown when an EPUB's OPF document has no <package> element
 			.ok_or_else(|| anyhow::anyhow!(t("OPF package element missing")))?;
 		let (manifest, spine, nav_path, ncx_path, metadata) = parse_package(package_node, &opf_dir);
-		let mut conversion = convert_spine_items(&mut archive, &manifest, &spine, context.render_tables_inline);
+		let mut emitter = ChunkEmitter::new(on_chunk);
+		let mut conversion =
+			convert_spine_items(&mut archive, &manifest, &spine, context.render_tables_inline, &mut emitter);
 		if conversion.sections.is_empty() {
 			let reason = if conversion.conversion_errors.is_empty() {
 				// TRANSLATORS: Reason given when an EPUB has no spine items that could be read
@@ -183,66 +145,86 @@ impl Parser for EpubParser {
 	}
 }
 
+/// A spine item's archive path and raw markup, or why it could not be read.
+type SpineSource<'a> = Result<(&'a str, String), String>;
+
+/// Reads the spine items from the archive, converts them on a worker pool, and stitches the sections back together
+/// in spine order. Offsets, `id_positions` and markers come out exactly as a sequential conversion would leave them.
+///
+/// Items are read only a few at a time ahead of the stitching, and each item's markup is dropped once it has been
+/// converted, so a large book's sources are never all held in memory next to its text.
 fn convert_spine_items<R: Read + Seek>(
 	archive: &mut ZipArchive<R>,
 	manifest: &HashMap<String, ManifestItem>,
 	spine: &[String],
 	render_tables_inline: bool,
+	emitter: &mut ChunkEmitter<'_>,
 ) -> SpineConversionResult {
+	// ZipArchive needs `&mut` to read, so the entries are pulled out on this thread as conversion fans out.
+	let sources = spine.iter().map(|idref| -> SpineSource<'_> {
+		let item = manifest.get(idref).ok_or_else(|| format!("missing manifest item for {idref}"))?;
+		read_zip_entry_by_name(archive, &item.path)
+			.map(|data| (item.path.as_str(), data))
+			.map_err(|err| format!("{} ({err})", item.path))
+	});
 	let mut buffer = DocumentBuffer::new();
 	let mut id_positions = HashMap::new();
 	let mut sections = Vec::new();
 	let mut conversion_errors = Vec::new();
-	for (idx, idref) in spine.iter().enumerate() {
-		let Some(item) = manifest.get(idref) else {
-			conversion_errors.push(format!("missing manifest item for {idref}"));
-			continue;
-		};
-		let section_data = match read_zip_entry_by_name(archive, &item.path) {
-			Ok(v) => v,
-			Err(err) => {
-				conversion_errors.push(format!("{} ({err})", item.path));
-				continue;
-			}
-		};
-		let section_start = buffer.current_position();
-		let section_label = format!("Section {}", idx + 1);
-		buffer.add_marker(
-			Marker::new(MarkerType::SectionBreak, section_start)
-				.with_text(section_label)
-				.with_reference(item.path.clone()),
-		);
-		match convert_section(&section_data, render_tables_inline) {
-			Ok(section) => {
-				for (id, relative) in &section.id_positions {
-					let absolute = section_start + relative;
-					// Keep the first occurrence for bare ids to avoid later sections overwriting earlier ones.
-					id_positions.entry(id.clone()).or_insert(absolute);
-					id_positions.insert(format!("{}#{id}", item.path), absolute);
+	let workers = if spine.len() < PARALLEL_MIN_SECTIONS { 1 } else { parallel::default_workers() };
+	parallel::map_ordered(
+		sources,
+		workers,
+		workers * parallel::IN_FLIGHT_PER_WORKER,
+		|source| source.map(|(path, data)| (path, convert_section(&data, render_tables_inline))),
+		|idx, source| {
+			let (path, converted) = match source {
+				Ok(source) => source,
+				Err(err) => {
+					conversion_errors.push(err);
+					return;
 				}
-				add_converter_markers_excluding_links(&mut buffer, &section, section_start);
-				for link in &section.links {
-					let resolved = resolve_href(&item.path, &link.reference);
-					buffer.add_marker(
-						Marker::new(MarkerType::Link, section_start + link.offset)
-							.with_text(link.text.clone())
-							.with_reference(resolved),
-					);
-				}
-				if !section.text.is_empty() {
-					buffer.append(&section.text);
-					if !buffer.content.ends_with('\n') {
-						buffer.append("\n");
+			};
+			let section_start = buffer.current_position();
+			let section_label = format!("Section {}", idx + 1);
+			buffer.add_marker(
+				Marker::new(MarkerType::SectionBreak, section_start)
+					.with_text(section_label)
+					.with_reference(path.to_string()),
+			);
+			match converted {
+				Ok(mut section) => {
+					for (id, relative) in mem::take(&mut section.id_positions) {
+						let absolute = section_start + relative;
+						id_positions.insert(format!("{path}#{id}"), absolute);
+						// Keep the first occurrence for bare ids to avoid later sections overwriting earlier ones.
+						id_positions.entry(id).or_insert(absolute);
+					}
+					section.move_markers_excluding_links_into(&mut buffer, section_start);
+					for link in section.links {
+						let resolved = resolve_href(path, &link.reference);
+						buffer.add_marker(
+							Marker::new(MarkerType::Link, section_start + link.offset)
+								.with_text(link.text)
+								.with_reference(resolved),
+						);
+					}
+					if !section.text.is_empty() {
+						buffer.append_owned(section.text);
+						if !buffer.content.ends_with('\n') {
+							buffer.append("\n");
+						}
 					}
+					let section_end = buffer.current_position();
+					sections.push(SectionMeta { path: path.to_string(), start: section_start, end: section_end });
+					emitter.emit(&buffer);
+				}
+				Err(err) => {
+					conversion_errors.push(format!("{path} ({err})"));
 				}
-				let section_end = buffer.current_position();
-				sections.push(SectionMeta { path: item.path.clone(), start: section_start, end: section_end });
-			}
-			Err(err) => {
-				conversion_errors.push(format!("{} ({err})", item.path));
 			}
-		}
-	}
+		},
+	);
 	SpineConversionResult { buffer, id_positions, sections, conversion_errors }
 }
 
@@ -355,42 +337,14 @@ fn parse_package(package: Node<'_, '_>, opf_dir: &Path) -> PackageParts {
 	(manifest, spine, nav_path, ncx_path, PackageMetadata { title, author })
 }
 
-fn convert_section(content: &str, render_tables_inline: bool) -> Result<SectionContent> {
+fn convert_section(content: &str, render_tables_inline: bool) -> Result<ConverterParts> {
 	let mut xml_converter = XmlToText::with_render_tables_inline(render_tables_inline);
 	if xml_converter.convert(content) {
-		return Ok(SectionContent {
-			text: xml_converter.get_text(),
-			headings: xml_converter.get_headings().to_vec(),
-			links: xml_converter.get_links().to_vec(),
-			images: xml_converter.get_images().to_vec(),
-			figures: xml_converter.get_figures().to_vec(),
-			tables: xml_converter.get_tables().to_vec(),
-			separators: xml_converter.get_separators().to_vec(),
-			lists: xml_converter.get_lists().to_vec(),
-			list_items: xml_converter.get_list_items().to_vec(),
-			bolds: xml_converter.get_bolds().to_vec(),
-			italics: xml_converter.get_italics().to_vec(),
-			underlines: xml_converter.get_underlines().to_vec(),
-			id_positions: xml_converter.get_id_positions().clone(),
-		});
+		return Ok(xml_converter.into_parts());
 	}
 	let mut html_converter = HtmlToText::with_render_tables_inline(render_tables_inline);
 	if html_converter.convert(content, HtmlSourceMode::NativeHtml) {
-		return Ok(SectionContent {
-			text: html_converter.get_text(),
-			headings: html_converter.get_headings().to_vec(),
-			links: html_converter.get_links().to_vec(),
-			images: html_converter.get_images().to_vec(),
-			figures: html_converter.get_figures().to_vec(),
-			tables: html_converter.get_tables().to_vec(),
-			separators: html_converter.get_separators().to_vec(),
-			lists: html_converter.get_lists().to_vec(),
-			list_items: html_converter.get_list_items().to_vec(),
-			bolds: html_converter.get_bolds().to_vec(),
-			italics: html_converter.get_italics().to_vec(),
-			underlines: html_converter.get_underlines().to_vec(),
-			id_positions: html_converter.get_id_positions().clone(),
-		});
+		return Ok(html_converter.into_parts());
 	}
 	// TRANSLATORS: Error shown when an EPUB spine item's content type cannot be converted
 	anyhow::bail!(t("unsupported content"))
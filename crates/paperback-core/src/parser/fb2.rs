@@ -1,4 +1,4 @@
-use std::{collections::HashMap, fs};
+use std::{fs, mem};
 
 use anyhow::{Context, Result};
 use roxmltree::{Document as XmlDocument, Node, NodeType};
@@ -6,7 +6,7 @@ use roxmltree::{Document as XmlDocument, Node, NodeType};
 use crate::{
 	document::{Document, DocumentBuffer, Marker, MarkerType, ParserContext, ParserFlags},
 	parser::{
-		Parser, add_converter_markers,
+		Parser,
 		util::xml::{collect_element_text, find_child_element},
 		xml_to_text::XmlToText,
 	},
@@ -46,16 +46,18 @@ impl Parser for Fb2Parser {
 			// TRANSLATORS: Error shown when an FB2 (FictionBook) file's XML fails to convert to plain text
 			anyhow::bail!(t("Failed to convert FB2 XML to text"));
 		}
-		let mut buffer = DocumentBuffer::new();
-		buffer.append(&converter.get_text());
-		add_converter_markers(&mut buffer, &converter, 0);
-		for offset in converter.get_section_offsets() {
-			buffer.add_marker(Marker::new(MarkerType::SectionBreak, *offset));
-		}
-		let id_positions: HashMap<String, usize> = converter.get_id_positions().clone();
+		let section_breaks: Vec<Marker> = converter
+			.get_section_offsets()
+			.iter()
+			.map(|&offset| Marker::new(MarkerType::SectionBreak, offset))
+			.collect();
+		let mut parts = converter.into_parts();
+		let mut buffer = DocumentBuffer::with_content(mem::take(&mut parts.text));
+		parts.move_markers_into(&mut buffer, 0);
+		buffer.markers.extend(section_breaks);
 		let mut document = Document::new().with_title(title).with_author(author);
 		document.set_buffer(buffer);
-		document.id_positions = id_positions;
+		document.id_positions = parts.id_positions;
 		Ok(document)
 	}
 }
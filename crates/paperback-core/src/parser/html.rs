@@ -1,11 +1,11 @@
-use std::fs;
+use std::{fs, mem};
 
 use anyhow::{Context, Result};
 
 use crate::{
 	document::{Document, DocumentBuffer, ParserContext, ParserFlags},
 	parser::{
-		Parser, add_converter_markers,
+		Parser,
 		html_to_text::{HtmlSourceMode, HtmlToText},
 		util::{path::extract_title_from_path, toc::build_toc_from_headings},
 	},
@@ -47,15 +47,14 @@ impl Parser for HtmlParser {
 		} else {
 			extracted_title.to_string()
 		};
-		let text = converter.get_text();
-		let mut buffer = DocumentBuffer::with_content(text);
-		let id_positions = converter.get_id_positions().clone();
-		add_converter_markers(&mut buffer, &converter, 0);
 		let toc_items = build_toc_from_headings(converter.get_headings());
+		let mut parts = converter.into_parts();
+		let mut buffer = DocumentBuffer::with_content(mem::take(&mut parts.text));
+		parts.move_markers_into(&mut buffer, 0);
 		let mut doc = Document::new().with_title(title);
 		doc.set_buffer(buffer);
 		doc.toc_items = toc_items;
-		doc.id_positions = id_positions;
+		doc.id_positions = parts.id_positions;
 		Ok(doc)
 	}
 }
@@ -1,4 +1,4 @@
-use std::{collections::HashMap, fmt::Write, mem};
+use std::{collections::HashMap, fmt::Write};
 
 use bitflags::bitflags;
 use ego_tree::NodeRef;
@@ -6,8 +6,9 @@ use scraper::{ElementRef, Html, Node, node};
 
 use crate::{
 	parser::{
-		ConverterOutput,
+		ConverterOutput, ConverterParts,
 		table_text::{push_finalized_line, table_render_bundle},
+		util::pending_line::PendingLine,
 	},
 	t,
 	types::{FormatInfo, HeadingInfo, ImageInfo, LinkInfo, ListInfo, ListItemInfo, SeparatorInfo, TableInfo},
@@ -45,7 +46,7 @@ impl Default for ListStyle {
 
 pub struct HtmlToText {
 	lines: Vec<String>,
-	current_line: String,
+	current_line: PendingLine,
 	id_positions: HashMap<String, usize>,
 	headings: Vec<HeadingInfo>,
 	links: Vec<LinkInfo>,
@@ -85,7 +86,7 @@ impl HtmlToText {
 	pub fn new() -> Self {
 		Self {
 			lines: Vec::new(),
-			current_line: String::new(),
+			current_line: PendingLine::default(),
 			id_positions: HashMap::new(),
 			headings: Vec::new(),
 			links: Vec::new(),
@@ -139,6 +140,26 @@ impl HtmlToText {
 		self.lines.join("\n")
 	}
 
+	/// Consumes the converter, moving its text and metadata out instead of copying them.
+	#[must_use]
+	pub fn into_parts(self) -> ConverterParts {
+		ConverterParts {
+			text: self.lines.join("\n"),
+			headings: self.headings,
+			links: self.links,
+			images: self.images,
+			figures: self.figures,
+			tables: self.tables,
+			separators: self.separators,
+			lists: self.lists,
+			list_items: self.list_items,
+			bolds: self.bolds,
+			italics: self.italics,
+			underlines: self.underlines,
+			id_positions: self.id_positions,
+		}
+	}
+
 	#[must_use]
 	pub fn get_title(&self) -> &str {
 		&self.title
@@ -508,8 +529,8 @@ impl HtmlToText {
 			}
 		}
 		if tag_name == "pre" {
-			let has_preserved_trailing_whitespace =
-				self.flags.contains(ProcessingFlags::PRESERVE_WHITESPACE) && self.current_line.trim().is_empty();
+			let has_preserved_trailing_whitespace = self.flags.contains(ProcessingFlags::PRESERVE_WHITESPACE)
+				&& self.current_line.as_str().trim().is_empty();
 			if has_preserved_trailing_whitespace {
 				self.current_line.clear();
 			} else {
@@ -621,20 +642,18 @@ impl HtmlToText {
 	}
 
 	fn finalize_current_line(&mut self) {
-		let line = mem::take(&mut self.current_line);
+		let line = self.current_line.take();
 		self.add_line(line);
 	}
 
 	fn current_display_len(&self) -> usize {
 		if self.flags.contains(ProcessingFlags::PRESERVE_WHITESPACE) {
-			return display_len(&self.current_line);
+			return self.current_line.display_len();
 		}
-		let collapsed = collapse_whitespace(&self.current_line);
-		// Use trim_start() not trim(): trailing whitespace before an inline element (e.g. a
-		// space before <a>) IS preserved in the output line, so including it in the position
-		// count keeps link/anchor offsets correctly aligned with the final text.
-		let trimmed = collapsed.trim_start();
-		display_len(trimmed)
+		// Leading whitespace is dropped, but a trailing run counts as one space: whitespace before
+		// an inline element (e.g. a space before <a>) is preserved in the output line, so counting
+		// it keeps link/anchor offsets aligned with the final text.
+		self.current_line.collapsed_display_len()
 	}
 
 	fn get_current_text_position(&self) -> usize {
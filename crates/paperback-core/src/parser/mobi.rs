@@ -1,7 +1,6 @@
 use std::{
 	collections::{BTreeSet, HashMap},
-	fs::File,
-	io::Read,
+	fs, mem,
 	sync::LazyLock,
 };
 
@@ -11,7 +10,7 @@ use encoding_rs::WINDOWS_1252;
 use crate::{
 	document::{Document, DocumentBuffer, ParserContext, ParserFlags, TocItem},
 	parser::{
-		Parser, add_converter_markers,
+		Parser,
 		html_to_text::{HtmlSourceMode, HtmlToText},
 		util::{path::extract_title_from_path, toc::build_toc_from_headings},
 	},
@@ -34,9 +33,7 @@ impl Parser for MobiParser {
 	}
 
 	fn parse(&self, context: &ParserContext) -> Result<Document> {
-		let mut file = File::open(&context.file_path)?;
-		let mut data = Vec::new();
-		file.read_to_end(&mut data)?;
+		let data = fs::read(&context.file_path)?;
 		if data.len() < 78 {
 			// TRANSLATORS: Error shown when a MOBI file is too small to contain a valid header
 			anyhow::bail!(t("File too short"));
@@ -353,12 +350,12 @@ impl Parser for MobiParser {
 		}
 		let mut document = Document::new().with_author(document_author);
 		document.title = document_title;
-		let mut buffer = DocumentBuffer::new();
-		buffer.append(&html_converter.get_text());
-		add_converter_markers(&mut buffer, &html_converter, 0);
-		document.set_buffer(buffer);
-		document.id_positions = html_converter.get_id_positions().clone();
 		let mut toc_items = build_toc_from_headings(html_converter.get_headings());
+		let mut parts = html_converter.into_parts();
+		let mut buffer = DocumentBuffer::with_content(mem::take(&mut parts.text));
+		parts.move_markers_into(&mut buffer, 0);
+		document.set_buffer(buffer);
+		document.id_positions = parts.id_positions;
 		if toc_items.is_empty() && !ncx_toc.is_empty() {
 			resolve_ncx_offsets(&mut ncx_toc, &document.id_positions);
 			toc_items = ncx_toc;
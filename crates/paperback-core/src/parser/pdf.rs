@@ -1,15 +1,21 @@
 use std::{
-	collections::{HashMap, HashSet},
+	collections::{BTreeMap, HashMap, HashSet},
 	mem,
+	num::NonZeroUsize,
+	sync::{
+		atomic::{AtomicBool, AtomicI32, Ordering},
+		mpsc,
+	},
+	thread,
 };
 
 use anyhow::{Result, anyhow};
 use pdfium::{PdfiumDocument, PdfiumError, PdfiumTextPage, lib};
 
 use crate::{
-	document::{Document, DocumentBuffer, Marker, MarkerType, ParserContext, ParserFlags, TocItem},
+	document::{Document, DocumentBuffer, DocumentChunk, Marker, MarkerType, ParserContext, ParserFlags, TocItem},
 	parser::{
-		PASSWORD_REQUIRED_ERROR_PREFIX, Parser,
+		ChunkEmitter, PASSWORD_REQUIRED_ERROR_PREFIX, Parser,
 		table_text::{display_lines_and_length, html_table_to_display},
 		util::{bidi, path::extract_title_from_path},
 	},
@@ -23,6 +29,9 @@ use crate::{
 /// (no MCIDs, or wrapped only in `/Artifact` marks); below this threshold the
 /// structure tree is treated as unreliable and plain extraction is used instead.
 const MIN_MCID_COVERAGE: f64 = 0.5;
+/// Below this many pages, spinning up extraction workers (each reopening the document) costs more than it saves.
+const PARALLEL_MIN_PAGES: i32 = 32;
+const MAX_EXTRACTION_WORKERS: usize = 8;
 
 pub struct PdfParser;
 
@@ -40,263 +49,71 @@ impl Parser for PdfParser {
 	}
 
 	fn parse(&self, context: &ParserContext) -> Result<Document> {
+		self.parse_streaming(context, None)
+	}
+
+	/// Emits one chunk per page, so the first page is readable while the rest of the document is extracted.
+	fn parse_streaming(
+		&self,
+		context: &ParserContext,
+		on_chunk: Option<&mut dyn FnMut(DocumentChunk)>,
+	) -> Result<Document> {
+		self.parse_with_workers(context, default_extraction_workers(), on_chunk)
+	}
+}
+
+impl PdfParser {
+	/// Parses with up to `max_workers` threads extracting pages concurrently.
+	///
+	/// Each worker opens its own document handle and claims pages from a shared counter; the finished page
+	/// fragments are stitched back together in page order, so the result (and the chunks reported to `on_chunk`)
+	/// match a single-threaded parse. Documents shorter than [`PARALLEL_MIN_PAGES`] are always parsed on the
+	/// calling thread. pdfium serializes its own calls, so the speedup comes from the Rust-side text assembly
+	/// running alongside them.
+	///
+	/// # Errors
+	///
+	/// Returns an error if the PDF cannot be opened, including when a password is required.
+	pub fn parse_with_workers(
+		&self,
+		context: &ParserContext,
+		max_workers: usize,
+		on_chunk: Option<&mut dyn FnMut(DocumentChunk)>,
+	) -> Result<Document> {
+		let mut emitter = ChunkEmitter::new(on_chunk);
 		let render_tables_inline = context.render_tables_inline;
 		let document =
 			PdfiumDocument::new_from_path(&context.file_path, context.password.as_deref()).map_err(map_load_error)?;
-		let mut buffer = DocumentBuffer::new();
-		let mut page_offsets = Vec::new();
-		let mut id_positions = HashMap::new();
-		let mut page_lines_info: Vec<Vec<(usize, String)>> = Vec::new();
 		let page_count = document.page_count();
-		let mut any_tags_processed = false;
-		let mut flat_toc_items = Vec::new();
-		let mut has_any_text = false;
-		let mut has_any_images = false;
-		let mut detected_heading_positions: Vec<(usize, String)> = Vec::new();
-		for page_index in 0..page_count {
-			let marker_position = buffer.current_position();
-			page_offsets.push(marker_position);
-			id_positions.insert(format!("page_{page_index}"), marker_position);
-			buffer.add_marker(
-				Marker::new(MarkerType::PageBreak, marker_position).with_text(format!("Page {}", page_index + 1)),
-			);
-			let Ok(page) = document.page(page_index) else {
-				page_lines_info.push(Vec::new());
-				continue;
-			};
-			let Ok(text_page) = page.text() else {
-				page_lines_info.push(Vec::new());
-				continue;
-			};
-			let page_start_offset = buffer.current_position();
-			let mut page_display_text = String::new();
-			let mut current_lines_info = Vec::new();
-			let mut tags_processed = false;
-			if let Some(struct_tree) = page.struct_tree() {
-				let child_count = struct_tree.count_children();
-				if child_count > 0 {
-					let mut mcid_to_text: HashMap<i32, String> = HashMap::new();
-					let mut real_char_count: usize = 0;
-					let mut mcid_char_count: usize = 0;
-					if let Ok(char_count) = text_page.char_count() {
-						let mut current_mcid = -1;
-						// Chars of the current marked-content run with their pdfium index, so RTL
-						// runs can be reordered visual→logical per run.
-						let mut current_chars: Vec<(char, i32)> = Vec::new();
-						for i in 0..char_count {
-							let unicode = text_page.get_unicode(i);
-							if let Some(ch) = char::from_u32(unicode) {
-								if (ch.is_control() && !matches!(ch, '\n' | '\r' | '\t')) || ch == '\u{00AD}' {
-									continue;
-								}
-								let is_generated = text_page.is_generated(i).unwrap_or(false);
-								let mut char_mcid = -1;
-								if !is_generated && let Ok(obj) = text_page.get_text_object(i) {
-									char_mcid = obj.get_marked_content_id();
-								}
-								if !is_generated && !ch.is_whitespace() {
-									real_char_count += 1;
-									if char_mcid >= 0 {
-										mcid_char_count += 1;
-									}
-								}
-								if char_mcid >= 0 && char_mcid != current_mcid {
-									if current_mcid >= 0 && !current_chars.is_empty() {
-										mcid_to_text
-											.entry(current_mcid)
-											.or_default()
-											.push_str(&reorder_run(&text_page, &current_chars));
-									}
-									current_chars.clear();
-									current_mcid = char_mcid;
-								}
-								current_chars.push((ch, i));
-							}
-						}
-						if current_mcid >= 0 && !current_chars.is_empty() {
-							mcid_to_text
-								.entry(current_mcid)
-								.or_default()
-								.push_str(&reorder_run(&text_page, &current_chars));
-						}
-					}
-					let coverage =
-						if real_char_count > 0 { mcid_char_count as f64 / real_char_count as f64 } else { 1.0 };
-					if coverage >= MIN_MCID_COVERAGE {
-						let mut current_block = String::new();
-						for i in 0..child_count {
-							if let Ok(child) = struct_tree.child(i) {
-								process_struct_element(
-									&child,
-									&mcid_to_text,
-									&mut buffer,
-									&mut page_display_text,
-									&mut current_block,
-									&mut current_lines_info,
-									&mut flat_toc_items,
-									render_tables_inline,
-								);
-							}
-						}
-						flush_block(&mut current_block, &mut buffer, &mut page_display_text, &mut current_lines_info);
-						tags_processed = true;
-						any_tags_processed = true;
-					}
-				}
-			}
-			if tags_processed {
-				has_any_text = true;
-			} else {
-				let line_infos = extract_text_lines(&text_page);
-				let body_size = median_line_font_size(&line_infos);
-				let paragraphs = join_paragraphs(&line_infos, body_size);
-				if !paragraphs.is_empty() {
-					has_any_text = true;
-				}
-				for (text, is_heading) in &paragraphs {
-					let current_offset = buffer.current_position();
-					if *is_heading {
-						detected_heading_positions.push((current_offset, text.clone()));
-					}
-					current_lines_info.push((current_offset, text.clone()));
-					buffer.append(text);
-					buffer.append("\n");
-					page_display_text.push_str(text);
-					page_display_text.push('\n');
-				}
-			}
-			// Check for image objects on this page
-			if !has_any_images {
-				let obj_count = lib().FPDFPage_CountObjects(&page);
-				for i in 0..obj_count {
-					if let Ok(obj) = lib().FPDFPage_GetObject(&page, i)
-						&& lib().FPDFPageObj_GetType(&obj) == pdfium::pdfium_constants::FPDF_PAGEOBJ_IMAGE
-					{
-						has_any_images = true;
-						break;
-					}
-				}
-			}
-			// Load implicit web links
-			if let Ok(links) = text_page.load_web_links() {
-				let count = lib().FPDFLink_CountWebLinks(&links);
-				let mut last_search_pos = 0;
-				for i in 0..count {
-					let mut start = 0;
-					let mut char_count = 0;
-					if lib().FPDFLink_GetTextRange(&links, i, &mut start, &mut char_count).is_ok() {
-						let link_text = sanitize_pdf_text(&text_page.extract(start, char_count));
-						let trimmed_link = trim_string(&collapse_whitespace(&link_text));
-						if trimmed_link.is_empty() {
-							continue;
-						}
-						let mut url_buffer = vec![0u16; 2048];
-						let len = lib().FPDFLink_GetURL(&links, i, &mut url_buffer[0], 2048);
-						if len > 0 {
-							let url = String::from_utf16_lossy(&url_buffer[..(len as usize - 1)]);
-							if let Some(pos) = page_display_text[last_search_pos..].find(&trimmed_link) {
-								let text_before = &page_display_text[last_search_pos..last_search_pos + pos];
-								let marker_pos = page_start_offset
-									+ display_len(&page_display_text[..last_search_pos])
-									+ display_len(text_before);
-								let link_len = display_len(&trimmed_link);
-								buffer.add_marker(
-									Marker::new(MarkerType::Link, marker_pos)
-										.with_text(trimmed_link.clone())
-										.with_reference(url)
-										.with_length(link_len),
-								);
-								last_search_pos += pos + trimmed_link.len();
-							}
-						}
-					}
-				}
-			}
-			// Load explicit annotations (internal and external links)
-			let annot_count = lib().FPDFPage_GetAnnotCount(&page);
-			let mut last_search_pos = 0;
-			for i in 0..annot_count {
-				let annot_result = lib().FPDFPage_GetAnnot(&page, i);
-				if let Ok(annot) = annot_result
-					&& lib().FPDFAnnot_GetSubtype(&annot) == pdfium::pdfium_constants::FPDF_ANNOT_LINK
-				{
-					let mut rect = pdfium::pdfium_types::FS_RECTF { left: 0.0, top: 0.0, right: 0.0, bottom: 0.0 };
-					if lib().FPDFAnnot_GetRect(&annot, &mut rect).is_ok() {
-						let mut text_buffer = vec![0u16; 2048];
-						let len = lib().FPDFText_GetBoundedText(
-							&text_page,
-							f64::from(rect.left),
-							f64::from(rect.top),
-							f64::from(rect.right),
-							f64::from(rect.bottom),
-							&mut text_buffer[0],
-							2048,
-						);
-						if len > 0 {
-							let text = sanitize_pdf_text(&String::from_utf16_lossy(&text_buffer[..(len as usize - 1)]));
-							let trimmed_link = trim_string(&collapse_whitespace(&text));
-							if trimmed_link.is_empty() {
-								continue;
-							}
-							let mut url = String::new();
-							let link_result = lib().FPDFAnnot_GetLink(&annot);
-							if let Ok(link) = link_result {
-								let action_result = lib().FPDFLink_GetAction(&link);
-								if let Ok(action) = action_result {
-									let action_type = lib().FPDFAction_GetType(&action);
-									// PDFACTION_URI is 3
-									if action_type == 3 {
-										let mut uri_buffer = vec![0u8; 2048];
-										let uri_len = lib().FPDFAction_GetURIPath(
-											&document,
-											&action,
-											Some(&mut uri_buffer),
-											2048,
-										);
-										if uri_len > 0 {
-											url = String::from_utf8_lossy(&uri_buffer[..(uri_len as usize - 1)])
-												.to_string();
-										}
-									}
-								}
-								if url.is_empty() {
-									let dest_result = lib().FPDFLink_GetDest(&document, &link);
-									let dest = dest_result.ok().or_else(|| {
-										lib()
-											.FPDFLink_GetAction(&link)
-											.ok()
-											.and_then(|action| lib().FPDFAction_GetDest(&document, &action).ok())
-									});
-									if let Some(dest) = dest {
-										let dest_page = lib().FPDFDest_GetDestPageIndex(&document, &dest);
-										if dest_page >= 0 {
-											url = format!("#page_{dest_page}");
-										}
-									}
-								}
-							}
-							if !url.is_empty()
-								&& let Some(pos) = page_display_text[last_search_pos..].find(&trimmed_link)
-							{
-								let text_before = &page_display_text[last_search_pos..last_search_pos + pos];
-								let marker_pos = page_start_offset
-									+ display_len(&page_display_text[..last_search_pos])
-									+ display_len(text_before);
-								let link_len = display_len(&trimmed_link);
-								buffer.add_marker(
-									Marker::new(MarkerType::Link, marker_pos)
-										.with_text(trimmed_link.clone())
-										.with_reference(url)
-										.with_length(link_len),
-								);
-								last_search_pos += pos + trimmed_link.len();
-							}
-						}
-					}
-				}
+		let workers = if page_count < PARALLEL_MIN_PAGES {
+			1
+		} else {
+			max_workers.min(usize::try_from(page_count).unwrap_or(1)).max(1)
+		};
+		let mut assembly = PageAssembly::default();
+		if workers == 1 {
+			for page_index in 0..page_count {
+				let fragment = extract_page(&document, page_index, render_tables_inline, !assembly.has_any_images);
+				assembly.push(page_index, fragment);
+				emitter.emit(&assembly.buffer);
 			}
-			page_lines_info.push(current_lines_info);
+		} else {
+			extract_pages_parallel(context, page_count, workers, |page_index, fragment| {
+				assembly.push(page_index, fragment);
+				emitter.emit(&assembly.buffer);
+			})?;
 		}
+		let PageAssembly {
+			mut buffer,
+			page_offsets,
+			id_positions,
+			page_lines_info,
+			flat_toc_items,
+			detected_heading_positions,
+			any_tags_processed,
+			has_any_text,
+			has_any_images,
+		} = assembly;
 		if !has_any_text && has_any_images {
 			let marker_position = buffer.current_position();
 			buffer.add_marker(Marker::new(MarkerType::PageBreak, marker_position).with_text(String::new()));
@@ -333,6 +150,349 @@ impl Parser for PdfParser {
 	}
 }
 
+/// Everything extracted from one page, with positions relative to the start of the page.
+#[derive(Default)]
+struct PageFragment {
+	buffer: DocumentBuffer,
+	lines_info: Vec<(usize, String)>,
+	toc_items: Vec<(u32, TocItem)>,
+	detected_headings: Vec<(usize, String)>,
+	tags_processed: bool,
+	has_text: bool,
+	has_images: bool,
+}
+
+/// The document under construction; page fragments are appended in page order and rebased onto it.
+#[derive(Default)]
+struct PageAssembly {
+	buffer: DocumentBuffer,
+	page_offsets: Vec<usize>,
+	id_positions: HashMap<String, usize>,
+	page_lines_info: Vec<Vec<(usize, String)>>,
+	flat_toc_items: Vec<(u32, TocItem)>,
+	detected_heading_positions: Vec<(usize, String)>,
+	any_tags_processed: bool,
+	has_any_text: bool,
+	has_any_images: bool,
+}
+
+impl PageAssembly {
+	fn push(&mut self, page_index: i32, fragment: PageFragment) {
+		let page_start = self.buffer.current_position();
+		self.page_offsets.push(page_start);
+		self.id_positions.insert(format!("page_{page_index}"), page_start);
+		self.buffer
+			.add_marker(Marker::new(MarkerType::PageBreak, page_start).with_text(format!("Page {}", page_index + 1)));
+		self.buffer.append(&fragment.buffer.content);
+		for mut marker in fragment.buffer.markers {
+			marker.position += page_start;
+			self.buffer.add_marker(marker);
+		}
+		self.page_lines_info
+			.push(fragment.lines_info.into_iter().map(|(offset, line)| (page_start + offset, line)).collect());
+		self.flat_toc_items.extend(fragment.toc_items.into_iter().map(|(level, mut item)| {
+			item.offset += page_start;
+			(level, item)
+		}));
+		self.detected_heading_positions
+			.extend(fragment.detected_headings.into_iter().map(|(offset, text)| (page_start + offset, text)));
+		self.any_tags_processed |= fragment.tags_processed;
+		self.has_any_text |= fragment.has_text;
+		self.has_any_images |= fragment.has_images;
+	}
+}
+
+fn default_extraction_workers() -> usize {
+	thread::available_parallelism().map_or(1, NonZeroUsize::get).min(MAX_EXTRACTION_WORKERS)
+}
+
+/// Extracts pages on `workers` scoped threads and hands each fragment to `on_page` in page order.
+///
+/// pdfium handles must not cross threads, so every worker opens the document itself.
+fn extract_pages_parallel(
+	context: &ParserContext,
+	page_count: i32,
+	workers: usize,
+	mut on_page: impl FnMut(i32, PageFragment),
+) -> Result<()> {
+	let next_page = AtomicI32::new(0);
+	let images_found = AtomicBool::new(false);
+	let (tx, rx) = mpsc::channel::<Result<(i32, PageFragment)>>();
+	thread::scope(|scope| {
+		for _ in 0..workers {
+			let tx = tx.clone();
+			let next_page = &next_page;
+			let images_found = &images_found;
+			scope.spawn(move || {
+				let document = match PdfiumDocument::new_from_path(&context.file_path, context.password.as_deref()) {
+					Ok(document) => document,
+					Err(err) => {
+						let _ = tx.send(Err(map_load_error(err)));
+						return;
+					}
+				};
+				loop {
+					let page_index = next_page.fetch_add(1, Ordering::Relaxed);
+					if page_index >= page_count {
+						return;
+					}
+					let check_images = !images_found.load(Ordering::Relaxed);
+					let fragment = extract_page(&document, page_index, context.render_tables_inline, check_images);
+					if fragment.has_images {
+						images_found.store(true, Ordering::Relaxed);
+					}
+					if tx.send(Ok((page_index, fragment))).is_err() {
+						return;
+					}
+				}
+			});
+		}
+		drop(tx);
+		// Dropping the receiver on error makes the remaining workers stop at their next page.
+		let mut ready = BTreeMap::new();
+		let mut next = 0;
+		for message in rx {
+			let (page_index, fragment) = message?;
+			ready.insert(page_index, fragment);
+			while let Some(fragment) = ready.remove(&next) {
+				on_page(next, fragment);
+				next += 1;
+			}
+		}
+		Ok(())
+	})
+}
+
+/// Extracts the text, markers and line layout of one page. `check_images` asks whether the page has any image
+/// objects, which only matters until one has been found somewhere in the document.
+fn extract_page(
+	document: &PdfiumDocument,
+	page_index: i32,
+	render_tables_inline: bool,
+	check_images: bool,
+) -> PageFragment {
+	let mut fragment = PageFragment::default();
+	let Ok(page) = document.page(page_index) else {
+		return fragment;
+	};
+	let Ok(text_page) = page.text() else {
+		return fragment;
+	};
+	let buffer = &mut fragment.buffer;
+	let current_lines_info = &mut fragment.lines_info;
+	let mut page_display_text = String::new();
+	if let Some(struct_tree) = page.struct_tree() {
+		let child_count = struct_tree.count_children();
+		if child_count > 0 {
+			let mut mcid_to_text: HashMap<i32, String> = HashMap::new();
+			let mut real_char_count: usize = 0;
+			let mut mcid_char_count: usize = 0;
+			if let Ok(char_count) = text_page.char_count() {
+				let mut current_mcid = -1;
+				// Chars of the current marked-content run with their pdfium index, so RTL
+				// runs can be reordered visual→logical per run.
+				let mut current_chars: Vec<(char, i32)> = Vec::new();
+				for i in 0..char_count {
+					let unicode = text_page.get_unicode(i);
+					if let Some(ch) = char::from_u32(unicode) {
+						if (ch.is_control() && !matches!(ch, '\n' | '\r' | '\t')) || ch == '\u{00AD}' {
+							continue;
+						}
+						let is_generated = text_page.is_generated(i).unwrap_or(false);
+						let mut char_mcid = -1;
+						if !is_generated && let Ok(obj) = text_page.get_text_object(i) {
+							char_mcid = obj.get_marked_content_id();
+						}
+						if !is_generated && !ch.is_whitespace() {
+							real_char_count += 1;
+							if char_mcid >= 0 {
+								mcid_char_count += 1;
+							}
+						}
+						if char_mcid >= 0 && char_mcid != current_mcid {
+							if current_mcid >= 0 && !current_chars.is_empty() {
+								mcid_to_text
+									.entry(current_mcid)
+									.or_default()
+									.push_str(&reorder_run(&text_page, &current_chars));
+							}
+							current_chars.clear();
+							current_mcid = char_mcid;
+						}
+						current_chars.push((ch, i));
+					}
+				}
+				if current_mcid >= 0 && !current_chars.is_empty() {
+					mcid_to_text.entry(current_mcid).or_default().push_str(&reorder_run(&text_page, &current_chars));
+				}
+			}
+			let coverage = if real_char_count > 0 { mcid_char_count as f64 / real_char_count as f64 } else { 1.0 };
+			if coverage >= MIN_MCID_COVERAGE {
+				let mut current_block = String::new();
+				for i in 0..child_count {
+					if let Ok(child) = struct_tree.child(i) {
+						process_struct_element(
+							&child,
+							&mcid_to_text,
+							buffer,
+							&mut page_display_text,
+							&mut current_block,
+							current_lines_info,
+							&mut fragment.toc_items,
+							render_tables_inline,
+						);
+					}
+				}
+				flush_block(&mut current_block, buffer, &mut page_display_text, current_lines_info);
+				fragment.tags_processed = true;
+			}
+		}
+	}
+	if fragment.tags_processed {
+		fragment.has_text = true;
+	} else {
+		let line_infos = extract_text_lines(&text_page);
+		let body_size = median_line_font_size(&line_infos);
+		let paragraphs = join_paragraphs(&line_infos, body_size);
+		if !paragraphs.is_empty() {
+			fragment.has_text = true;
+		}
+		for (text, is_heading) in &paragraphs {
+			let current_offset = buffer.current_position();
+			if *is_heading {
+				fragment.detected_headings.push((current_offset, text.clone()));
+			}
+			current_lines_info.push((current_offset, text.clone()));
+			buffer.append(text);
+			buffer.append("\n");
+			page_display_text.push_str(text);
+			page_display_text.push('\n');
+		}
+	}
+	// Check for image objects on this page
+	if check_images {
+		let obj_count = lib().FPDFPage_CountObjects(&page);
+		for i in 0..obj_count {
+			if let Ok(obj) = lib().FPDFPage_GetObject(&page, i)
+				&& lib().FPDFPageObj_GetType(&obj) == pdfium::pdfium_constants::FPDF_PAGEOBJ_IMAGE
+			{
+				fragment.has_images = true;
+				break;
+			}
+		}
+	}
+	// Load implicit web links
+	if let Ok(links) = text_page.load_web_links() {
+		let count = lib().FPDFLink_CountWebLinks(&links);
+		let mut last_search_pos = 0;
+		for i in 0..count {
+			let mut start = 0;
+			let mut char_count = 0;
+			if lib().FPDFLink_GetTextRange(&links, i, &mut start, &mut char_count).is_ok() {
+				let link_text = sanitize_pdf_text(&text_page.extract(start, char_count));
+				let trimmed_link = trim_string(&collapse_whitespace(&link_text));
+				if trimmed_link.is_empty() {
+					continue;
+				}
+				let mut url_buffer = vec![0u16; 2048];
+				let len = lib().FPDFLink_GetURL(&links, i, &mut url_buffer[0], 2048);
+				if len > 0 {
+					let url = String::from_utf16_lossy(&url_buffer[..(len as usize - 1)]);
+					if let Some(pos) = page_display_text[last_search_pos..].find(&trimmed_link) {
+						let text_before = &page_display_text[last_search_pos..last_search_pos + pos];
+						let marker_pos = display_len(&page_display_text[..last_search_pos]) + display_len(text_before);
+						let link_len = display_len(&trimmed_link);
+						buffer.add_marker(
+							Marker::new(MarkerType::Link, marker_pos)
+								.with_text(trimmed_link.clone())
+								.with_reference(url)
+								.with_length(link_len),
+						);
+						last_search_pos += pos + trimmed_link.len();
+					}
+				}
+			}
+		}
+	}
+	// Load explicit annotations (internal and external links)
+	let annot_count = lib().FPDFPage_GetAnnotCount(&page);
+	let mut last_search_pos = 0;
+	for i in 0..annot_count {
+		let annot_result = lib().FPDFPage_GetAnnot(&page, i);
+		if let Ok(annot) = annot_result
+			&& lib().FPDFAnnot_GetSubtype(&annot) == pdfium::pdfium_constants::FPDF_ANNOT_LINK
+		{
+			let mut rect = pdfium::pdfium_types::FS_RECTF { left: 0.0, top: 0.0, right: 0.0, bottom: 0.0 };
+			if lib().FPDFAnnot_GetRect(&annot, &mut rect).is_ok() {
+				let mut text_buffer = vec![0u16; 2048];
+				let len = lib().FPDFText_GetBoundedText(
+					&text_page,
+					f64::from(rect.left),
+					f64::from(rect.top),
+					f64::from(rect.right),
+					f64::from(rect.bottom),
+					&mut text_buffer[0],
+					2048,
+				);
+				if len > 0 {
+					let text = sanitize_pdf_text(&String::from_utf16_lossy(&text_buffer[..(len as usize - 1)]));
+					let trimmed_link = trim_string(&collapse_whitespace(&text));
+					if trimmed_link.is_empty() {
+						continue;
+					}
+					let mut url = String::new();
+					let link_result = lib().FPDFAnnot_GetLink(&annot);
+					if let Ok(link) = link_result {
+						let action_result = lib().FPDFLink_GetAction(&link);
+						if let Ok(action) = action_result {
+							let action_type = lib().FPDFAction_GetType(&action);
+							// PDFACTION_URI is 3
+							if action_type == 3 {
+								let mut uri_buffer = vec![0u8; 2048];
+								let uri_len =
+									lib().FPDFAction_GetURIPath(document, &action, Some(&mut uri_buffer), 2048);
+								if uri_len > 0 {
+									url = String::from_utf8_lossy(&uri_buffer[..(uri_len as usize - 1)]).to_string();
+								}
+							}
+						}
+						if url.is_empty() {
+							let dest_result = lib().FPDFLink_GetDest(document, &link);
+							let dest = dest_result.ok().or_else(|| {
+								lib()
+									.FPDFLink_GetAction(&link)
+									.ok()
+									.and_then(|action| lib().FPDFAction_GetDest(document, &action).ok())
+							});
+							if let Some(dest) = dest {
+								let dest_page = lib().FPDFDest_GetDestPageIndex(document, &dest);
+								if dest_page >= 0 {
+									url = format!("#page_{dest_page}");
+								}
+							}
+						}
+					}
+					if !url.is_empty()
+						&& let Some(pos) = page_display_text[last_search_pos..].find(&trimmed_link)
+					{
+						let text_before = &page_display_text[last_search_pos..last_search_pos + pos];
+						let marker_pos = display_len(&page_display_text[..last_search_pos]) + display_len(text_before);
+						let link_len = display_len(&trimmed_link);
+						buffer.add_marker(
+							Marker::new(MarkerType::Link, marker_pos)
+								.with_text(trimmed_link.clone())
+								.with_reference(url)
+								.with_length(link_len),
+						);
+						last_search_pos += pos + trimmed_link.len();
+					}
+				}
+			}
+		}
+	}
+	fragment
+}
+
 fn add_heading_markers(buffer: &mut DocumentBuffer, items: &[TocItem], level: i32) {
 	for item in items {
 		let marker_type = match level {
@@ -880,8 +1040,8 @@ fn append_pdf_table_to_buffer(
 
 #[cfg(test)]
 mod tests {
-	use super::{append_pdf_table_to_buffer, join_paragraphs, sanitize_pdf_text};
-	use crate::document::{DocumentBuffer, MarkerType};
+	use super::{PageAssembly, PageFragment, append_pdf_table_to_buffer, join_paragraphs, sanitize_pdf_text};
+	use crate::document::{DocumentBuffer, Marker, MarkerType, TocItem};
 
 	#[test]
 	fn sanitize_pdf_text_strips_control_chars_and_soft_hyphens() {
@@ -889,6 +1049,43 @@ mod tests {
 		assert_eq!(sanitize_pdf_text("hy\u{00AD}phen"), "hyphen");
 	}
 
+	fn fragment(text: &str) -> PageFragment {
+		let mut fragment = PageFragment::default();
+		fragment.buffer.append(text);
+		fragment.buffer.add_marker(Marker::new(MarkerType::Link, 2).with_length(3));
+		fragment.lines_info.push((0, text.trim_end().to_string()));
+		fragment.toc_items.push((1, TocItem::new(text.trim_end().to_string(), String::new(), 0)));
+		fragment.has_text = true;
+		fragment
+	}
+
+	#[test]
+	fn page_assembly_rebases_fragments_onto_page_starts() {
+		let mut assembly = PageAssembly::default();
+		assembly.push(0, fragment("caf\u{e9} one\n"));
+		assembly.push(1, PageFragment::default());
+		assembly.push(2, fragment("two\n"));
+		assert_eq!(assembly.buffer.content, "caf\u{e9} one\ntwo\n");
+		assert_eq!(assembly.page_offsets, vec![0, 9, 9]);
+		assert_eq!(assembly.id_positions["page_2"], 9);
+		let positions: Vec<(MarkerType, usize)> =
+			assembly.buffer.markers.iter().map(|m| (m.mtype, m.position)).collect();
+		assert_eq!(
+			positions,
+			vec![
+				(MarkerType::PageBreak, 0),
+				(MarkerType::Link, 2),
+				(MarkerType::PageBreak, 9),
+				(MarkerType::PageBreak, 9),
+				(MarkerType::Link, 11),
+			]
+		);
+		assert_eq!(assembly.page_lines_info[2], vec![(9, "two".to_string())]);
+		assert!(assembly.page_lines_info[1].is_empty());
+		assert_eq!(assembly.flat_toc_items[1].1.offset, 9);
+		assert!(assembly.has_any_text && !assembly.has_any_images && !assembly.any_tags_processed);
+	}
+
 	#[test]
 	fn join_paragraphs_merges_continuation_lines() {
 		let lines = vec![("The suggestion appears here.".to_string(), 12.0), ("And here.".to_string(), 12.0)];
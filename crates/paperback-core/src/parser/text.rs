@@ -1,13 +1,25 @@
-use std::fs;
+use std::{
+	fs::File,
+	io::{ErrorKind, Read},
+};
 
 use anyhow::{Context, Result};
+use encoding_rs::{Decoder, Encoding, UTF_8};
 
 use crate::{
-	document::{Document, DocumentBuffer, ParserContext, ParserFlags},
-	parser::{Parser, util::path::extract_title_from_path},
-	util::{encoding::convert_to_utf8, text::remove_soft_hyphens},
+	document::{Document, DocumentBuffer, DocumentChunk, ParserContext, ParserFlags},
+	parser::{ChunkEmitter, Parser, util::path::extract_title_from_path},
+	util::{
+		encoding::{convert_to_utf8_owned_detecting, streaming_decoder},
+		text::strip_soft_hyphens,
+	},
 };
 
+/// Files at least this large are read and decoded a block at a time, so the first pages can be shown while the rest
+/// of the file is still loading and the raw bytes are never held alongside the decoded text.
+const STREAMING_THRESHOLD: u64 = 16 * 1024 * 1024;
+const BLOCK_SIZE: usize = 4 * 1024 * 1024;
+
 pub struct TextParser;
 
 impl Parser for TextParser {
@@ -20,17 +32,170 @@ impl Parser for TextParser {
 	}
 
 	fn supported_flags(&self) -> ParserFlags {
-		ParserFlags::NONE
+		ParserFlags::SUPPORTS_FOLLOW
 	}
 
 	fn parse(&self, context: &ParserContext) -> Result<Document> {
-		let bytes = fs::read(&context.file_path)
-			.with_context(|| format!("Failed to open text file '{}'", context.file_path))?;
-		let utf8_content = convert_to_utf8(&bytes);
-		let processed = remove_soft_hyphens(&utf8_content);
+		self.parse_streaming(context, None)
+	}
+
+	/// Emits one chunk per block for files over [`STREAMING_THRESHOLD`]; smaller files arrive whole.
+	fn parse_streaming(
+		&self,
+		context: &ParserContext,
+		on_chunk: Option<&mut dyn FnMut(DocumentChunk)>,
+	) -> Result<Document> {
+		let open_error = || format!("Failed to open text file '{}'", context.file_path);
+		let file = File::open(&context.file_path).with_context(open_error)?;
+		// Read exactly the length seen now, so a log that keeps growing can be followed from this offset.
+		let size = file.metadata().with_context(open_error)?.len();
+		let size_hint = usize::try_from(size).unwrap_or(0);
+		let mut input = file.take(size);
+		let streamed = if size >= STREAMING_THRESHOLD {
+			let mut emitter = ChunkEmitter::new(on_chunk);
+			decode_in_blocks(&mut input, BLOCK_SIZE, size_hint, &mut emitter).with_context(open_error)?
+		} else {
+			None
+		};
+		let (buffer, encoding) = if let Some(streamed) = streamed {
+			streamed
+		} else {
+			if size >= STREAMING_THRESHOLD {
+				// Some of the file was already read before streaming gave up, so start over.
+				input = File::open(&context.file_path).with_context(open_error)?.take(size);
+			}
+			let mut bytes = Vec::with_capacity(size_hint);
+			input.read_to_end(&mut bytes).with_context(open_error)?;
+			let (mut content, encoding) = convert_to_utf8_owned_detecting(bytes);
+			strip_soft_hyphens(&mut content);
+			(DocumentBuffer::with_content(content), encoding)
+		};
 		let title = extract_title_from_path(&context.file_path);
 		let mut doc = Document::new().with_title(title);
-		doc.set_buffer(DocumentBuffer::with_content(processed));
+		doc.set_buffer(buffer);
+		doc.source_len = Some(size);
+		doc.source_encoding = encoding;
 		Ok(doc)
 	}
 }
+
+/// Decodes `reader` `block_size` bytes at a time, appending each block to the buffer and reporting it to `emitter`.
+/// Returns the buffer together with the encoding it was decoded from.
+///
+/// Returns `None` when the encoding cannot be decoded incrementally, having read only the first block. It also gives up
+/// when a file without a BOM that started out as UTF-8 turns out to contain a malformed sequence: decoded whole, such a
+/// file is read as Windows-1252 instead, and its text must not depend on where the block boundaries fall. The chunks
+/// already emitted are then only a preview of the document.
+fn decode_in_blocks(
+	reader: &mut impl Read,
+	block_size: usize,
+	size_hint: usize,
+	emitter: &mut ChunkEmitter<'_>,
+) -> Result<Option<(DocumentBuffer, Option<&'static Encoding>)>> {
+	let mut block = vec![0; block_size];
+	let mut len = read_block(reader, &mut block)?;
+	let Some(mut decoder) = streaming_decoder(&block[..len]) else {
+		return Ok(None);
+	};
+	let strict_utf8 = decoder.encoding() == UTF_8 && Encoding::for_bom(&block[..len]).is_none();
+	let mut buffer = DocumentBuffer::new();
+	buffer.content.reserve(size_hint);
+	let mut text = String::new();
+	loop {
+		let last = len < block_size;
+		let malformed = decode_block(&mut decoder, &block[..len], last, &mut text);
+		if malformed && strict_utf8 {
+			return Ok(None);
+		}
+		strip_soft_hyphens(&mut text);
+		buffer.append(&text);
+		emitter.emit(&buffer);
+		if last {
+			// After a BOM, the decoder reports the encoding it named rather than the one it was created for.
+			return Ok(Some((buffer, Some(decoder.encoding()))));
+		}
+		len = read_block(reader, &mut block)?;
+	}
+}
+
+/// Decodes one block into `out`, returning whether any malformed sequence was replaced.
+fn decode_block(decoder: &mut Decoder, bytes: &[u8], last: bool, out: &mut String) -> bool {
+	out.clear();
+	if let Some(needed) = decoder.max_utf8_buffer_length(bytes.len()) {
+		out.reserve(needed);
+	}
+	// With the worst-case capacity reserved the decoder always consumes the whole block in one call.
+	let (_, read, replaced) = decoder.decode_to_string(bytes, out, last);
+	debug_assert_eq!(read, bytes.len());
+	replaced
+}
+
+/// Fills `block` as far as the reader allows; a short count means the end of the input.
+fn read_block(reader: &mut impl Read, block: &mut [u8]) -> Result<usize> {
+	let mut filled = 0;
+	while filled < block.len() {
+		match reader.read(&mut block[filled..]) {
+			Ok(0) => break,
+			Ok(n) => filled += n,
+			Err(err) if err.kind() == ErrorKind::Interrupted => {}
+			Err(err) => return Err(err.into()),
+		}
+	}
+	Ok(filled)
+}
+
+#[cfg(test)]
+mod tests {
+	use std::io::Cursor;
+
+	use encoding_rs::WINDOWS_1252;
+	use rstest::rstest;
+
+	use super::*;
+	use crate::util::encoding::convert_to_utf8;
+
+	fn utf16le_with_bom(text: &str) -> Vec<u8> {
+		[0xFF, 0xFE].into_iter().chain(text.encode_utf16().flat_map(u16::to_le_bytes)).collect()
+	}
+
+	#[rstest]
+	#[case("short".as_bytes().to_vec())]
+	#[case("café 😀 line\nnext soft\u{00AD}hyphen\r\n".repeat(40).into_bytes())]
+	#[case([b"\xEF\xBB\xBF".as_slice(), "boménage\n".repeat(30).as_bytes()].concat())]
+	#[case(utf16le_with_bom(&"utf-16 ☃\n".repeat(30)))]
+	#[case(b"caf\xE9 cr\xE8me\n".repeat(30))]
+	#[case([b"\xEF\xBB\xBF".as_slice(), "boménage\n".repeat(30).as_bytes(), b"bad \xFF tail"].concat())]
+	fn blocks_decode_like_the_whole_file(#[case] bytes: Vec<u8>) {
+		let mut expected = convert_to_utf8(&bytes).into_owned();
+		strip_soft_hyphens(&mut expected);
+		let mut chunks = Vec::new();
+		let mut on_chunk = |chunk: DocumentChunk| chunks.push(chunk.text);
+		let mut emitter = ChunkEmitter::new(Some(&mut on_chunk));
+		// Seven bytes splits multi-byte characters and UTF-16 code units across blocks.
+		let (buffer, encoding) =
+			decode_in_blocks(&mut Cursor::new(&bytes), 7, bytes.len(), &mut emitter).unwrap().unwrap();
+		assert_eq!(encoding, convert_to_utf8_owned_detecting(bytes.clone()).1);
+		assert_eq!(buffer.content, expected);
+		assert_eq!(chunks.concat(), expected);
+		let reference = DocumentBuffer::with_content(expected);
+		assert_eq!(buffer.newline_positions(), reference.newline_positions());
+	}
+
+	#[rstest]
+	#[case(b"\xE9 cr\xE8me\n")]
+	#[case(b"\xC3")]
+	fn utf8_malformed_after_the_first_block_falls_back_to_whole_file_decoding(#[case] tail: &[u8]) {
+		// The first block is valid UTF-8, but the file as a whole is not and decodes as Windows-1252.
+		let bytes = ["café au lait\n".repeat(30).as_bytes(), tail].concat();
+		assert_eq!(convert_to_utf8(&bytes), WINDOWS_1252.decode(&bytes).0);
+		let mut emitter = ChunkEmitter::new(None);
+		assert!(decode_in_blocks(&mut Cursor::new(&bytes), 7, bytes.len(), &mut emitter).unwrap().is_none());
+	}
+
+	#[test]
+	fn utf32_input_falls_back_to_whole_file_decoding() {
+		let bytes = b"\xFF\xFE\x00\x00A\x00\x00\x00".repeat(4);
+		let mut emitter = ChunkEmitter::new(None);
+		assert!(decode_in_blocks(&mut Cursor::new(&bytes), 7, bytes.len(), &mut emitter).unwrap().is_none());
+	}
+}
@@ -1,5 +1,7 @@
 pub mod bidi;
 pub mod ooxml;
+pub mod parallel;
 pub mod path;
+pub mod pending_line;
 pub mod toc;
 pub mod xml;
@@ -0,0 +1,166 @@
+use std::{
+	collections::BTreeMap,
+	num::NonZeroUsize,
+	sync::{Mutex, PoisonError, mpsc},
+	thread,
+};
+
+const MAX_WORKERS: usize = 8;
+
+/// Items per worker that [`map_ordered`] callers read ahead: enough to keep every worker busy while items of
+/// uneven size finish out of order.
+pub const IN_FLIGHT_PER_WORKER: usize = 4;
+
+/// Number of worker threads to use for CPU-bound per-section conversion.
+#[must_use]
+pub fn default_workers() -> usize {
+	thread::available_parallelism().map_or(1, NonZeroUsize::get).min(MAX_WORKERS)
+}
+
+/// Runs `convert` over `items` on up to `workers` scoped threads and hands each result to `on_result` in item order.
+///
+/// Results that finish early are held back until every item before them has been delivered, so `on_result` sees
+/// exactly the sequence a plain loop would produce. With one worker, or one item, everything runs on the calling
+/// thread.
+///
+/// `items` is pulled on the calling thread only as results are delivered, so at most `max_in_flight` items are read
+/// but not yet handed to `on_result` at any time. This lets a parser read sections out of an archive lazily and drop
+/// each section's source once it is converted, instead of holding the whole book's sources next to its text.
+pub fn map_ordered<T, U>(
+	items: impl IntoIterator<Item = T>,
+	workers: usize,
+	max_in_flight: usize,
+	convert: impl Fn(T) -> U + Sync,
+	mut on_result: impl FnMut(usize, U),
+) where
+	T: Send,
+	U: Send,
+{
+	let mut items = items.into_iter();
+	let workers = items.size_hint().1.map_or(workers, |len| workers.min(len));
+	if workers <= 1 {
+		for (index, item) in items.enumerate() {
+			on_result(index, convert(item));
+		}
+		return;
+	}
+	let max_in_flight = max_in_flight.max(workers);
+	let (work_tx, work_rx) = mpsc::channel::<(usize, T)>();
+	let work_rx = Mutex::new(work_rx);
+	let (result_tx, result_rx) = mpsc::channel::<Option<(usize, U)>>();
+	thread::scope(|scope| {
+		for _ in 0..workers {
+			let result_tx = result_tx.clone();
+			let work_rx = &work_rx;
+			let convert = &convert;
+			scope.spawn(move || {
+				let _panic_guard = PanicGuard(&result_tx);
+				loop {
+					let next = work_rx.lock().unwrap_or_else(PoisonError::into_inner).recv();
+					let Ok((index, item)) = next else { return };
+					if result_tx.send(Some((index, convert(item)))).is_err() {
+						return;
+					}
+				}
+			});
+		}
+		drop(result_tx);
+		let mut ready = BTreeMap::new();
+		let mut read = 0;
+		let mut delivered = 0;
+		let mut exhausted = false;
+		loop {
+			while !exhausted && read - delivered < max_in_flight {
+				if let Some(item) = items.next() {
+					// Workers only stop receiving once `work_tx` is dropped below, so this cannot fail.
+					let _ = work_tx.send((read, item));
+					read += 1;
+				} else {
+					exhausted = true;
+				}
+			}
+			if delivered == read {
+				break;
+			}
+			// A worker that panicked took its item with it; stop here and let the scope re-raise the panic.
+			let Ok(Some((index, result))) = result_rx.recv() else { break };
+			ready.insert(index, result);
+			while let Some(result) = ready.remove(&delivered) {
+				on_result(delivered, result);
+				delivered += 1;
+			}
+		}
+		drop(work_tx);
+	});
+}
+
+/// Tells the delivering thread that a worker panicked, so it stops waiting for a result that will never arrive.
+struct PanicGuard<'a, U>(&'a mpsc::Sender<Option<(usize, U)>>);
+
+impl<U> Drop for PanicGuard<'_, U> {
+	fn drop(&mut self) {
+		if thread::panicking() {
+			let _ = self.0.send(None);
+		}
+	}
+}
+
+#[cfg(test)]
+mod tests {
+	use std::{cell::Cell, thread, time::Duration};
+
+	use rstest::rstest;
+
+	use super::*;
+
+	#[rstest]
+	#[case(1)]
+	#[case(3)]
+	#[case(8)]
+	fn results_arrive_in_item_order(#[case] workers: usize) {
+		let items: Vec<u64> = (0..20).collect();
+		let mut seen = Vec::new();
+		map_ordered(
+			&items,
+			workers,
+			items.len(),
+			|&n| {
+				// Make early items the slowest so out-of-order completion actually happens.
+				thread::sleep(Duration::from_millis(20 - n));
+				n * n
+			},
+			|index, square| seen.push((index, square)),
+		);
+		let expected: Vec<(usize, u64)> = items.iter().map(|&n| (usize::try_from(n).unwrap(), n * n)).collect();
+		assert_eq!(seen, expected);
+	}
+
+	#[rstest]
+	#[case(1)]
+	#[case(4)]
+	fn bounded_reads_stay_within_the_window(#[case] workers: usize) {
+		let read = Cell::new(0);
+		let mut delivered = Vec::new();
+		map_ordered(
+			(0..50_u64).inspect(|_| read.set(read.get() + 1)),
+			workers,
+			6,
+			|n| {
+				thread::sleep(Duration::from_millis(50 % (n + 1)));
+				n + 1
+			},
+			|index, value| {
+				assert!(read.get() - index <= 6.max(workers));
+				delivered.push(value);
+			},
+		);
+		assert_eq!(delivered, (1..=50).collect::<Vec<_>>());
+	}
+
+	#[test]
+	fn empty_input_calls_nothing() {
+		let mut calls = 0;
+		map_ordered(std::iter::empty::<u8>(), 4, 4, |_| (), |_, ()| calls += 1);
+		assert_eq!(calls, 0);
+	}
+}
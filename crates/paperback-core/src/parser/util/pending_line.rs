@@ -0,0 +1,129 @@
+use std::{fmt, mem};
+
+use crate::util::text::{ch_width, is_space_like};
+
+/// The line an HTML/XML converter is still assembling.
+///
+/// Alongside the text it keeps running display lengths, both raw and as the line will read once its whitespace is
+/// collapsed, so a converter can record the position of every inline element in O(1) instead of re-collapsing the
+/// whole line each time.
+#[derive(Debug, Default)]
+pub struct PendingLine {
+	text: String,
+	display_len: usize,
+	collapsed_len: usize,
+	/// Whether a non-whitespace character has been seen; leading whitespace never counts towards `collapsed_len`.
+	started: bool,
+	/// Whether the last character was whitespace that has already been counted as the run's single space.
+	in_space: bool,
+}
+
+impl PendingLine {
+	pub fn push_str(&mut self, s: &str) {
+		s.chars().for_each(|ch| self.track(ch));
+		self.text.push_str(s);
+	}
+
+	pub fn push(&mut self, ch: char) {
+		self.track(ch);
+		self.text.push(ch);
+	}
+
+	const fn track(&mut self, ch: char) {
+		self.display_len += ch_width(ch);
+		if is_space_like(ch) {
+			if self.started && !self.in_space {
+				self.collapsed_len += 1;
+				self.in_space = true;
+			}
+		} else {
+			self.started = true;
+			self.in_space = false;
+			self.collapsed_len += ch_width(ch);
+		}
+	}
+
+	#[must_use]
+	pub fn as_str(&self) -> &str {
+		&self.text
+	}
+
+	#[must_use]
+	pub const fn is_empty(&self) -> bool {
+		self.text.is_empty()
+	}
+
+	pub fn clear(&mut self) {
+		self.text.clear();
+		self.reset_lengths();
+	}
+
+	/// Hands the line over and leaves an empty one in its place.
+	pub fn take(&mut self) -> String {
+		self.reset_lengths();
+		mem::take(&mut self.text)
+	}
+
+	const fn reset_lengths(&mut self) {
+		self.display_len = 0;
+		self.collapsed_len = 0;
+		self.started = false;
+		self.in_space = false;
+	}
+
+	/// Display length of the line as it stands.
+	#[must_use]
+	pub const fn display_len(&self) -> usize {
+		self.display_len
+	}
+
+	/// Display length of `collapse_whitespace(line).trim_start()`: leading whitespace dropped and every later run of
+	/// whitespace, including a trailing one, counted as a single space.
+	#[must_use]
+	pub const fn collapsed_display_len(&self) -> usize {
+		self.collapsed_len
+	}
+}
+
+impl fmt::Write for PendingLine {
+	fn write_str(&mut self, s: &str) -> fmt::Result {
+		self.push_str(s);
+		Ok(())
+	}
+}
+
+#[cfg(test)]
+mod tests {
+	use rstest::rstest;
+
+	use super::*;
+	use crate::util::text::{collapse_whitespace, display_len};
+
+	#[rstest]
+	#[case(&["hello"])]
+	#[case(&["  lead", "ing"])]
+	#[case(&["a  b", " ", "\tc "])]
+	#[case(&["x\u{00A0}\u{200B}y", "  "])]
+	#[case(&["   ", "\n"])]
+	#[case(&["é😀 ", " z"])]
+	fn lengths_match_recollapsing_the_whole_line(#[case] parts: &[&str]) {
+		let mut line = PendingLine::default();
+		for part in parts {
+			line.push_str(part);
+			assert_eq!(line.display_len(), display_len(line.as_str()));
+			assert_eq!(line.collapsed_display_len(), display_len(collapse_whitespace(line.as_str()).trim_start()));
+		}
+	}
+
+	#[test]
+	fn take_returns_text_and_resets_lengths() {
+		let mut line = PendingLine::default();
+		line.push_str("one ");
+		line.push('2');
+		assert_eq!(line.take(), "one 2");
+		assert!(line.is_empty());
+		assert_eq!((line.display_len(), line.collapsed_display_len()), (0, 0));
+		line.push_str(" x");
+		assert_eq!(line.collapsed_display_len(), 1);
+	}
+}
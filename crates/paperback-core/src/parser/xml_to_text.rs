@@ -1,12 +1,12 @@
-use std::{collections::HashMap, mem};
+use std::collections::HashMap;
 
 use roxmltree::{Document, Node, NodeType, ParsingOptions};
 
 use crate::{
 	parser::{
-		ConverterOutput,
+		ConverterOutput, ConverterParts,
 		table_text::{push_finalized_line, table_render_bundle},
-		util::xml::collect_element_text,
+		util::{pending_line::PendingLine, xml::collect_element_text},
 	},
 	t,
 	types::{
@@ -31,7 +31,7 @@ impl Default for ListStyle {
 #[derive(Default)]
 pub struct XmlToText {
 	lines: Vec<String>,
-	current_line: String,
+	current_line: PendingLine,
 	id_positions: HashMap<String, usize>,
 	headings: Vec<HeadingInfo>,
 	links: Vec<LinkInfo>,
@@ -97,6 +97,26 @@ impl XmlToText {
 		self.lines.join("\n")
 	}
 
+	/// Consumes the converter, moving its text and metadata out instead of copying them.
+	#[must_use]
+	pub fn into_parts(self) -> ConverterParts {
+		ConverterParts {
+			text: self.lines.join("\n"),
+			headings: self.headings,
+			links: self.links,
+			images: self.images,
+			figures: self.figures,
+			tables: self.tables,
+			separators: self.separators,
+			lists: self.lists,
+			list_items: self.list_items,
+			bolds: self.bolds,
+			italics: self.italics,
+			underlines: self.underlines,
+			id_positions: self.id_positions,
+		}
+	}
+
 	/// Returns the source byte offset of the start tag of the element nearest
 	/// at-or-before `target_position` (a character position in the converted text),
 	/// suitable as an insertion point for a navigation anchor.
@@ -515,7 +535,7 @@ impl XmlToText {
 				let mut collapsed = collapse_whitespace(&processed_text);
 				if self.current_line.is_empty() {
 					collapsed = collapsed.trim_start().to_string();
-				} else if self.current_line.ends_with(' ') && collapsed.starts_with(' ') {
+				} else if self.current_line.as_str().ends_with(' ') && collapsed.starts_with(' ') {
 					collapsed.remove(0);
 				}
 				if !collapsed.is_empty() {
@@ -548,20 +568,18 @@ impl XmlToText {
 	}
 
 	fn finalize_current_line(&mut self) {
-		let line = mem::take(&mut self.current_line);
+		let line = self.current_line.take();
 		self.add_line(line);
 	}
 
 	fn current_display_len(&self) -> usize {
 		if self.is_preserving_whitespace() {
-			return display_len(&self.current_line);
+			return self.current_line.display_len();
 		}
-		let collapsed = collapse_whitespace(&self.current_line);
-		// Use trim_start() not trim(): trailing whitespace before an inline element IS
-		// preserved in the output line, so including it in the position count keeps
-		// link/anchor offsets correctly aligned with the final text.
-		let trimmed = collapsed.trim_start();
-		display_len(trimmed)
+		// Leading whitespace is dropped, but a trailing run counts as one space: whitespace before
+		// an inline element (e.g. a space before <a>) is preserved in the output line, so counting
+		// it keeps link/anchor offsets aligned with the final text.
+		self.current_line.collapsed_display_len()
 	}
 
 	fn get_current_text_position(&self) -> usize {
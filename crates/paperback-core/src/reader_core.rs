@@ -1,9 +1,14 @@
+use std::{
+	sync::atomic::{AtomicBool, Ordering},
+	time::{Duration, Instant},
+};
+
 use bitflags::bitflags;
-use regex::RegexBuilder;
+use regex::{Regex, RegexBuilder};
 
 use crate::{
 	config::{Bookmark, ConfigManager as RustConfigManager},
-	document::{DocumentHandle, MarkerType},
+	document::{DocumentBuffer, DocumentHandle, MarkerType, PositionIndex},
 	parser::is_external_url,
 	types::{self as ffi, HeadingInfo},
 };
@@ -156,37 +161,70 @@ fn line_after(doc: &DocumentHandle, end: usize) -> usize {
 	buffer.newline_positions().iter().find(|&&nl| nl >= probe).map_or(total, |&nl| (nl + 1).min(total))
 }
 
+/// Finds `needle` in `haystack` from display-unit offset `start`, returning the match's
+/// display-unit offset or -1.
+///
+/// Forward searches return the first match at or after `start`; backward searches the last match
+/// that starts before it.
 #[must_use]
 pub fn reader_search(haystack: &str, needle: &str, start: i64, options: SearchOptions) -> i64 {
+	reader_search_indexed(haystack, &PositionIndex::for_text(haystack), needle, start, options)
+}
+
+/// [`reader_search`] over a haystack whose position index has already been built, such as a
+/// document buffer's.
+#[must_use]
+pub fn reader_search_indexed(
+	haystack: &str,
+	positions: &PositionIndex,
+	needle: &str,
+	start: i64,
+	options: SearchOptions,
+) -> i64 {
 	if needle.is_empty() {
 		return -1;
 	}
-	let start_utf16 = usize::try_from(start.clamp(0, i64::MAX)).unwrap_or(0);
-
-	let utf16_to_byte_index = |s: &str, utf16_idx: usize| -> usize {
-		let mut utf16_count = 0usize;
-		for (byte_idx, ch) in s.char_indices() {
-			let len16 = ch.len_utf16();
-			if utf16_count >= utf16_idx {
-				return byte_idx;
-			}
-			utf16_count += len16;
-		}
-		s.len()
+	let start_byte = positions.byte_for_display(haystack, usize::try_from(start.max(0)).unwrap_or(0));
+	let Some(re) = build_search_regex(needle, options) else {
+		return -1;
 	};
-	let byte_to_utf16_index = |s: &str, byte_idx: usize| -> usize {
-		let mut utf16_count = 0usize;
-		for (idx, ch) in s.char_indices() {
-			if idx >= byte_idx {
-				break;
-			}
-			utf16_count += ch.len_utf16();
-		}
-		utf16_count
+	let found = if options.contains(SearchOptions::FORWARD) {
+		re.find(&haystack[start_byte..]).map(|m| start_byte + m.start())
+	} else {
+		re.find_iter(&haystack[..start_byte]).last().map(|m| m.start())
 	};
-	let start_byte = utf16_to_byte_index(haystack, start_utf16);
+	found.map_or(-1, |byte_pos| i64::try_from(positions.display_for_byte(haystack, byte_pos)).unwrap_or(-1))
+}
+
+#[must_use]
+pub fn reader_search_with_wrap(haystack: &str, needle: &str, start: i64, options: SearchOptions) -> ffi::SearchResult {
+	reader_search_with_wrap_indexed(haystack, &PositionIndex::for_text(haystack), needle, start, options)
+}
+
+/// [`reader_search_with_wrap`] over a haystack whose position index has already been built.
+#[must_use]
+pub fn reader_search_with_wrap_indexed(
+	haystack: &str,
+	positions: &PositionIndex,
+	needle: &str,
+	start: i64,
+	options: SearchOptions,
+) -> ffi::SearchResult {
+	let position = reader_search_indexed(haystack, positions, needle, start, options);
+	if position >= 0 {
+		return ffi::SearchResult { found: true, wrapped: false, position };
+	}
+	let wrap_pos =
+		if options.contains(SearchOptions::FORWARD) { 0 } else { i64::try_from(positions.display_len()).unwrap_or(0) };
+	let wrapped_position = reader_search_indexed(haystack, positions, needle, wrap_pos, options);
+	if wrapped_position >= 0 {
+		return ffi::SearchResult { found: true, wrapped: true, position: wrapped_position };
+	}
+	ffi::SearchResult { found: false, wrapped: false, position: -1 }
+}
 
-	// Build regex for search - this avoids copying/lowercasing the entire haystack
+/// Compiles the regex for a search; matching it avoids copying/lowercasing the entire haystack.
+fn build_search_regex(needle: &str, options: SearchOptions) -> Option<Regex> {
 	let escaped_needle =
 		if options.contains(SearchOptions::REGEX) { needle.to_string() } else { regex::escape(needle) };
 	let pattern =
@@ -195,50 +233,204 @@ pub fn reader_search(haystack: &str, needle: &str, start: i64, options: SearchOp
 	if !options.contains(SearchOptions::MATCH_CASE) {
 		builder.case_insensitive(true);
 	}
-	let Ok(re) = builder.build() else {
-		return -1;
-	};
+	builder.build().ok()
+}
+
+/// Repeated find-next/find-previous over a single document.
+///
+/// The compiled regex and the sorted display-unit offsets of every match are cached for the last
+/// (needle, options) pair, so stepping through hits is a binary search rather than a rescan of the
+/// haystack. The direction flag is not part of the key, and the cache is only rebuilt when the
+/// query changes; callers must [`invalidate`](Self::invalidate) it if the haystack itself changes.
+/// Empty regex matches are not indexed.
+#[derive(Default)]
+pub struct SearchSession {
+	key: Option<(String, SearchOptions)>,
+	regex: Option<Regex>,
+	matches: Option<Vec<usize>>,
+}
+
+impl SearchSession {
+	#[must_use]
+	pub fn new() -> Self {
+		Self::default()
+	}
 
-	if options.contains(SearchOptions::FORWARD) {
-		if let Some(m) = re.find(&haystack[start_byte..]) {
-			let byte_pos = start_byte + m.start();
-			let utf16_pos = byte_to_utf16_index(haystack, byte_pos);
-			return i64::try_from(utf16_pos).unwrap_or(-1);
+	/// Drops the cached regex and match index.
+	pub fn invalidate(&mut self) {
+		self.key = None;
+		self.regex = None;
+		self.matches = None;
+	}
+
+	fn prepare(&mut self, needle: &str, options: SearchOptions) {
+		let options = options - SearchOptions::FORWARD;
+		if self.key.as_ref().is_some_and(|(n, o)| n == needle && *o == options) {
+			return;
 		}
-	} else {
-		let mut last: Option<usize> = None;
-		let end_byte = start_byte.min(haystack.len());
-		for m in re.find_iter(&haystack[..end_byte]) {
-			last = Some(m.start());
+		self.regex = build_search_regex(needle, options);
+		self.matches = None;
+		self.key = Some((needle.to_string(), options));
+	}
+
+	/// The compiled regex for `needle`, or `None` when the pattern is invalid.
+	pub fn regex(&mut self, needle: &str, options: SearchOptions) -> Option<&Regex> {
+		self.prepare(needle, options);
+		self.regex.as_ref()
+	}
+
+	/// Display-unit offsets of every match of `needle`, in document order, built on first use.
+	pub fn matches(
+		&mut self,
+		haystack: &str,
+		positions: &PositionIndex,
+		needle: &str,
+		options: SearchOptions,
+	) -> &[usize] {
+		self.prepare(needle, options);
+		let regex = self.regex.as_ref();
+		self.matches.get_or_insert_with(|| {
+			regex.map_or_else(Vec::new, |re| {
+				re.find_iter(haystack)
+					.filter(|m| !m.is_empty())
+					.map(|m| positions.display_for_byte(haystack, m.start()))
+					.collect()
+			})
+		})
+	}
+
+	/// Cached equivalent of [`reader_search_indexed`].
+	pub fn find(
+		&mut self,
+		haystack: &str,
+		positions: &PositionIndex,
+		needle: &str,
+		start: i64,
+		options: SearchOptions,
+	) -> i64 {
+		if needle.is_empty() {
+			return -1;
 		}
-		if let Some(pos) = last {
-			let utf16_pos = byte_to_utf16_index(haystack, pos);
-			return i64::try_from(utf16_pos).unwrap_or(-1);
+		let start = usize::try_from(start.max(0)).unwrap_or(0);
+		let matches = self.matches(haystack, positions, needle, options);
+		let next = matches.partition_point(|&m| m < start);
+		if options.contains(SearchOptions::FORWARD) {
+			return matches.get(next).map_or(-1, |&pos| i64::try_from(pos).unwrap_or(-1));
 		}
+		// Backward hits must end at or before `start`; only the last candidate can straddle it.
+		let Some(candidate) = next.checked_sub(1).map(|i| matches[i]) else {
+			return -1;
+		};
+		let previous = next.checked_sub(2).map(|i| matches[i]);
+		let start_byte = positions.byte_for_display(haystack, start);
+		let straddles = self
+			.regex
+			.as_ref()
+			.and_then(|re| re.find_at(haystack, positions.byte_for_display(haystack, candidate)))
+			.is_some_and(|m| m.end() > start_byte);
+		let found = if straddles { previous } else { Some(candidate) };
+		found.map_or(-1, |pos| i64::try_from(pos).unwrap_or(-1))
+	}
+
+	/// Cached equivalent of [`reader_search_with_wrap_indexed`].
+	pub fn find_with_wrap(
+		&mut self,
+		haystack: &str,
+		positions: &PositionIndex,
+		needle: &str,
+		start: i64,
+		options: SearchOptions,
+	) -> ffi::SearchResult {
+		let position = self.find(haystack, positions, needle, start, options);
+		if position >= 0 {
+			return ffi::SearchResult { found: true, wrapped: false, position };
+		}
+		if needle.is_empty() {
+			return ffi::SearchResult { found: false, wrapped: false, position: -1 };
+		}
+		let matches = self.matches(haystack, positions, needle, options);
+		let wrapped = if options.contains(SearchOptions::FORWARD) { matches.first() } else { matches.last() };
+		wrapped.map_or(ffi::SearchResult { found: false, wrapped: false, position: -1 }, |&pos| ffi::SearchResult {
+			found: true,
+			wrapped: true,
+			position: i64::try_from(pos).unwrap_or(-1),
+		})
 	}
-	-1
 }
 
-#[must_use]
-pub fn reader_search_with_wrap(haystack: &str, needle: &str, start: i64, options: SearchOptions) -> ffi::SearchResult {
-	let position = reader_search(haystack, needle, start, options);
-	if position >= 0 {
-		return ffi::SearchResult { found: true, wrapped: false, position };
+const FIND_ALL_BATCH_SIZE: usize = 256;
+const FIND_ALL_BATCH_INTERVAL: Duration = Duration::from_millis(50);
+const SNIPPET_CONTEXT_CHARS: usize = 40;
+
+/// Streams every non-empty match of `re` in `buffer` to `on_batch`, in document order.
+///
+/// A batch is flushed every [`FIND_ALL_BATCH_SIZE`] hits or [`FIND_ALL_BATCH_INTERVAL`], whichever
+/// comes first, so the first hits of a search over a huge document arrive immediately. Returns the
+/// total number of hits, or `None` once `cancelled` is set; no batch is delivered after that.
+pub fn reader_find_all(
+	buffer: &DocumentBuffer,
+	re: &Regex,
+	cancelled: &AtomicBool,
+	mut on_batch: impl FnMut(Vec<ffi::SearchHit>),
+) -> Option<usize> {
+	let content = &buffer.content;
+	let positions = buffer.positions();
+	let newlines = buffer.newline_positions();
+	let mut batch = Vec::new();
+	let mut total = 0;
+	let mut last_flush = Instant::now();
+	for m in re.find_iter(content).filter(|m| !m.is_empty()) {
+		if cancelled.load(Ordering::Relaxed) {
+			return None;
+		}
+		let char_index = positions.char_for_byte(content, m.start());
+		let start = positions.display_for_char(content, char_index);
+		let end = positions.display_for_byte(content, m.end());
+		batch.push(ffi::SearchHit {
+			position: i64::try_from(start).unwrap_or(i64::MAX),
+			length: i64::try_from(end - start).unwrap_or(0),
+			line_number: i64::try_from(newlines.partition_point(|&p| p < char_index) + 1).unwrap_or(1),
+			snippet: match_snippet(content, m.start(), m.end()),
+		});
+		total += 1;
+		if batch.len() >= FIND_ALL_BATCH_SIZE || last_flush.elapsed() >= FIND_ALL_BATCH_INTERVAL {
+			if cancelled.load(Ordering::Relaxed) {
+				return None;
+			}
+			on_batch(std::mem::take(&mut batch));
+			last_flush = Instant::now();
+		}
 	}
-	let wrap_pos = if options.contains(SearchOptions::FORWARD) {
-		0
-	} else {
-		i64::try_from(haystack.encode_utf16().count()).unwrap_or(0)
-	};
-	let wrapped_position = reader_search(haystack, needle, wrap_pos, options);
-	if wrapped_position >= 0 {
-		return ffi::SearchResult { found: true, wrapped: true, position: wrapped_position };
+	if cancelled.load(Ordering::Relaxed) {
+		return None;
 	}
-	ffi::SearchResult { found: false, wrapped: false, position: -1 }
+	if !batch.is_empty() {
+		on_batch(batch);
+	}
+	Some(total)
+}
+
+/// The match at `start..end` with up to [`SNIPPET_CONTEXT_CHARS`] of context either side, cut at
+/// the surrounding line breaks.
+fn match_snippet(content: &str, start: usize, end: usize) -> String {
+	let before = content[..start]
+		.char_indices()
+		.rev()
+		.take(SNIPPET_CONTEXT_CHARS)
+		.take_while(|&(_, ch)| ch != '\n')
+		.last()
+		.map_or(start, |(i, _)| i);
+	let after = content[end..]
+		.char_indices()
+		.take(SNIPPET_CONTEXT_CHARS)
+		.take_while(|&(_, ch)| ch != '\n')
+		.last()
+		.map_or(end, |(i, ch)| end + i + ch.len_utf8());
+	content[before..after].replace('\n', " ").trim().to_string()
 }
 
 bitflags! {
-	#[derive(Copy, Clone)]
+	#[derive(Copy, Clone, Debug, PartialEq, Eq)]
 	pub struct SearchOptions: u8 {
 		const FORWARD = 1 << 0;
 		const MATCH_CASE = 1 << 1;
@@ -255,41 +447,27 @@ pub fn bookmark_navigate(
 	next: bool,
 	notes_only: bool,
 ) -> ffi::BookmarkNavResult {
-	let mut bookmarks: Vec<Bookmark> = manager.get_bookmarks(path);
-	if notes_only {
-		bookmarks.retain(|b| !b.note.is_empty());
-	}
-	if bookmarks.is_empty() {
-		return ffi::BookmarkNavResult { found: false, start: -1, note: String::new(), index: -1, wrapped: false };
-	}
-	bookmarks.sort_by_key(|b| b.start);
-	let find_from = |from: i64, forward: bool, list: &[Bookmark]| -> Option<(usize, Bookmark)> {
-		if forward {
-			list.iter().enumerate().find(|(_, b)| b.start > from).map(|(i, b)| (i, b.clone()))
-		} else {
-			list.iter().enumerate().rev().find(|(_, b)| b.start < from).map(|(i, b)| (i, b.clone()))
+	manager.with_bookmark_index(path, |index| {
+		let find_from =
+			|from: i64| if next { index.next_after(from, notes_only) } else { index.previous_before(from, notes_only) };
+		let mut wrapped = false;
+		let mut hit = find_from(position);
+		if hit.is_none() && wrap {
+			wrapped = true;
+			hit = find_from(if next { -1 } else { i64::MAX / 2 });
 		}
-	};
-	let mut wrapped = false;
-	let mut hit = if next { find_from(position, true, &bookmarks) } else { find_from(position, false, &bookmarks) };
-	if hit.is_none() && wrap {
-		wrapped = true;
-		hit = if next { find_from(-1, true, &bookmarks) } else { find_from(i64::MAX / 2, false, &bookmarks) };
-	}
-	if let Some((idx, bm)) = hit {
-		let index = i32::try_from(idx).unwrap_or(-1);
-		return ffi::BookmarkNavResult { found: true, start: bm.start, note: bm.note, index, wrapped };
-	}
-	ffi::BookmarkNavResult { found: false, start: -1, note: String::new(), index: -1, wrapped }
+		if let Some((idx, bm)) = hit {
+			let index = i32::try_from(idx).unwrap_or(-1);
+			return ffi::BookmarkNavResult { found: true, start: bm.start, note: bm.note.clone(), index, wrapped };
+		}
+		ffi::BookmarkNavResult { found: false, start: -1, note: String::new(), index: -1, wrapped }
+	})
 }
 
 pub fn bookmark_note_at_position(manager: &RustConfigManager, path: &str, position: i64) -> String {
-	manager
-		.get_bookmarks(path)
-		.into_iter()
-		.find(|bm| bm.start == position && !bm.note.is_empty())
-		.map(|bm| bm.note)
-		.unwrap_or_default()
+	manager.with_bookmark_index(path, |index| {
+		index.starting_at(position).find(|bm| !bm.note.is_empty()).map(|bm| bm.note.clone()).unwrap_or_default()
+	})
 }
 
 pub fn get_filtered_bookmarks(
@@ -298,32 +476,30 @@ pub fn get_filtered_bookmarks(
 	current_pos: i64,
 	filter: ffi::BookmarkFilterType,
 ) -> ffi::FilteredBookmarks {
-	let mut bookmarks: Vec<Bookmark> = manager.get_bookmarks(path);
-	match filter {
-		ffi::BookmarkFilterType::BookmarksOnly => {
-			bookmarks.retain(|b| b.note.is_empty());
-		}
-		ffi::BookmarkFilterType::NotesOnly => {
-			bookmarks.retain(|b| !b.note.is_empty());
-		}
-		ffi::BookmarkFilterType::All => {}
-	}
-	bookmarks.sort_by_key(|b| b.start);
-	let items: Vec<ffi::BookmarkDisplayItem> = bookmarks
-		.iter()
-		.map(|b| ffi::BookmarkDisplayItem {
-			start: b.start,
-			end: b.end,
-			note: b.note.clone(),
-			is_whole_line: b.start == b.end,
-		})
-		.collect();
-	let closest_index = if bookmarks.is_empty() {
+	let keep = |b: &Bookmark| match filter {
+		ffi::BookmarkFilterType::BookmarksOnly => b.note.is_empty(),
+		ffi::BookmarkFilterType::NotesOnly => !b.note.is_empty(),
+		ffi::BookmarkFilterType::All => true,
+	};
+	let items: Vec<ffi::BookmarkDisplayItem> = manager.with_bookmark_index(path, |index| {
+		index
+			.bookmarks()
+			.iter()
+			.filter(|b| keep(b))
+			.map(|b| ffi::BookmarkDisplayItem {
+				start: b.start,
+				end: b.end,
+				note: b.note.clone(),
+				is_whole_line: b.start == b.end,
+			})
+			.collect()
+	});
+	let closest_index = if items.is_empty() {
 		-1
 	} else {
 		let mut closest_idx = 0;
 		let mut min_distance = i64::MAX;
-		for (idx, b) in bookmarks.iter().enumerate() {
+		for (idx, b) in items.iter().enumerate() {
 			let distance = (b.start - current_pos).abs();
 			if distance < min_distance {
 				min_distance = distance;
@@ -562,7 +738,10 @@ mod tests {
 	use std::collections::HashMap;
 
 	use super::*;
-	use crate::document::{Document, DocumentBuffer, DocumentHandle, Marker, MarkerType};
+	use crate::{
+		document::{Document, DocumentBuffer, DocumentHandle, Marker, MarkerType},
+		util::text::display_len,
+	};
 
 	#[test]
 	fn reader_container_navigate_to_end_lands_on_following_line() {
@@ -611,10 +790,14 @@ mod tests {
 	}
 
 	#[test]
-	fn reader_search_handles_utf16_offsets() {
-		let haystack = "a😀b";
+	fn reader_search_reports_display_offsets() {
+		let haystack = "a😀b😀b";
 		let options = SearchOptions::FORWARD;
-		assert_eq!(reader_search(haystack, "b", 0, options), 3);
+		// The emoji is two UTF-16 units on Windows/macOS and one char elsewhere.
+		let first_b = i64::try_from(display_len("a😀")).unwrap();
+		assert_eq!(reader_search(haystack, "b", 0, options), first_b);
+		assert_eq!(reader_search(haystack, "b", first_b + 1, options), i64::try_from(display_len("a😀b😀")).unwrap());
+		assert_eq!(reader_search(haystack, "😀", first_b + 1, SearchOptions::empty()), 1);
 	}
 
 	#[test]
@@ -706,6 +889,103 @@ mod tests {
 		assert_eq!(result.position, 3);
 	}
 
+	#[test]
+	fn search_session_matches_uncached_search() {
+		let haystack = "One 😀 one, ONE\nnone 😀 One done";
+		let positions = PositionIndex::for_text(haystack);
+		let end = i64::try_from(positions.display_len()).unwrap();
+		let mut session = SearchSession::new();
+		for options in [SearchOptions::empty(), SearchOptions::MATCH_CASE] {
+			for forward in [false, true] {
+				let options = if forward { options | SearchOptions::FORWARD } else { options };
+				for start in -1..=end + 1 {
+					let expected = reader_search_with_wrap(haystack, "one", start, options);
+					let actual = session.find_with_wrap(haystack, &positions, "one", start, options);
+					assert_eq!(
+						(actual.found, actual.wrapped, actual.position),
+						(expected.found, expected.wrapped, expected.position)
+					);
+				}
+			}
+		}
+	}
+
+	#[test]
+	fn search_session_whole_word_ignores_caret_inside_a_word() {
+		// Slicing the haystack at the caret used to make it a word boundary, so "one" matched inside "none".
+		let haystack = "none one";
+		let positions = PositionIndex::for_text(haystack);
+		let options = SearchOptions::WHOLE_WORD | SearchOptions::FORWARD;
+		assert_eq!(SearchSession::new().find(haystack, &positions, "one", 1, options), 5);
+		assert_eq!(SearchSession::new().find(haystack, &positions, "one", 8, SearchOptions::WHOLE_WORD), 5);
+	}
+
+	#[test]
+	fn reader_find_all_reports_positions_lines_and_snippets() {
+		let buffer = DocumentBuffer::with_content("first 😀 match\nno hit here\nmatch and match".to_string());
+		let re = build_search_regex("match", SearchOptions::empty()).unwrap();
+		let mut hits = Vec::new();
+		let total = reader_find_all(&buffer, &re, &AtomicBool::new(false), |batch| hits.extend(batch));
+		assert_eq!(total, Some(3));
+		let expected_first = i64::try_from(display_len("first 😀 ")).unwrap();
+		assert_eq!(
+			hits[0],
+			ffi::SearchHit {
+				position: expected_first,
+				length: 5,
+				line_number: 1,
+				snippet: "first 😀 match".to_string()
+			}
+		);
+		assert_eq!(hits.iter().map(|h| h.line_number).collect::<Vec<_>>(), [1, 3, 3]);
+		assert_eq!(hits[2].snippet, "match and match");
+		assert_eq!(
+			buffer.content[buffer.byte_index_for_display(usize::try_from(hits[2].position).unwrap())..],
+			*"match"
+		);
+	}
+
+	#[test]
+	fn reader_find_all_batches_and_stops_when_cancelled() {
+		let buffer = DocumentBuffer::with_content("ab ".repeat(FIND_ALL_BATCH_SIZE * 2 + 10));
+		let re = build_search_regex("ab", SearchOptions::empty()).unwrap();
+		let mut batch_sizes = Vec::new();
+		let total = reader_find_all(&buffer, &re, &AtomicBool::new(false), |batch| batch_sizes.push(batch.len()));
+		assert_eq!(total, Some(FIND_ALL_BATCH_SIZE * 2 + 10));
+		assert_eq!(batch_sizes.iter().sum::<usize>(), FIND_ALL_BATCH_SIZE * 2 + 10);
+		assert!(batch_sizes.iter().all(|&len| len <= FIND_ALL_BATCH_SIZE));
+		let mut delivered = 0;
+		assert_eq!(reader_find_all(&buffer, &re, &AtomicBool::new(true), |batch| delivered += batch.len()), None);
+		assert_eq!(delivered, 0);
+	}
+
+	#[test]
+	fn match_snippet_is_bounded_by_context_and_line() {
+		let long = format!("{}needle{}", "x".repeat(100), "y".repeat(100));
+		let start = long.find("needle").unwrap();
+		let snippet = match_snippet(&long, start, start + "needle".len());
+		assert_eq!(
+			snippet,
+			format!("{}needle{}", "x".repeat(SNIPPET_CONTEXT_CHARS), "y".repeat(SNIPPET_CONTEXT_CHARS))
+		);
+		let text = "before\n  the needle  \nafter";
+		let start = text.find("needle").unwrap();
+		assert_eq!(match_snippet(text, start, start + 6), "the needle");
+	}
+
+	#[test]
+	fn search_session_rebuilds_only_when_query_changes() {
+		let haystack = "alpha beta alpha";
+		let positions = PositionIndex::for_text(haystack);
+		let mut session = SearchSession::new();
+		let first = session.matches(haystack, &positions, "alpha", SearchOptions::FORWARD).as_ptr();
+		assert_eq!(session.find(haystack, &positions, "alpha", 6, SearchOptions::empty()), 0);
+		assert_eq!(session.matches(haystack, &positions, "alpha", SearchOptions::empty()).as_ptr(), first);
+		assert_eq!(session.matches(haystack, &positions, "beta", SearchOptions::FORWARD), &[6]);
+		assert!(session.matches(haystack, &positions, "(", SearchOptions::REGEX).is_empty());
+		assert_eq!(session.find(haystack, &positions, "(", 0, SearchOptions::REGEX | SearchOptions::FORWARD), -1);
+	}
+
 	#[test]
 	fn record_history_position_does_not_duplicate_current_position() {
 		let mut positions = vec![10, 20, 30];
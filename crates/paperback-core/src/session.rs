@@ -1,7 +1,13 @@
 use std::{
 	fs::{self, File},
 	io::{self, BufReader, Write},
+	mem,
 	path::Path,
+	sync::{
+		Arc, Mutex, PoisonError,
+		atomic::{AtomicBool, Ordering},
+	},
+	thread,
 };
 
 use base64::Engine;
@@ -9,16 +15,22 @@ use zip::ZipArchive;
 
 use crate::{
 	config::{ConfigManager, compute_document_hash},
-	document::{self, DocumentHandle, MarkerType, ParserContext, ParserFlags},
+	document::{self, DocumentChunk, DocumentHandle, MarkerType, ParserContext, ParserFlags},
+	document_cache::{self, CacheKey},
 	export::{ExportFormat, render},
+	follow::{FileFollower, FollowUpdate},
 	parser,
 	reader_core::{
-		SearchOptions, bookmark_navigate, encode_url_fragment, history_go_next, history_go_previous,
-		nearest_fragment_before, reader_container_navigate, reader_navigate, reader_search_with_wrap,
-		record_history_position, resolve_link,
+		SearchOptions, SearchSession, bookmark_navigate, encode_url_fragment, history_go_next, history_go_previous,
+		nearest_fragment_before, reader_container_navigate, reader_find_all, reader_navigate, record_history_position,
+		resolve_link,
 	},
 	types::{self as ffi, NavDirection, NavTarget},
-	util::{encoding::convert_to_utf8, zip as zip_utils},
+	util::{
+		encoding::{convert_to_utf8, convert_to_utf8_owned},
+		text::display_len,
+		zip as zip_utils,
+	},
 };
 
 const MAX_HISTORY_LEN: usize = 10;
@@ -39,6 +51,46 @@ pub struct SearchResultFfi {
 	pub position: i64,
 }
 
+#[derive(Debug, Clone)]
+pub struct FindAllHitFfi {
+	pub position: i64,
+	pub length: i64,
+	pub line_number: i64,
+	pub snippet: String,
+}
+
+impl From<ffi::SearchHit> for FindAllHitFfi {
+	fn from(hit: ffi::SearchHit) -> Self {
+		Self { position: hit.position, length: hit.length, line_number: hit.line_number, snippet: hit.snippet }
+	}
+}
+
+/// Receives the results of [`DocumentSession::find_all_ffi`] on the search's worker thread.
+pub trait FindAllListener: Send + Sync {
+	fn on_batch(&self, hits: Vec<FindAllHitFfi>);
+	fn on_complete(&self, total: i64, cancelled: bool);
+}
+
+/// A find-all search running on a worker thread.
+#[derive(Debug, Default)]
+pub struct FindAllTask {
+	cancelled: AtomicBool,
+	finished: AtomicBool,
+}
+
+impl FindAllTask {
+	/// Stops the search; no batch is delivered once the worker notices.
+	pub fn cancel(&self) {
+		self.cancelled.store(true, Ordering::Relaxed);
+	}
+
+	/// Whether the worker has delivered its completion callback.
+	#[must_use]
+	pub fn is_finished(&self) -> bool {
+		self.finished.load(Ordering::Acquire)
+	}
+}
+
 #[derive(Debug, Clone)]
 pub struct WebviewTarget {
 	pub path: String,
@@ -172,12 +224,24 @@ impl LinkActivationResult {
 }
 
 pub struct DocumentSession {
-	handle: DocumentHandle,
+	handle: Arc<DocumentHandle>,
 	file_path: String,
 	history: Vec<i64>,
 	history_index: usize,
 	parser_flags: ParserFlags,
 	last_stable_position: Option<i64>,
+	search: Mutex<SearchSession>,
+	find_all: Mutex<Option<Arc<FindAllTask>>>,
+	follow: FollowState,
+}
+
+/// Progress of following a growing text file; see [`DocumentSession::poll_follow`].
+#[derive(Default)]
+struct FollowState {
+	follower: Option<FileFollower>,
+	/// Text read while a find-all search still shared the document, appended once it finishes.
+	pending: String,
+	stopped: bool,
 }
 
 #[derive(Copy, Clone)]
@@ -297,6 +361,33 @@ impl DocumentSession {
 		password: &str,
 		forced_extension: &str,
 		render_tables_inline: bool,
+	) -> Result<Self, String> {
+		Self::open(file_path, password, forced_extension, render_tables_inline, None)
+	}
+
+	/// Like [`Self::new`], but reports each page or section to `on_chunk` while the document is being parsed so a
+	/// caller can show text before the whole document is ready. See [`parser::parse_document_streaming`]. A document
+	/// served from the [`document_cache`] arrives without any chunks.
+	///
+	/// # Errors
+	///
+	/// Returns an error if the document cannot be parsed.
+	pub fn new_streaming(
+		file_path: &str,
+		password: &str,
+		forced_extension: &str,
+		render_tables_inline: bool,
+		on_chunk: &mut dyn FnMut(DocumentChunk),
+	) -> Result<Self, String> {
+		Self::open(file_path, password, forced_extension, render_tables_inline, Some(on_chunk))
+	}
+
+	fn open(
+		file_path: &str,
+		password: &str,
+		forced_extension: &str,
+		render_tables_inline: bool,
+		on_chunk: Option<&mut dyn FnMut(DocumentChunk)>,
 	) -> Result<Self, String> {
 		let mut context = ParserContext::new(file_path.to_string());
 		if !password.is_empty() {
@@ -307,14 +398,35 @@ impl DocumentSession {
 		}
 		context = context.with_render_tables_inline(render_tables_inline);
 		let parser_flags = parser::get_parser_flags_for_context(&context);
-		let doc = parser::parse_document(&context).map_err(|e| e.to_string())?;
+		// Password-protected documents are never cached, so their decrypted text is not left on disk. Followable text
+		// is read directly: a cached copy would not record how much of the file it covers.
+		let cache_key = document_cache::global()
+			.filter(|_| password.is_empty() && !parser_flags.contains(ParserFlags::SUPPORTS_FOLLOW))
+			.and_then(|_| CacheKey::for_file(file_path, forced_extension, render_tables_inline));
+		let cached = cache_key.as_ref().and_then(|key| document_cache::global()?.load(key));
+		let doc = if let Some(doc) = cached {
+			doc
+		} else {
+			let parsed = match on_chunk {
+				Some(on_chunk) => parser::parse_document_streaming(&context, on_chunk),
+				None => parser::parse_document(&context),
+			};
+			let doc = parsed.map_err(|e| e.to_string())?;
+			if let (Some(cache), Some(key)) = (document_cache::global(), &cache_key) {
+				cache.store(key, &doc);
+			}
+			doc
+		};
 		Ok(Self {
-			handle: DocumentHandle::new(doc),
+			handle: Arc::new(DocumentHandle::new(doc)),
 			file_path: file_path.to_string(),
 			history: Vec::new(),
 			history_index: 0,
 			parser_flags,
 			last_stable_position: None,
+			search: Mutex::default(),
+			find_all: Mutex::default(),
+			follow: FollowState::default(),
 		})
 	}
 
@@ -329,10 +441,64 @@ impl DocumentSession {
 
 	/// The parsed document handle backing this session.
 	#[must_use]
-	pub const fn handle(&self) -> &DocumentHandle {
+	pub fn handle(&self) -> &DocumentHandle {
 		&self.handle
 	}
 
+	/// Whether the document is a text file that can still be followed as it grows.
+	#[must_use]
+	pub fn supports_follow(&self) -> bool {
+		!self.follow.stopped
+			&& self.parser_flags.contains(ParserFlags::SUPPORTS_FOLLOW)
+			&& self.handle.document().source_len.is_some()
+	}
+
+	/// Appends anything written to the file since it was opened or last polled, and returns the appended text so the
+	/// caller can add it to its view.
+	///
+	/// While a [`Self::find_all`] search is still reading the document, new text is held back and delivered by a
+	/// later poll. Once the file is truncated or replaced, following stops and [`FollowUpdate::Truncated`] is returned.
+	pub fn poll_follow(&mut self) -> FollowUpdate {
+		if !self.supports_follow() {
+			return FollowUpdate::Unchanged;
+		}
+		if self.follow.follower.is_none() {
+			let document = self.handle.document();
+			let offset = document.source_len.unwrap_or(0);
+			self.follow.follower = document
+				.source_encoding
+				.and_then(|encoding| FileFollower::new(self.file_path.clone().into(), offset, encoding));
+		}
+		let Some(follower) = self.follow.follower.as_mut() else {
+			self.stop_following();
+			return FollowUpdate::Unchanged;
+		};
+		// A file that briefly cannot be read, e.g. mid-rotation, is retried on the next poll.
+		match follower.poll() {
+			Ok(FollowUpdate::Appended(text)) => self.follow.pending.push_str(&text),
+			Ok(FollowUpdate::Truncated) => {
+				self.stop_following();
+				return FollowUpdate::Truncated;
+			}
+			Ok(FollowUpdate::Unchanged) | Err(_) => {}
+		}
+		if self.follow.pending.is_empty() {
+			return FollowUpdate::Unchanged;
+		}
+		let Some(handle) = Arc::get_mut(&mut self.handle) else {
+			return FollowUpdate::Unchanged;
+		};
+		let text = mem::take(&mut self.follow.pending);
+		handle.append_text(&text);
+		self.search.get_mut().unwrap_or_else(PoisonError::into_inner).invalidate();
+		FollowUpdate::Appended(text)
+	}
+
+	/// Stops following the file; the document keeps the text read so far.
+	pub fn stop_following(&mut self) {
+		self.follow = FollowState { stopped: true, ..FollowState::default() };
+	}
+
 	#[must_use]
 	pub fn file_path(&self) -> &str {
 		&self.file_path
@@ -354,7 +520,7 @@ impl DocumentSession {
 	}
 
 	#[must_use]
-	pub const fn stats(&self) -> &document::DocumentStats {
+	pub fn stats(&self) -> &document::DocumentStats {
 		&self.handle.document().stats
 	}
 
@@ -598,7 +764,7 @@ impl DocumentSession {
 		config: &ConfigManager,
 		position: i64,
 	) -> ffi::BookmarkDisplayAtPosition {
-		let bookmark = config.get_bookmarks(&self.file_path).into_iter().find(|bm| bm.start == position);
+		let bookmark = config.with_bookmark_index(&self.file_path, |index| index.starting_at(position).next().cloned());
 		let Some(bookmark) = bookmark else {
 			return ffi::BookmarkDisplayAtPosition { found: false, note: String::new(), snippet: String::new() };
 		};
@@ -610,23 +776,18 @@ impl DocumentSession {
 		ffi::BookmarkDisplayAtPosition { found: true, note: bookmark.note, snippet }
 	}
 
+	/// Links for the Elements dialog, along with the last one at or before `position`.
 	#[must_use]
 	pub fn link_list(&self, position: i64) -> ffi::LinkList {
+		let buffer = &self.handle.document().buffer;
+		let elements = self.handle.elements();
 		let pos = usize::try_from(position.max(0)).unwrap_or(0);
-		let mut closest_index = -1;
-		let mut items = Vec::new();
-		for marker in self.handle.document().buffer.markers.iter().filter(|marker| marker.mtype == MarkerType::Link) {
-			let text = if marker.text.is_empty() {
-				self.get_line_text(i64::try_from(marker.position).unwrap_or(0))
-			} else {
-				marker.text.clone()
-			};
-			if marker.position <= pos {
-				closest_index = i32::try_from(items.len()).unwrap_or(-1);
-			}
-			items.push(ffi::LinkListItem { offset: marker.position, text });
-		}
-		ffi::LinkList { items, closest_index }
+		let items = elements
+			.links()
+			.iter()
+			.map(|link| ffi::LinkListItem { offset: link.offset, text: link.label(buffer).to_string() })
+			.collect();
+		ffi::LinkList { items, closest_index: list_index(elements.closest_link(pos)) }
 	}
 
 	#[must_use]
@@ -648,69 +809,58 @@ impl DocumentSession {
 			.collect()
 	}
 
+	/// Headings for the Elements dialog with their parents, along with the nearest one at or before `position`.
 	#[must_use]
 	pub fn heading_tree(&self, position: i64) -> ffi::HeadingTree {
+		let buffer = &self.handle.document().buffer;
+		let elements = self.handle.elements();
 		let pos = usize::try_from(position.max(0)).unwrap_or(0);
-		let mut items = Vec::new();
-		let mut closest_index = -1;
-		let mut min_distance = usize::MAX;
-		let markers = &self.handle.document().buffer.markers;
-		let mut item_stack: Vec<(i32, i32)> = Vec::new(); // (level, index)
-		for marker in markers {
-			if !document::is_heading_marker(marker.mtype) {
-				continue;
-			}
-			let level = marker.level;
-			while item_stack.last().is_some_and(|(l, _)| *l >= level) {
-				item_stack.pop();
-			}
-			let parent_index = item_stack.last().map_or(-1, |(_, idx)| *idx);
-			let current_index = i32::try_from(items.len()).unwrap_or(-1);
-			let text = if marker.text.is_empty() {
-				self.get_line_text(i64::try_from(marker.position).unwrap_or(0))
-			} else {
-				marker.text.clone()
-			};
-			items.push(ffi::HeadingTreeItem { offset: marker.position, text, parent_index });
-			item_stack.push((level, current_index));
-			if marker.position <= pos {
-				let dist = pos - marker.position;
-				if dist < min_distance {
-					min_distance = dist;
-					closest_index = current_index;
-				}
-			}
-		}
-		ffi::HeadingTree { items, closest_index }
+		let items = elements
+			.headings()
+			.iter()
+			.map(|heading| ffi::HeadingTreeItem {
+				offset: heading.offset,
+				text: heading.label(buffer).to_string(),
+				parent_index: list_index(heading.parent),
+			})
+			.collect();
+		ffi::HeadingTree { items, closest_index: list_index(elements.closest_heading(pos)) }
 	}
 
 	#[must_use]
 	pub fn get_heading_tree_ffi(&self, position: i64) -> HeadingTreeFfi {
-		let tree = self.heading_tree(position);
+		let buffer = &self.handle.document().buffer;
+		let elements = self.handle.elements();
+		let pos = usize::try_from(position.max(0)).unwrap_or(0);
 		HeadingTreeFfi {
-			items: tree
-				.items
-				.into_iter()
-				.map(|i| HeadingTreeItemFfi {
-					offset: i64::try_from(i.offset).unwrap_or(i64::MAX),
-					text: i.text,
-					parent_index: i.parent_index,
+			items: elements
+				.headings()
+				.iter()
+				.map(|heading| HeadingTreeItemFfi {
+					offset: i64::try_from(heading.offset).unwrap_or(i64::MAX),
+					text: heading.label(buffer).to_string(),
+					parent_index: list_index(heading.parent),
 				})
 				.collect(),
-			closest_index: tree.closest_index,
+			closest_index: list_index(elements.closest_heading(pos)),
 		}
 	}
 
 	#[must_use]
 	pub fn get_link_list_ffi(&self, position: i64) -> LinkListFfi {
-		let list = self.link_list(position);
+		let buffer = &self.handle.document().buffer;
+		let elements = self.handle.elements();
+		let pos = usize::try_from(position.max(0)).unwrap_or(0);
 		LinkListFfi {
-			items: list
-				.items
-				.into_iter()
-				.map(|i| LinkListItemFfi { offset: i64::try_from(i.offset).unwrap_or(i64::MAX), text: i.text })
+			items: elements
+				.links()
+				.iter()
+				.map(|link| LinkListItemFfi {
+					offset: i64::try_from(link.offset).unwrap_or(i64::MAX),
+					text: link.label(buffer).to_string(),
+				})
 				.collect(),
-			closest_index: list.closest_index,
+			closest_index: list_index(elements.closest_link(pos)),
 		}
 	}
 
@@ -858,8 +1008,73 @@ impl DocumentSession {
 		supported
 	}
 
+	/// Finds `query` from display-unit `start_position`, wrapping around the document once.
+	///
+	/// Matches are indexed on the first search for a query, so repeated find-next/previous with the
+	/// same query and options is a binary search.
 	#[must_use]
-	pub fn search_ffi(&self, query: String, start_position: i64, options: SearchOptionsFfi) -> SearchResultFfi {
+	pub fn search(&self, query: &str, start_position: i64, options: SearchOptions) -> ffi::SearchResult {
+		let buf = &self.handle.document().buffer;
+		self.search.lock().unwrap_or_else(PoisonError::into_inner).find_with_wrap(
+			&buf.content,
+			buf.positions(),
+			query,
+			start_position,
+			options,
+		)
+	}
+
+	/// Starts a search for every match of `query` on a worker thread.
+	///
+	/// Hits arrive at `on_batch` in document order, then `on_complete` receives the total and whether
+	/// the search was cancelled (the total is 0 in that case). Starting another find-all, or dropping
+	/// the session, cancels the previous search.
+	pub fn find_all(
+		&self,
+		query: &str,
+		options: SearchOptions,
+		on_batch: impl FnMut(Vec<ffi::SearchHit>) + Send + 'static,
+		on_complete: impl FnOnce(usize, bool) + Send + 'static,
+	) -> Arc<FindAllTask> {
+		let task = Arc::new(FindAllTask::default());
+		let previous = self.find_all.lock().unwrap_or_else(PoisonError::into_inner).replace(Arc::clone(&task));
+		if let Some(previous) = previous {
+			previous.cancel();
+		}
+		let regex = if query.is_empty() {
+			None
+		} else {
+			self.search.lock().unwrap_or_else(PoisonError::into_inner).regex(query, options).cloned()
+		};
+		let handle = Arc::clone(&self.handle);
+		let worker_task = Arc::clone(&task);
+		thread::spawn(move || {
+			let total = regex.map_or(Some(0), |re| {
+				reader_find_all(&handle.document().buffer, &re, &worker_task.cancelled, on_batch)
+			});
+			on_complete(total.unwrap_or(0), total.is_none());
+			worker_task.finished.store(true, Ordering::Release);
+		});
+		task
+	}
+
+	pub fn find_all_ffi(
+		&self,
+		query: String,
+		options: SearchOptionsFfi,
+		listener: Box<dyn FindAllListener>,
+	) -> Arc<FindAllTask> {
+		let listener: Arc<dyn FindAllListener> = Arc::from(listener);
+		let batch_listener = Arc::clone(&listener);
+		self.find_all(
+			&query,
+			Self::search_options(options),
+			move |hits| batch_listener.on_batch(hits.into_iter().map(FindAllHitFfi::from).collect()),
+			move |total, cancelled| listener.on_complete(i64::try_from(total).unwrap_or(i64::MAX), cancelled),
+		)
+	}
+
+	fn search_options(options: SearchOptionsFfi) -> SearchOptions {
 		let mut search_options = SearchOptions::empty();
 		if options.match_case {
 			search_options.insert(SearchOptions::MATCH_CASE);
@@ -873,9 +1088,12 @@ impl DocumentSession {
 		if options.forward {
 			search_options.insert(SearchOptions::FORWARD);
 		}
+		search_options
+	}
 
-		let result =
-			reader_search_with_wrap(&self.handle.document().buffer.content, &query, start_position, search_options);
+	#[must_use]
+	pub fn search_ffi(&self, query: String, start_position: i64, options: SearchOptionsFfi) -> SearchResultFfi {
+		let result = self.search(&query, start_position, Self::search_options(options));
 		SearchResultFfi { found: result.found, wrapped: result.wrapped, position: result.position }
 	}
 
@@ -984,7 +1202,7 @@ impl DocumentSession {
 		let section_index = self.handle.current_marker_index(pos, MarkerType::SectionBreak)?;
 		let section_start = self.handle.document().buffer.markers.get(section_index)?.position;
 		let relative = pos.checked_sub(section_start)?;
-		let content = convert_to_utf8(&fs::read(file_path).ok()?);
+		let content = convert_to_utf8_owned(fs::read(file_path).ok()?);
 		let injected = parser::xml_to_text::inject_anchor_at_position(&content, relative, READING_POS_ANCHOR_ID)?;
 		fs::write(file_path, injected.as_bytes()).ok()?;
 		Some(READING_POS_ANCHOR_ID.to_string())
@@ -1046,7 +1264,7 @@ impl DocumentSession {
 		}
 		let ext = Path::new(&self.file_path).extension().map(|ext| ext.to_string_lossy().to_ascii_lowercase());
 		let name = Path::new(&self.file_path).file_name()?.to_string_lossy().to_string();
-		let content = convert_to_utf8(&fs::read(&self.file_path).ok()?);
+		let content = convert_to_utf8_owned(fs::read(&self.file_path).ok()?);
 		let caret = match ext.as_deref() {
 			Some("html" | "htm" | "xhtml") => Self::xml_caret(&content, pos),
 			Some("md" | "markdown") => self.markdown_caret(&content, pos),
@@ -1135,21 +1353,16 @@ impl DocumentSession {
 				let mut end_pos = offset;
 
 				if text.trim().is_empty() {
-					let content = &self.handle.document().buffer.content;
-					let total_chars = self.handle.document().buffer.char_count();
-					let start_pos_char = usize::try_from(offset.max(0)).unwrap_or(0).min(total_chars);
-					let byte_idx = self.handle.document().buffer.byte_index_for_char(start_pos_char);
+					let buf = &self.handle.document().buffer;
+					let byte_idx = buf.byte_index_for_display(usize::try_from(offset.max(0)).unwrap_or(0));
 
 					let (start_byte, end_byte) =
-						self.find_paragraph_boundaries(content, byte_idx, SegmentDirectionFfi::Current);
-					text = content[start_byte..end_byte].trim().to_string();
-					let start_char = self.handle.document().buffer.char_index_for_byte(start_byte) as i64;
-					let end_char = self.handle.document().buffer.char_index_for_byte(end_byte) as i64;
-
-					offset = start_char;
-					end_pos = end_char;
+						self.find_paragraph_boundaries(&buf.content, byte_idx, SegmentDirectionFfi::Current);
+					text = buf.content[start_byte..end_byte].trim().to_string();
+					offset = i64::try_from(buf.display_index_for_byte(start_byte)).unwrap_or(0);
+					end_pos = i64::try_from(buf.display_index_for_byte(end_byte)).unwrap_or(0);
 				} else {
-					end_pos += i64::try_from(text.chars().count()).unwrap_or(0);
+					end_pos += i64::try_from(display_len(&text)).unwrap_or(0);
 				}
 
 				return TextSegmentFfi { text, start_pos: offset, end_pos };
@@ -1157,34 +1370,28 @@ impl DocumentSession {
 			return TextSegmentFfi { text: String::new(), start_pos: position, end_pos: position };
 		}
 
-		let content = &self.handle.document().buffer.content;
-		let total_chars = self.handle.document().buffer.char_count();
-		let start_pos_char = usize::try_from(position.max(0)).unwrap_or(0).min(total_chars);
-		let byte_idx = self.handle.document().buffer.byte_index_for_char(start_pos_char);
+		let buf = &self.handle.document().buffer;
+		let content = &buf.content;
+		let byte_idx = buf.byte_index_for_display(usize::try_from(position.max(0)).unwrap_or(0));
 
 		let (start_byte, end_byte) = if matches!(segment_type, SegmentTypeFfi::Line) {
-			let line_num = self.line_from_position(start_pos_char as i64);
+			let line_num = self.line_from_position(position);
 			let target_line = match direction {
 				SegmentDirectionFfi::Previous => (line_num - 1).max(1),
 				SegmentDirectionFfi::Next => line_num + 1,
 				SegmentDirectionFfi::Current => line_num,
 			};
-			let start_char_idx = usize::try_from(self.position_from_line(target_line)).unwrap_or(0);
-			let end_char_idx = usize::try_from(self.position_from_line(target_line + 1)).unwrap_or(0);
-
-			let sb = self.handle.document().buffer.byte_index_for_char(start_char_idx);
-			let eb = self.handle.document().buffer.byte_index_for_char(end_char_idx);
-			(sb, eb)
+			let start_idx = usize::try_from(self.position_from_line(target_line)).unwrap_or(0);
+			let end_idx = usize::try_from(self.position_from_line(target_line + 1)).unwrap_or(0);
+			(buf.byte_index_for_display(start_idx), buf.byte_index_for_display(end_idx))
 		} else {
 			self.find_paragraph_boundaries(content, byte_idx, direction)
 		};
 		let text = content[start_byte..end_byte].trim().to_string();
-		let start_char = self.handle.document().buffer.char_index_for_byte(start_byte);
-		let end_char = self.handle.document().buffer.char_index_for_byte(end_byte);
 		TextSegmentFfi {
 			text,
-			start_pos: i64::try_from(start_char).unwrap_or(0),
-			end_pos: i64::try_from(end_char).unwrap_or(0),
+			start_pos: i64::try_from(buf.display_index_for_byte(start_byte)).unwrap_or(0),
+			end_pos: i64::try_from(buf.display_index_for_byte(end_byte)).unwrap_or(0),
 		}
 	}
 
@@ -1263,17 +1470,16 @@ impl DocumentSession {
 		let target_newlines = usize::try_from(line - 1).unwrap_or(0);
 		let newlines = buf.newline_positions();
 		if target_newlines <= newlines.len() {
-			i64::try_from(newlines[target_newlines - 1] + 1).unwrap_or(0)
+			i64::try_from(buf.display_index_for_char(newlines[target_newlines - 1] + 1)).unwrap_or(0)
 		} else {
-			i64::try_from(buf.char_count()).unwrap_or(0)
+			i64::try_from(buf.current_position()).unwrap_or(0)
 		}
 	}
 
 	#[must_use]
 	pub fn line_from_position(&self, position: i64) -> i64 {
 		let buf = &self.handle.document().buffer;
-		let total_chars = buf.char_count();
-		let pos = usize::try_from(position.max(0)).unwrap_or(0).min(total_chars);
+		let pos = buf.char_index_for_display(usize::try_from(position.max(0)).unwrap_or(0));
 		let line_number = buf.newline_positions().partition_point(|&p| p < pos) + 1;
 		i64::try_from(line_number).unwrap_or(1)
 	}
@@ -1303,34 +1509,19 @@ impl DocumentSession {
 	/// Returns the text between two positions (start inclusive, end exclusive).
 	#[must_use]
 	pub fn get_text_range(&self, start: i64, end: i64) -> String {
-		let total_chars = self.handle.document().buffer.char_count();
-		let start_pos = usize::try_from(start.max(0)).unwrap_or(0).min(total_chars);
-		let end_pos = usize::try_from(end.max(0)).unwrap_or(0).min(total_chars);
-		if start_pos >= end_pos {
+		let buf = &self.handle.document().buffer;
+		let start_byte = buf.byte_index_for_display(usize::try_from(start.max(0)).unwrap_or(0));
+		let end_byte = buf.byte_index_for_display(usize::try_from(end.max(0)).unwrap_or(0));
+		if start_byte >= end_byte {
 			return String::new();
 		}
-
-		let start_byte = self.handle.document().buffer.byte_index_for_char(start_pos);
-		let end_byte = self.handle.document().buffer.byte_index_for_char(end_pos);
-
-		self.handle.document().buffer.content[start_byte..end_byte].to_string()
+		buf.content[start_byte..end_byte].to_string()
 	}
 
 	#[must_use]
 	pub fn get_line_text(&self, position: i64) -> String {
 		let buf = &self.handle.document().buffer;
-		let total_chars = buf.char_count();
-		let pos = usize::try_from(position.max(0)).unwrap_or(0).min(total_chars);
-		let newlines = buf.newline_positions();
-		let line_start = match newlines.partition_point(|&p| p < pos) {
-			0 => 0,
-			idx => newlines[idx - 1] + 1,
-		};
-
-		let start_byte = buf.byte_index_for_char(line_start);
-		let line_end_byte = buf.content[start_byte..].find('\n').map_or(buf.content.len(), |i| start_byte + i);
-
-		buf.content[start_byte..line_end_byte].to_string()
+		buf.content[buf.line_byte_range(usize::try_from(position.max(0)).unwrap_or(0))].to_string()
 	}
 
 	#[must_use]
@@ -1399,6 +1590,19 @@ impl DocumentSession {
 	}
 }
 
+impl Drop for DocumentSession {
+	fn drop(&mut self) {
+		if let Some(task) = self.find_all.get_mut().unwrap_or_else(PoisonError::into_inner).take() {
+			task.cancel();
+		}
+	}
+}
+
+/// An index into a list handed to the UI, or -1 for none.
+fn list_index(index: Option<usize>) -> i32 {
+	index.and_then(|i| i32::try_from(i).ok()).unwrap_or(-1)
+}
+
 #[cfg(test)]
 mod tests {
 	use super::*;
@@ -1427,12 +1631,15 @@ mod tests {
 		let mut doc = Document::new().with_title("Title".to_string()).with_author("Author".to_string());
 		doc.set_buffer(buffer);
 		DocumentSession {
-			handle: DocumentHandle::new(doc),
+			handle: Arc::new(DocumentHandle::new(doc)),
 			file_path: "book.epub".to_string(),
 			history: Vec::new(),
 			history_index: 0,
 			parser_flags,
 			last_stable_position: None,
+			search: Mutex::default(),
+			find_all: Mutex::default(),
+			follow: FollowState::default(),
 		}
 	}
 
@@ -1560,6 +1767,99 @@ mod tests {
 		assert_eq!(session.get_line_text(999), "line3");
 	}
 
+	#[test]
+	fn find_all_streams_hits_from_a_worker_thread() {
+		let session = sample_session(ParserFlags::NONE);
+		let (tx, rx) = std::sync::mpsc::channel();
+		let batch_tx = tx.clone();
+		let task = session.find_all(
+			"line",
+			SearchOptions::empty(),
+			move |hits| {
+				batch_tx.send(Ok(hits)).unwrap();
+			},
+			move |total, cancelled| {
+				tx.send(Err((total, cancelled))).unwrap();
+			},
+		);
+		let mut hits = Vec::new();
+		let summary = loop {
+			match rx.recv_timeout(std::time::Duration::from_secs(5)).expect("find-all should finish") {
+				Ok(batch) => hits.extend(batch),
+				Err(summary) => break summary,
+			}
+		};
+		assert_eq!(summary, (3, false));
+		assert_eq!(hits.iter().map(|h| (h.position, h.line_number)).collect::<Vec<_>>(), [(0, 1), (6, 2), (12, 3)]);
+		while !task.is_finished() {
+			std::thread::yield_now();
+		}
+	}
+
+	#[test]
+	fn find_all_with_an_invalid_regex_completes_empty() {
+		let session = sample_session(ParserFlags::NONE);
+		let (tx, rx) = std::sync::mpsc::channel();
+		let _task = session.find_all(
+			"(",
+			SearchOptions::REGEX,
+			|_| panic!("no hits expected"),
+			move |total, cancelled| {
+				tx.send((total, cancelled)).unwrap();
+			},
+		);
+		assert_eq!(rx.recv_timeout(std::time::Duration::from_secs(5)).unwrap(), (0, false));
+	}
+
+	#[test]
+	fn following_a_text_file_appends_new_lines() {
+		let nanos = std::time::SystemTime::now().duration_since(std::time::UNIX_EPOCH).unwrap().as_nanos();
+		let path = std::env::temp_dir().join(format!("paperback_session_follow_{nanos}.log"));
+		fs::write(&path, "started\n").unwrap();
+		let mut session = DocumentSession::new(path.to_str().unwrap(), "", "", false).unwrap();
+		assert!(session.supports_follow());
+		assert_eq!(session.poll_follow(), FollowUpdate::Unchanged);
+		fs::OpenOptions::new().append(true).open(&path).unwrap().write_all(b"request served\n").unwrap();
+		assert_eq!(session.poll_follow(), FollowUpdate::Appended("request served\n".to_string()));
+		assert_eq!(session.handle().document().buffer.content, "started\nrequest served\n");
+		assert_eq!(session.handle().document().stats.line_count, 2);
+		fs::write(&path, "").unwrap();
+		assert_eq!(session.poll_follow(), FollowUpdate::Truncated);
+		assert!(!session.supports_follow());
+		fs::remove_file(path).unwrap();
+	}
+
+	#[test]
+	fn text_helpers_and_search_use_display_positions() {
+		let mut doc = Document::new();
+		doc.set_buffer(DocumentBuffer::with_content("😀 café\nnaïve 😀 end".to_string()));
+		let session = DocumentSession {
+			handle: Arc::new(DocumentHandle::new(doc)),
+			file_path: "notes.txt".to_string(),
+			history: Vec::new(),
+			history_index: 0,
+			parser_flags: ParserFlags::NONE,
+			last_stable_position: None,
+			search: Mutex::default(),
+			find_all: Mutex::default(),
+			follow: FollowState::default(),
+		};
+		let second_line = i64::try_from(display_len("😀 café\n")).unwrap();
+		assert_eq!(session.position_from_line(2), second_line);
+		assert_eq!(session.line_from_position(second_line), 2);
+		assert_eq!(session.get_line_text(second_line), "naïve 😀 end");
+		let emoji = second_line + i64::try_from(display_len("naïve ")).unwrap();
+		let after_emoji = emoji + i64::try_from(display_len("😀")).unwrap();
+		assert_eq!(session.get_text_range(emoji, after_emoji), "😀");
+		let options = SearchOptionsFfi { forward: true, match_case: false, whole_word: false, regex: false };
+		let result = session.search_ffi("end".to_string(), emoji, options);
+		assert!(result.found);
+		assert_eq!(session.get_text_range(result.position, result.position + 3), "end");
+		let segment = session.get_text_segment(emoji, SegmentTypeFfi::Line, SegmentDirectionFfi::Current);
+		assert_eq!(segment.text, "naïve 😀 end");
+		assert_eq!(segment.start_pos, second_line);
+	}
+
 	#[test]
 	fn has_headings_checks_specific_and_any_levels() {
 		let session = sample_session(ParserFlags::NONE);
@@ -1579,12 +1879,15 @@ mod tests {
 		let mut doc = Document::new().with_title("Title".to_string()).with_author("Author".to_string());
 		doc.set_buffer(buffer);
 		let session = DocumentSession {
-			handle: DocumentHandle::new(doc),
+			handle: Arc::new(DocumentHandle::new(doc)),
 			file_path: "book.epub".to_string(),
 			history: Vec::new(),
 			history_index: 0,
 			parser_flags: ParserFlags::NONE,
 			last_stable_position: None,
+			search: Mutex::default(),
+			find_all: Mutex::default(),
+			follow: FollowState::default(),
 		};
 
 		let markers = session.get_formatting_markers();
@@ -1645,12 +1948,15 @@ mod tests {
 		let mut doc = Document::new();
 		doc.set_buffer(buffer);
 		let session = DocumentSession {
-			handle: DocumentHandle::new(doc),
+			handle: Arc::new(DocumentHandle::new(doc)),
 			file_path: "book.epub".to_string(),
 			history: Vec::new(),
 			history_index: 0,
 			parser_flags: ParserFlags::NONE,
 			last_stable_position: None,
+			search: Mutex::default(),
+			find_all: Mutex::default(),
+			follow: FollowState::default(),
 		};
 		let tree = session.heading_tree(3);
 		assert_eq!(tree.items.len(), 3);
@@ -1688,6 +1994,9 @@ mod tests {
 			history_index: 0,
 			parser_flags: ParserFlags::NONE,
 			last_stable_position: None,
+			search: Mutex::default(),
+			find_all: Mutex::default(),
+			follow: FollowState::default(),
 		};
 		assert!(session.webview_target_path(0, "C:\\temp").is_none());
 	}
@@ -1707,6 +2016,9 @@ mod tests {
 			history_index: 0,
 			parser_flags: ParserFlags::NONE,
 			last_stable_position: None,
+			search: Mutex::default(),
+			find_all: Mutex::default(),
+			follow: FollowState::default(),
 		};
 		assert_eq!(session.extract_resource("anything", "out.file").ok(), Some(false));
 	}
@@ -1719,6 +2031,9 @@ mod tests {
 			history_index: 0,
 			parser_flags: ParserFlags::NONE,
 			last_stable_position: None,
+			search: Mutex::default(),
+			find_all: Mutex::default(),
+			follow: FollowState::default(),
 		}
 	}
 
@@ -1869,12 +2184,15 @@ mod tests {
 		let mut doc = Document::new();
 		doc.set_buffer(buffer);
 		let session = DocumentSession {
-			handle: DocumentHandle::new(doc),
+			handle: Arc::new(DocumentHandle::new(doc)),
 			file_path: "book.epub".to_string(),
 			history: Vec::new(),
 			history_index: 0,
 			parser_flags: ParserFlags::NONE,
 			last_stable_position: None,
+			search: Mutex::default(),
+			find_all: Mutex::default(),
+			follow: FollowState::default(),
 		};
 		assert!(session.get_current_section_path(0).is_none());
 	}
@@ -1888,6 +2206,9 @@ mod tests {
 			history_index: 0,
 			parser_flags: ParserFlags::NONE,
 			last_stable_position: None,
+			search: Mutex::default(),
+			find_all: Mutex::default(),
+			follow: FollowState::default(),
 		};
 		assert!(session.extract_resource("x", "y").is_err());
 	}
@@ -1909,12 +2230,15 @@ mod tests {
 		doc.set_buffer(buffer);
 		doc.compute_stats();
 		DocumentSession {
-			handle: DocumentHandle::new(doc),
+			handle: Arc::new(DocumentHandle::new(doc)),
 			file_path: "book.epub".to_string(),
 			history: Vec::new(),
 			history_index: 0,
 			parser_flags: ParserFlags::NONE,
 			last_stable_position: None,
+			search: Mutex::default(),
+			find_all: Mutex::default(),
+			follow: FollowState::default(),
 		}
 	}
 
@@ -1946,12 +2270,15 @@ mod tests {
 		doc.set_buffer(buffer);
 		doc.compute_stats();
 		let session = DocumentSession {
-			handle: DocumentHandle::new(doc),
+			handle: Arc::new(DocumentHandle::new(doc)),
 			file_path: "book.epub".to_string(),
 			history: Vec::new(),
 			history_index: 0,
 			parser_flags: ParserFlags::NONE,
 			last_stable_position: None,
+			search: Mutex::default(),
+			find_all: Mutex::default(),
+			follow: FollowState::default(),
 		};
 		// Position 5 is within [0, 6) by display length but would be outside [0, 1) by char count.
 		assert_eq!(session.get_table_at_position(5).as_deref(), Some("<table/>"));
@@ -1965,12 +2292,15 @@ mod tests {
 		let mut doc = Document::new();
 		doc.set_buffer(buffer);
 		let session = DocumentSession {
-			handle: DocumentHandle::new(doc),
+			handle: Arc::new(DocumentHandle::new(doc)),
 			file_path: "book.epub".to_string(),
 			history: Vec::new(),
 			history_index: 0,
 			parser_flags: ParserFlags::NONE,
 			last_stable_position: None,
+			search: Mutex::default(),
+			find_all: Mutex::default(),
+			follow: FollowState::default(),
 		};
 		let result = session.activate_link(7);
 		assert!(!result.found);
@@ -105,6 +105,14 @@ pub struct SearchResult {
 	pub position: i64,
 }
 
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct SearchHit {
+	pub position: i64,
+	pub length: i64,
+	pub line_number: i64,
+	pub snippet: String,
+}
+
 #[derive(Debug, Clone, Copy, PartialEq, Eq)]
 pub enum BookmarkFilterType {
 	All,
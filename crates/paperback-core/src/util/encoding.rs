@@ -1,59 +1,119 @@
-use std::str;
+use std::{borrow::Cow, str};
 
-use encoding_rs::{UTF_16BE, UTF_16LE, WINDOWS_1252};
+use encoding_rs::{Decoder, Encoding, UTF_8, UTF_16BE, UTF_16LE, WINDOWS_1252};
 
+/// Decodes `input` to UTF-8, sniffing BOMs, BOM-less UTF-16 and Windows-1252. Input that is already valid UTF-8 is
+/// borrowed rather than copied.
 #[must_use]
-pub fn convert_to_utf8(input: &[u8]) -> String {
+pub fn convert_to_utf8(input: &[u8]) -> Cow<'_, str> {
+	decode_detecting(input).0
+}
+
+/// [`convert_to_utf8`], also returning the encoding the input was decoded as: `None` for UTF-32, which `encoding_rs`
+/// has no decoder for.
+fn decode_detecting(input: &[u8]) -> (Cow<'_, str>, Option<&'static Encoding>) {
 	if input.len() >= 4 {
 		// UTF-32 LE BOM
 		if input[0] == 0xFF && input[1] == 0xFE && input[2] == 0x00 && input[3] == 0x00 {
-			return decode_utf32_le(&input[4..]);
+			return (Cow::Owned(decode_utf32_le(&input[4..])), None);
 		}
 		// UTF-32 BE BOM
 		if input[0] == 0x00 && input[1] == 0x00 && input[2] == 0xFE && input[3] == 0xFF {
-			return decode_utf32_be(&input[4..]);
+			return (Cow::Owned(decode_utf32_be(&input[4..])), None);
 		}
 	}
 	if input.len() >= 3 {
 		// UTF-8 BOM
 		if input[0] == 0xEF && input[1] == 0xBB && input[2] == 0xBF {
-			return String::from_utf8_lossy(&input[3..]).to_string();
+			return (String::from_utf8_lossy(&input[3..]), Some(UTF_8));
 		}
 	}
 	if input.len() >= 2 {
 		// UTF-16 LE BOM
 		if input[0] == 0xFF && input[1] == 0xFE {
 			let (decoded, _, _) = UTF_16LE.decode(&input[2..]);
-			return decoded.to_string();
+			return (Cow::Owned(decoded.into_owned()), Some(UTF_16LE));
 		}
 		// UTF-16 BE BOM
 		if input[0] == 0xFE && input[1] == 0xFF {
 			let (decoded, _, _) = UTF_16BE.decode(&input[2..]);
-			return decoded.to_string();
+			return (Cow::Owned(decoded.into_owned()), Some(UTF_16BE));
 		}
 	}
 	// UTF-8 without BOM
 	if let Ok(s) = str::from_utf8(input) {
-		return s.to_string();
+		return (Cow::Borrowed(s), Some(UTF_8));
 	}
 	// UTF-16 without BOM (only if data looks like UTF-16)
 	if looks_like_utf16(input) {
 		let (decoded, encoding, had_errors) = UTF_16LE.decode(input);
 		if !had_errors && encoding == UTF_16LE {
-			return decoded.to_string();
+			return (Cow::Owned(decoded.into_owned()), Some(UTF_16LE));
 		}
 		let (decoded, encoding, had_errors) = UTF_16BE.decode(input);
 		if !had_errors && encoding == UTF_16BE {
-			return decoded.to_string();
+			return (Cow::Owned(decoded.into_owned()), Some(UTF_16BE));
 		}
 	}
 	// Windows-1252
 	let (decoded, _, _) = WINDOWS_1252.decode(input);
 	if decoded.chars().any(|c| !c.is_control() || c.is_whitespace()) {
-		return decoded.to_string();
+		return (Cow::Owned(decoded.into_owned()), Some(WINDOWS_1252));
 	}
 	// Give up
-	String::from_utf8_lossy(input).to_string()
+	(String::from_utf8_lossy(input), Some(UTF_8))
+}
+
+/// Like [`convert_to_utf8`], but takes ownership so that valid UTF-8 input becomes the returned string in place
+/// instead of being copied.
+#[must_use]
+pub fn convert_to_utf8_owned(input: Vec<u8>) -> String {
+	convert_to_utf8_owned_detecting(input).0
+}
+
+/// [`convert_to_utf8_owned`], also returning the encoding the input was decoded as, so that bytes appended to the same
+/// file later can be decoded the same way. The encoding is `None` for UTF-32, which `encoding_rs` has no decoder for.
+#[must_use]
+pub fn convert_to_utf8_owned_detecting(mut input: Vec<u8>) -> (String, Option<&'static Encoding>) {
+	if input.starts_with(&[0xEF, 0xBB, 0xBF]) {
+		input.drain(..3);
+		let text = String::from_utf8(input).unwrap_or_else(|err| String::from_utf8_lossy(err.as_bytes()).into_owned());
+		return (text, Some(UTF_8));
+	}
+	// The UTF-16 and UTF-32 BOMs contain 0xFE or 0xFF, which never occur in valid UTF-8, so input that decodes here
+	// could not have been read any other way.
+	match String::from_utf8(input) {
+		Ok(text) => (text, Some(UTF_8)),
+		Err(err) => {
+			let (text, encoding) = decode_detecting(err.as_bytes());
+			(text.into_owned(), encoding)
+		}
+	}
+}
+
+/// Picks an incremental decoder for a file whose first block is `head`, mirroring the choices [`convert_to_utf8`]
+/// makes for a whole file: UTF-8 and UTF-16 BOMs are honoured, BOM-less UTF-8 is decoded as UTF-8, and anything else
+/// as Windows-1252. Returns `None` for UTF-32 and BOM-less UTF-16, which have to be decoded as a whole.
+///
+/// Only `head` is checked, so a BOM-less UTF-8 decoder agrees with [`convert_to_utf8`] only as long as it meets no
+/// malformed sequence; after one, the whole file would have been decoded as Windows-1252.
+#[must_use]
+pub fn streaming_decoder(head: &[u8]) -> Option<Decoder> {
+	if head.starts_with(&[0xFF, 0xFE, 0x00, 0x00]) || head.starts_with(&[0x00, 0x00, 0xFE, 0xFF]) {
+		return None;
+	}
+	if head.starts_with(&[0xEF, 0xBB, 0xBF]) || head.starts_with(&[0xFF, 0xFE]) || head.starts_with(&[0xFE, 0xFF]) {
+		// encoding_rs decoders sniff and strip these BOMs themselves.
+		return Some(UTF_8.new_decoder());
+	}
+	// A block boundary can split the last character, which is not an error.
+	if str::from_utf8(head).map_or_else(|err| err.error_len().is_none(), |_| true) {
+		return Some(UTF_8.new_decoder());
+	}
+	if looks_like_utf16(head) {
+		return None;
+	}
+	Some(WINDOWS_1252.new_decoder())
 }
 
 fn decode_utf32_le(input: &[u8]) -> String {
@@ -115,6 +175,39 @@ mod tests {
 	#[case(b"", "")]
 	fn test_convert_to_utf8_known_inputs(#[case] input: &[u8], #[case] expected: &str) {
 		assert_eq!(convert_to_utf8(input), expected);
+		assert_eq!(convert_to_utf8_owned(input.to_vec()), expected);
+	}
+
+	#[test]
+	fn test_valid_utf8_is_not_copied() {
+		assert!(matches!(convert_to_utf8("plain café".as_bytes()), Cow::Borrowed("plain café")));
+		let bytes = b"\xEF\xBB\xBFwith bom".to_vec();
+		let ptr = bytes.as_ptr();
+		let owned = convert_to_utf8_owned(bytes);
+		assert_eq!(owned, "with bom");
+		assert_eq!(owned.as_ptr(), ptr);
+	}
+
+	#[rstest]
+	#[case(b"caf\xE9")]
+	#[case(b"H\x00i\x00")]
+	#[case(b"\xEF\xBB\xBFbad \xFF tail")]
+	#[case(b"\x81\x8D")]
+	fn test_owned_conversion_matches_borrowed_for_invalid_utf8(#[case] input: &[u8]) {
+		assert_eq!(convert_to_utf8_owned(input.to_vec()), convert_to_utf8(input));
+	}
+
+	#[rstest]
+	#[case(b"plain", Some(UTF_8))]
+	#[case(b"\xEF\xBB\xBFwith bom", Some(UTF_8))]
+	#[case(b"caf\xE9", Some(WINDOWS_1252))]
+	#[case(b"\xFF\xFEa\x00", Some(UTF_16LE))]
+	#[case(b"\xFF\xFE\x00\x00A\x00\x00\x00", None)]
+	fn test_owned_conversion_reports_the_encoding_used(
+		#[case] input: &[u8],
+		#[case] expected: Option<&'static Encoding>,
+	) {
+		assert_eq!(convert_to_utf8_owned_detecting(input.to_vec()).1, expected);
 	}
 
 	#[test]
@@ -164,6 +257,17 @@ mod tests {
 		assert_eq!(looks_like_utf16(input), expected);
 	}
 
+	#[rstest]
+	#[case(b"plain ascii", Some("UTF-8"))]
+	#[case(b"split caf\xC3", Some("UTF-8"))]
+	#[case(b"\xFF\xFEH\x00", Some("UTF-8"))]
+	#[case(b"caf\xE9 au lait", Some("windows-1252"))]
+	#[case(b"\xFF\xFE\x00\x00H\x00\x00\x00", None)]
+	#[case(b"H\x00i\x00", None)]
+	fn test_streaming_decoder_choice(#[case] head: &[u8], #[case] expected: Option<&str>) {
+		assert_eq!(streaming_decoder(head).map(|decoder| decoder.encoding().name()), expected);
+	}
+
 	#[test]
 	fn test_convert_to_utf8_falls_back_to_lossy_when_no_viable_decode() {
 		let input = b"\x81\x8D";
@@ -27,6 +27,13 @@ pub fn remove_soft_hyphens(input: &str) -> String {
 	input.replace("\u{00AD}", "")
 }
 
+/// In-place form of [`remove_soft_hyphens`], for text that is already owned; it never reallocates.
+pub fn strip_soft_hyphens(text: &mut String) {
+	if text.contains('\u{00AD}') {
+		text.retain(|ch| ch != '\u{00AD}');
+	}
+}
+
 #[must_use]
 pub fn url_decode(input: &str) -> String {
 	percent_encoding::percent_decode_str(input).decode_utf8_lossy().into_owned()
@@ -124,6 +131,9 @@ mod tests {
 	#[case("mul\u{00AD}ti\u{00AD}ple", "multiple")]
 	fn test_remove_soft_hyphens(#[case] input: &str, #[case] expected: &str) {
 		assert_eq!(remove_soft_hyphens(input), expected);
+		let mut owned = input.to_string();
+		strip_soft_hyphens(&mut owned);
+		assert_eq!(owned, expected);
 	}
 
 	#[rstest]
@@ -13,7 +13,7 @@ mod ui;
 
 use std::{env, fs, io};
 
-use paperback_core::{set_pdfium_library_path, version};
+use paperback_core::{set_document_cache_dir, set_pdfium_library_path, version};
 use ui::PaperbackApp;
 use wxdragon::prelude::{Appearance, set_appearance};
 
@@ -21,6 +21,7 @@ fn main() {
 	let _log_guard = logging::init(&config_ext::config_dir());
 	tracing::info!(version = env!("CARGO_PKG_VERSION"), commit = version::COMMIT_HASH, "starting");
 	set_pdfium_path_from_exe();
+	set_document_cache_dir(config_ext::config_dir().join("cache").to_string_lossy().into_owned());
 	cleanup_legacy_files();
 
 	// When running in dev via `cargo run`, make sure the app gets a proper menu bar on Mac OS.
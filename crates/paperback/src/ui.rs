@@ -1,5 +1,6 @@
 mod app;
 mod dialogs;
+mod document_loader;
 mod document_manager;
 mod find;
 mod help;
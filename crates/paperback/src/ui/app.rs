@@ -33,6 +33,17 @@ static MAIN_WINDOW_PTR: AtomicUsize = AtomicUsize::new(0);
 
 impl PaperbackApp {
 	pub fn new(_app: App) -> Self {
+		// Checked before touching the config files: opening the config may migrate or compact them, which only the
+		// instance that keeps running may do.
+		let single_instance_checker = SingleInstanceChecker::new(SINGLE_INSTANCE_NAME, None);
+		if let Some(checker) = single_instance_checker.as_ref()
+			&& checker.is_another_running()
+		{
+			let cmd = ipc_command_from_cli();
+			tracing::info!(command = ?cmd, "another instance is running, forwarding command and exiting");
+			send_ipc_command(cmd);
+			process::exit(0);
+		}
 		migrate_if_needed();
 		let mut config = ConfigManager::new();
 		let _ = config.initialize(config_toml_path());
@@ -45,15 +56,6 @@ impl PaperbackApp {
 			}
 		}
 		let config = Rc::new(Mutex::new(config));
-		let single_instance_checker = SingleInstanceChecker::new(SINGLE_INSTANCE_NAME, None);
-		if let Some(checker) = single_instance_checker.as_ref()
-			&& checker.is_another_running()
-		{
-			let cmd = ipc_command_from_cli();
-			tracing::info!(command = ?cmd, "another instance is running, forwarding command and exiting");
-			send_ipc_command(cmd);
-			process::exit(0);
-		}
 		let main_window = Rc::new(MainWindow::new(Rc::clone(&config)));
 		MAIN_WINDOW_PTR.store(Rc::as_ptr(&main_window) as usize, Ordering::SeqCst);
 		set_top_window(main_window.frame());
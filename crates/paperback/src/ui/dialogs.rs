@@ -13,6 +13,8 @@ mod document_info;
 pub use document_info::show_document_info_dialog;
 mod elements;
 pub use elements::show_elements_dialog;
+mod find_results;
+pub use find_results::{show_find_results_dialog, start_find_all};
 mod go_to_line;
 pub use go_to_line::show_go_to_line_dialog;
 mod go_to_page;
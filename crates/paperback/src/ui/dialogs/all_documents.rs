@@ -1,8 +1,23 @@
-use std::{path::Path, rc::Rc, sync::Mutex};
+use std::{
+	cell::RefCell,
+	collections::{HashMap, HashSet},
+	path::Path,
+	rc::Rc,
+	sync::{
+		Arc, Mutex,
+		atomic::{AtomicBool, Ordering},
+		mpsc::{self, TryRecvError},
+	},
+	thread,
+};
 
-use paperback_core::{config::ConfigManager, parser::build_file_filter_string, types::DocumentListStatus};
+use paperback_core::{
+	config::{ConfigManager, find_missing_documents},
+	parser::build_file_filter_string,
+	types::DocumentListStatus,
+};
 use patois::t;
-use wxdragon::prelude::*;
+use wxdragon::{prelude::*, timer::Timer};
 
 const DIALOG_PADDING: i32 = 10;
 const RECENT_DOCS_LIST_WIDTH: i32 = 800;
@@ -14,12 +29,21 @@ const KEY_DELETE: i32 = 127;
 const KEY_NUMPAD_DELETE: i32 = 330;
 const KEY_RETURN: i32 = 13;
 const KEY_NUMPAD_ENTER: i32 = 370;
+const EXISTENCE_POLL_INTERVAL_MS: i32 = 100;
 
 pub struct AllDocumentsResult {
 	pub open: Option<String>,
 	pub paths_to_close: Vec<String>,
 }
 
+/// The documents found missing so far, and the row each listed document is on so that a late result can be marked
+/// without searching the list.
+#[derive(Default)]
+struct MissingDocuments {
+	paths: HashSet<String>,
+	rows: HashMap<String, i64>,
+}
+
 pub fn show_all_documents_dialog(
 	parent: &Frame,
 	config: &Rc<Mutex<ConfigManager>>,
@@ -31,6 +55,7 @@ pub fn show_all_documents_dialog(
 	let dialog = Dialog::builder(parent, &dialog_title).build();
 	let selected_path = Rc::new(Mutex::new(None));
 	let paths_to_close: Rc<Mutex<Vec<String>>> = Rc::new(Mutex::new(Vec::new()));
+	let missing: Rc<RefCell<MissingDocuments>> = Rc::default();
 	// TRANSLATORS: Label for the search input field in the All Documents dialog
 	let search_label = StaticText::builder(&dialog).with_label(&t("&search")).build();
 	let search_ctrl = TextCtrl::builder(&dialog).with_size(Size::new(300, -1)).build();
@@ -45,9 +70,25 @@ pub fn show_all_documents_dialog(
 		clear_all_button,
 		config,
 		open_paths: open_paths.as_ref(),
+		missing: &missing,
 		filter: "",
 		selection: None,
 	});
+	// The list is shown right away and documents are marked missing as the checks come back, since checking every
+	// file can take a while on network shares.
+	let existence_timer = Rc::new(Timer::new(&dialog));
+	let known_documents = config.lock().unwrap().get_all_documents();
+	let cancel_existence = Arc::new(AtomicBool::new(false));
+	bind_all_documents_existence(
+		&existence_timer,
+		known_documents,
+		&cancel_existence,
+		doc_list,
+		open_button,
+		locate_button,
+		&missing,
+	);
+	existence_timer.start(EXISTENCE_POLL_INTERVAL_MS, false);
 	bind_all_documents_selection(doc_list, open_button, locate_button);
 	let open_action = make_all_documents_open_action(dialog, doc_list, Rc::clone(&selected_path));
 	bind_all_documents_open(doc_list, open_button, &open_action);
@@ -61,6 +102,7 @@ pub fn show_all_documents_dialog(
 		clear_all_button,
 		Rc::clone(config),
 		Rc::clone(&open_paths),
+		Rc::clone(&missing),
 		Rc::clone(&paths_to_close),
 	);
 	remove_button.on_click({
@@ -77,6 +119,7 @@ pub fn show_all_documents_dialog(
 		clear_all_button,
 		Rc::clone(config),
 		Rc::clone(&open_paths),
+		Rc::clone(&missing),
 		locate_button,
 	);
 	bind_all_documents_clear(
@@ -89,6 +132,7 @@ pub fn show_all_documents_dialog(
 		clear_all_button,
 		Rc::clone(config),
 		Rc::clone(&open_paths),
+		Rc::clone(&missing),
 		Rc::clone(&paths_to_close),
 	);
 	bind_all_documents_search(
@@ -100,6 +144,7 @@ pub fn show_all_documents_dialog(
 		clear_all_button,
 		Rc::clone(config),
 		Rc::clone(&open_paths),
+		Rc::clone(&missing),
 	);
 	bind_all_documents_keys(doc_list, &open_action, &remove_action);
 	bind_all_documents_layout(
@@ -116,6 +161,8 @@ pub fn show_all_documents_dialog(
 		},
 	);
 	dialog.show_modal();
+	existence_timer.stop();
+	cancel_existence.store(true, Ordering::Relaxed);
 	AllDocumentsResult {
 		open: selected_path.lock().unwrap().clone(),
 		paths_to_close: paths_to_close.lock().unwrap().clone(),
@@ -236,6 +283,7 @@ fn make_all_documents_remove_action(
 	clear_button: Button,
 	config: Rc<Mutex<ConfigManager>>,
 	open_paths: Rc<Vec<String>>,
+	missing: Rc<RefCell<MissingDocuments>>,
 	paths_to_close: Rc<Mutex<Vec<String>>>,
 ) -> Rc<dyn Fn()> {
 	Rc::new(move || {
@@ -285,6 +333,7 @@ fn make_all_documents_remove_action(
 			clear_all_button: clear_button,
 			config: &config,
 			open_paths: open_paths.as_ref(),
+			missing: &missing,
 			filter: &filter,
 			selection: new_selection,
 		});
@@ -301,6 +350,7 @@ fn bind_all_documents_clear(
 	clear_button: Button,
 	config: Rc<Mutex<ConfigManager>>,
 	open_paths: Rc<Vec<String>>,
+	missing: Rc<RefCell<MissingDocuments>>,
 	paths_to_close: Rc<Mutex<Vec<String>>>,
 ) {
 	clear_button.on_click(move |_| {
@@ -341,6 +391,7 @@ fn bind_all_documents_clear(
 			clear_all_button: clear_button,
 			config: &config,
 			open_paths: open_paths.as_ref(),
+			missing: &missing,
 			filter: "",
 			selection: None,
 		});
@@ -356,6 +407,7 @@ fn bind_all_documents_search(
 	clear_button: Button,
 	config: Rc<Mutex<ConfigManager>>,
 	open_paths: Rc<Vec<String>>,
+	missing: Rc<RefCell<MissingDocuments>>,
 ) {
 	search_ctrl.on_text_updated(move |_event| {
 		let filter = search_ctrl.get_value();
@@ -367,6 +419,7 @@ fn bind_all_documents_search(
 			clear_all_button: clear_button,
 			config: &config,
 			open_paths: open_paths.as_ref(),
+			missing: &missing,
 			filter: &filter,
 			selection: None,
 		});
@@ -471,6 +524,7 @@ struct DocumentListParams<'a> {
 	clear_all_button: Button,
 	config: &'a Rc<Mutex<ConfigManager>>,
 	open_paths: &'a [String],
+	missing: &'a RefCell<MissingDocuments>,
 	filter: &'a str,
 	selection: Option<i32>,
 }
@@ -484,18 +538,22 @@ fn populate_document_list(params: &DocumentListParams<'_>) {
 		clear_all_button,
 		config,
 		open_paths,
+		missing,
 		filter,
 		selection,
 	} = *params;
 	list.cleanup_all_custom_data();
 	list.delete_all_items();
+	let mut missing = missing.borrow_mut();
 	let items = {
 		let cfg = config.lock().unwrap();
-		paperback_core::config::get_sorted_document_list(&cfg, open_paths, filter)
+		paperback_core::config::get_sorted_document_list(&cfg, open_paths, filter, &missing.paths)
 	};
+	missing.rows.clear();
 	for item in items {
 		let index = i64::from(list.get_item_count());
 		list.insert_item(index, &item.filename, None);
+		missing.rows.insert(item.path.clone(), index);
 		if let Ok(index_u64) = u64::try_from(index) {
 			list.set_custom_data(index_u64, item.path.clone());
 		}
@@ -533,6 +591,60 @@ fn populate_document_list(params: &DocumentListParams<'_>) {
 	}
 }
 
+/// Checks `paths` on a background thread and marks the rows of those that are gone as missing as each batch of checks
+/// comes back. Missing paths are also recorded in `missing` so that repopulating the list keeps them marked. Setting
+/// `cancel` stops the checks once the dialog no longer needs them.
+fn bind_all_documents_existence(
+	timer: &Rc<Timer>,
+	paths: Vec<String>,
+	cancel: &Arc<AtomicBool>,
+	list: ListCtrl,
+	open_button: Button,
+	locate_button: Button,
+	missing: &Rc<RefCell<MissingDocuments>>,
+) {
+	let (tx, rx) = mpsc::channel();
+	let cancel = Arc::clone(cancel);
+	thread::spawn(move || {
+		find_missing_documents(&paths, &cancel, |batch| {
+			let _ = tx.send(batch);
+		});
+	});
+	// Weak, so the handler does not keep its own timer alive once the dialog is done with it.
+	let timer_for_tick = Rc::downgrade(timer);
+	let missing = Rc::clone(missing);
+	timer.on_tick(move |_| {
+		let mut changed = false;
+		loop {
+			match rx.try_recv() {
+				Ok(batch) => {
+					let mut missing = missing.borrow_mut();
+					for path in batch {
+						if let Some(&row) = missing.rows.get(&path) {
+							// TRANSLATORS: Status of a document whose file could not be found on disk
+							list.set_item_text_by_column(row, 1, &t("Missing"));
+						}
+						missing.paths.insert(path);
+					}
+					changed = true;
+				}
+				Err(TryRecvError::Empty) => break,
+				Err(TryRecvError::Disconnected) => {
+					if let Some(timer) = timer_for_tick.upgrade() {
+						timer.stop();
+					}
+					break;
+				}
+			}
+		}
+		if !changed {
+			return;
+		}
+		update_open_button_for_index(list, open_button, get_selected_index(list));
+		update_locate_button(list, locate_button);
+	});
+}
+
 fn update_open_button_for_index(list: ListCtrl, open_button: Button, index: i32) {
 	if index < 0 {
 		open_button.enable(false);
@@ -558,6 +670,7 @@ fn bind_all_documents_locate(
 	clear_all_button: Button,
 	config: Rc<Mutex<ConfigManager>>,
 	open_paths: Rc<Vec<String>>,
+	missing: Rc<RefCell<MissingDocuments>>,
 	locate_button_widget: Button,
 ) {
 	locate_button_widget.on_click(move |_| {
@@ -596,6 +709,7 @@ fn bind_all_documents_locate(
 			clear_all_button,
 			config: &config,
 			open_paths: open_paths.as_ref(),
+			missing: &missing,
 			filter: &filter,
 			selection: if selected_index >= 0 { Some(selected_index) } else { None },
 		});
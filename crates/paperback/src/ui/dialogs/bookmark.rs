@@ -457,11 +457,9 @@ fn bind_bookmark_edit(params: BookmarkEditParams) {
 		}
 		let existing_note = {
 			let cfg = config.lock().unwrap();
-			cfg.get_bookmarks(&file_path)
-				.into_iter()
-				.find(|bm| bm.start == start && bm.end == end)
-				.map(|bm| bm.note)
-				.unwrap_or_default()
+			cfg.with_bookmark_index(&file_path, |index| {
+				index.starting_at(start).find(|bm| bm.end == end).map(|bm| bm.note.clone()).unwrap_or_default()
+			})
 		};
 		let Some(note) = show_note_entry_dialog(
 			&dialog,
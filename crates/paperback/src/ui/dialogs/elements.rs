@@ -104,60 +104,46 @@ fn populate_elements_dialog_dv(
 ) -> (Rc<Cell<i64>>, HashMap<usize, i64>, Rc<Vec<i64>>) {
 	let selected_offset = Rc::new(Cell::new(-1i64));
 	let mut item_offsets: HashMap<usize, i64> = HashMap::new();
-	let tree_data = session.heading_tree(current_pos);
-	// Precompute which items have children so we can use append_container vs append_item.
-	let has_children_vec: Vec<bool> = (0..tree_data.items.len())
-		.map(|i| {
-			tree_data.items.iter().any(|it| it.parent_index >= 0 && usize::try_from(it.parent_index).ok() == Some(i))
-		})
-		.collect();
+	let buffer = &session.handle().document().buffer;
+	let elements = session.handle().elements();
+	let headings = elements.headings();
+	// Which items have children, so we can use append_container vs append_item.
+	let mut has_children = vec![false; headings.len()];
+	for parent in headings.iter().filter_map(|heading| heading.parent) {
+		has_children[parent] = true;
+	}
+	// TRANSLATORS: Placeholder text shown in the elements list when a document element has no text content
+	let untitled = t("Untitled");
 	let root = DataViewItem::default();
-	let mut item_ids: Vec<DataViewItem> = Vec::new();
-	for (current_idx, item) in tree_data.items.iter().enumerate() {
-		let parent: &DataViewItem = if item.parent_index >= 0 {
-			usize::try_from(item.parent_index).ok().and_then(|idx| item_ids.get(idx)).unwrap_or(&root)
-		} else {
-			&root
-		};
-		// TRANSLATORS: Placeholder text shown in the elements list when a document element has no text content
-		let display_text = if item.text.is_empty() { t("Untitled") } else { item.text.clone() };
-		let offset = i64::try_from(item.offset).unwrap_or(i64::MAX);
-		let node = if has_children_vec[current_idx] {
-			headings_tree.append_container(parent, &display_text, -1, -1)
+	let mut item_ids: Vec<DataViewItem> = Vec::with_capacity(headings.len());
+	headings_tree.freeze();
+	for (current_idx, heading) in headings.iter().enumerate() {
+		let parent = heading.parent.and_then(|idx| item_ids.get(idx)).unwrap_or(&root);
+		let label = heading.label(buffer);
+		let display_text = if label.is_empty() { untitled.as_str() } else { label };
+		let offset = i64::try_from(heading.offset).unwrap_or(i64::MAX);
+		let node = if has_children[current_idx] {
+			headings_tree.append_container(parent, display_text, -1, -1)
 		} else {
-			headings_tree.append_item(parent, &display_text, -1)
+			headings_tree.append_item(parent, display_text, -1)
 		};
 		if let Some(id_ptr) = node.get_id::<c_void>() {
 			item_offsets.insert(id_ptr as usize, offset);
 		}
 		item_ids.push(node);
 	}
-	let select_idx = if tree_data.closest_index >= 0 {
-		usize::try_from(tree_data.closest_index).ok()
-	} else if !item_ids.is_empty() {
-		Some(0)
-	} else {
-		None
-	};
+	headings_tree.thaw();
+	let select_idx = elements
+		.closest_heading(usize::try_from(current_pos.max(0)).unwrap_or(0))
+		.or_else(|| (!item_ids.is_empty()).then_some(0));
 	if let Some(idx) = select_idx {
 		if let Some(item) = item_ids.get(idx) {
 			headings_tree.select(item);
 			headings_tree.ensure_visible(item);
 		}
 	}
-	let link_data = session.link_list(current_pos);
-	let mut link_offsets = Vec::new();
-	for item in link_data.items {
-		links_list.append(&item.text);
-		link_offsets.push(i64::try_from(item.offset).unwrap_or(i64::MAX));
-	}
-	if !link_offsets.is_empty() {
-		let idx = if link_data.closest_index >= 0 { link_data.closest_index } else { 0 };
-		if let Ok(idx_u32) = u32::try_from(idx) {
-			links_list.set_selection(idx_u32, true);
-		}
-	}
-	(selected_offset, item_offsets, Rc::new(link_offsets))
+	let link_offsets = populate_links(session, current_pos, links_list);
+	(selected_offset, item_offsets, link_offsets)
 }
 
 #[cfg(not(target_os = "windows"))]
@@ -343,34 +329,28 @@ fn populate_elements_dialog(
 ) -> (Rc<Cell<i64>>, Rc<Vec<i64>>) {
 	let selected_offset = Rc::new(Cell::new(-1i64));
 	let root = headings_tree.add_root("Root", None, None).unwrap();
-	let tree_data = session.heading_tree(current_pos);
-	let mut item_ids: Vec<TreeItemId> = Vec::new();
-	if !tree_data.items.is_empty() {
-		item_ids.reserve(tree_data.items.len());
-	}
-	for item in &tree_data.items {
-		let parent_id = if item.parent_index >= 0 {
-			usize::try_from(item.parent_index)
-				.ok()
-				.and_then(|idx| item_ids.get(idx).cloned())
-				.unwrap_or_else(|| root.clone())
-		} else {
-			root.clone()
-		};
-		// TRANSLATORS: Placeholder text shown in the elements list when a document element has no text content
-		let display_text = if item.text.is_empty() { t("Untitled") } else { item.text.clone() };
-		let offset = i64::try_from(item.offset).unwrap_or(i64::MAX);
-		if let Some(id) = headings_tree.append_item_with_data(&parent_id, &display_text, offset, None, None) {
+	let buffer = &session.handle().document().buffer;
+	let elements = session.handle().elements();
+	let headings = elements.headings();
+	// TRANSLATORS: Placeholder text shown in the elements list when a document element has no text content
+	let untitled = t("Untitled");
+	let mut item_ids: Vec<TreeItemId> = Vec::with_capacity(headings.len());
+	headings_tree.freeze();
+	for heading in headings {
+		let parent_id = heading.parent.and_then(|idx| item_ids.get(idx).cloned()).unwrap_or_else(|| root.clone());
+		let label = heading.label(buffer);
+		let display_text = if label.is_empty() { untitled.as_str() } else { label };
+		let offset = i64::try_from(heading.offset).unwrap_or(i64::MAX);
+		if let Some(id) = headings_tree.append_item_with_data(&parent_id, display_text, offset, None, None) {
 			item_ids.push(id);
-		} else if let Some(root_child) = headings_tree.append_item_with_data(&root, &display_text, offset, None, None) {
+		} else if let Some(root_child) = headings_tree.append_item_with_data(&root, display_text, offset, None, None) {
 			item_ids.push(root_child);
 		}
 	}
 	headings_tree.expand_all();
-	if tree_data.closest_index >= 0 {
-		if let Ok(index) = usize::try_from(tree_data.closest_index)
-			&& let Some(item) = item_ids.get(index)
-		{
+	headings_tree.thaw();
+	if let Some(index) = elements.closest_heading(usize::try_from(current_pos.max(0)).unwrap_or(0)) {
+		if let Some(item) = item_ids.get(index) {
 			headings_tree.select_item(item);
 			headings_tree.ensure_visible(item);
 		}
@@ -378,19 +358,8 @@ fn populate_elements_dialog(
 		headings_tree.select_item(&first_child);
 		headings_tree.ensure_visible(&first_child);
 	}
-	let link_data = session.link_list(current_pos);
-	let mut link_offsets = Vec::new();
-	for item in link_data.items {
-		links_list.append(&item.text);
-		link_offsets.push(i64::try_from(item.offset).unwrap_or(i64::MAX));
-	}
-	if !link_offsets.is_empty() {
-		let idx = if link_data.closest_index >= 0 { link_data.closest_index } else { 0 };
-		if let Ok(idx_u32) = u32::try_from(idx) {
-			links_list.set_selection(idx_u32, true);
-		}
-	}
-	(selected_offset, Rc::new(link_offsets))
+	let link_offsets = populate_links(session, current_pos, links_list);
+	(selected_offset, link_offsets)
 }
 
 #[cfg(target_os = "windows")]
@@ -483,6 +452,27 @@ fn bind_elements_ok_action(
 
 // ── Shared helpers ─────────────────────────────────────────────────────────────
 
+/// Fills `links_list` with every link of the document and selects the last one at or before `current_pos`. Returns
+/// the link offsets by list index. The labels are borrowed from the document, and the list is frozen while it fills,
+/// since documents can hold tens of thousands of links.
+fn populate_links(session: &DocumentSession, current_pos: i64, links_list: ListBox) -> Rc<Vec<i64>> {
+	let buffer = &session.handle().document().buffer;
+	let elements = session.handle().elements();
+	let links = elements.links();
+	links_list.freeze();
+	for link in links {
+		links_list.append(link.label(buffer));
+	}
+	links_list.thaw();
+	if !links.is_empty() {
+		let idx = elements.closest_link(usize::try_from(current_pos.max(0)).unwrap_or(0)).unwrap_or(0);
+		if let Ok(idx_u32) = u32::try_from(idx) {
+			links_list.set_selection(idx_u32, true);
+		}
+	}
+	Rc::new(links.iter().map(|link| i64::try_from(link.offset).unwrap_or(i64::MAX)).collect())
+}
+
 fn build_elements_buttons(dialog: Dialog) -> (Button, Button) {
 	// TRANSLATORS: Label for the confirmation button
 	let ok_button = Button::builder(&dialog).with_id(ID_OK).with_label(&t("OK")).build();
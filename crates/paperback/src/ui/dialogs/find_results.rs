@@ -0,0 +1,200 @@
+use std::{
+	cell::{Cell, RefCell},
+	rc::{Rc, Weak},
+	sync::{
+		Arc,
+		mpsc::{self, Receiver},
+	},
+};
+
+use paperback_core::{
+	reader_core::SearchOptions,
+	session::{DocumentSession, FindAllTask},
+	types::SearchHit,
+};
+use patois::t;
+use wxdragon::{prelude::*, timer::Timer};
+
+use super::DIALOG_PADDING;
+
+const RESULTS_LIST_WIDTH: i32 = 500;
+const RESULTS_LIST_HEIGHT: i32 = 400;
+const POLL_INTERVAL_MS: i32 = 100;
+/// Matches past this many are counted but not listed; a list box with hundreds of thousands of rows is too slow to fill
+/// and too long to navigate.
+const MAX_LISTED_RESULTS: usize = 10_000;
+
+enum FindAllEvent {
+	Batch(Vec<SearchHit>),
+	Done { total: usize, cancelled: bool },
+}
+
+/// A Find All search running on the session's worker, whose results are shown by [`show_find_results_dialog`].
+pub struct FindAllSearch {
+	task: Arc<FindAllTask>,
+	events: Receiver<FindAllEvent>,
+}
+
+/// Starts listing every match of `query` in `session`. Nothing of the session is borrowed once this returns, so the
+/// caller need not hold any lock while the results dialog is open.
+pub fn start_find_all(session: &DocumentSession, query: &str, options: SearchOptions) -> FindAllSearch {
+	let (tx, events) = mpsc::channel();
+	let batch_tx = tx.clone();
+	let task = session.find_all(
+		query,
+		options,
+		move |hits| {
+			let _ = batch_tx.send(FindAllEvent::Batch(hits));
+		},
+		move |total, cancelled| {
+			let _ = tx.send(FindAllEvent::Done { total, cancelled });
+		},
+	);
+	FindAllSearch { task, events }
+}
+
+/// Lists the matches of `search`, filling in as its worker streams batches.
+///
+/// Returns the hit the user chose to jump to. The search is cancelled when the dialog closes.
+pub fn show_find_results_dialog(parent: &Frame, search: FindAllSearch) -> Option<SearchHit> {
+	let FindAllSearch { task, events } = search;
+	// TRANSLATORS: Title of the dialog listing every match of a Find All search
+	let dialog = Dialog::builder(parent, &t("Find Results")).build();
+	// TRANSLATORS: Status shown above the results list while Find All is still scanning the document
+	let status_label = StaticText::builder(&dialog).with_label(&t("Searching...")).build();
+	let results_list = ListBox::builder(&dialog).with_size(Size::new(RESULTS_LIST_WIDTH, RESULTS_LIST_HEIGHT)).build();
+	// TRANSLATORS: Accessibility label for the list of Find All results (macOS only)
+	#[cfg(target_os = "macos")]
+	results_list.set_accessibility_label(&t("Results"));
+	// TRANSLATORS: Label for the button to jump to the selected search result
+	let jump_button = Button::builder(&dialog).with_id(ID_OK).with_label(&t("&Jump")).build();
+	// TRANSLATORS: Label for the button to close the Find Results dialog
+	let cancel_button = Button::builder(&dialog).with_id(ID_CANCEL).with_label(&t("&Cancel")).build();
+	dialog.set_escape_id(ID_CANCEL);
+	jump_button.set_default();
+	jump_button.enable(false);
+
+	let hits: Rc<RefCell<Vec<SearchHit>>> = Rc::new(RefCell::new(Vec::new()));
+	let selected = Rc::new(Cell::new(-1i32));
+	let timer = Rc::new(Timer::new(&dialog));
+	bind_find_results_poll(&timer, events, &hits, &selected, results_list, status_label, jump_button);
+	timer.start(POLL_INTERVAL_MS, false);
+	bind_find_results_selection(dialog, results_list, jump_button, &selected);
+
+	let button_sizer = BoxSizer::builder(Orientation::Horizontal).build();
+	button_sizer.add(&jump_button, 0, SizerFlag::Right, DIALOG_PADDING);
+	button_sizer.add(&cancel_button, 0, SizerFlag::Right, DIALOG_PADDING);
+	let content_sizer = BoxSizer::builder(Orientation::Vertical).build();
+	content_sizer.add(&status_label, 0, SizerFlag::Expand | SizerFlag::All, DIALOG_PADDING);
+	content_sizer.add(
+		&results_list,
+		1,
+		SizerFlag::Expand | SizerFlag::Left | SizerFlag::Right | SizerFlag::Bottom,
+		DIALOG_PADDING,
+	);
+	content_sizer.add_sizer(&button_sizer, 0, SizerFlag::AlignRight | SizerFlag::All, DIALOG_PADDING);
+	dialog.set_sizer_and_fit(content_sizer, true);
+	dialog.centre();
+	results_list.set_focus();
+
+	let result = dialog.show_modal();
+	timer.stop();
+	task.cancel();
+	if result != ID_OK {
+		return None;
+	}
+	let index = usize::try_from(selected.get()).ok()?;
+	hits.borrow().get(index).cloned()
+}
+
+fn bind_find_results_poll(
+	timer: &Rc<Timer>,
+	rx: Receiver<FindAllEvent>,
+	hits: &Rc<RefCell<Vec<SearchHit>>>,
+	selected: &Rc<Cell<i32>>,
+	results_list: ListBox,
+	status_label: StaticText,
+	jump_button: Button,
+) {
+	// Weak, so the handler does not keep its own timer alive once the dialog is done with it.
+	let timer_for_tick = Rc::downgrade(timer);
+	let hits = Rc::clone(hits);
+	let selected = Rc::clone(selected);
+	let found = Cell::new(0);
+	timer.on_tick(move |_| {
+		for event in rx.try_iter() {
+			match event {
+				FindAllEvent::Batch(batch) => {
+					found.set(found.get() + batch.len());
+					let listed = hits.borrow().len();
+					let room = MAX_LISTED_RESULTS - listed;
+					if room > 0 {
+						results_list.freeze();
+						for hit in batch.iter().take(room) {
+							// TRANSLATORS: One Find All result; {} is the line number, then the match in context
+							let line = t("Line {}: {}").replacen("{}", &hit.line_number.to_string(), 1);
+							results_list.append(&line.replacen("{}", &hit.snippet, 1));
+						}
+						results_list.thaw();
+						hits.borrow_mut().extend(batch.into_iter().take(room));
+					}
+					if listed == 0 && !hits.borrow().is_empty() {
+						results_list.set_selection(0, true);
+						selected.set(0);
+						jump_button.enable(true);
+					}
+					// TRANSLATORS: Status shown while Find All is still running; {} is the number of matches found so far
+					status_label
+						.set_label(&t("Searching... {} matches so far").replace("{}", &found.get().to_string()));
+				}
+				FindAllEvent::Done { total, cancelled } => {
+					if let Some(timer) = timer_for_tick.upgrade() {
+						timer.stop();
+					}
+					let status = if cancelled {
+						// TRANSLATORS: Status shown when a Find All search was stopped before it finished
+						t("Search cancelled.")
+					} else if total == 0 {
+						// TRANSLATORS: Status shown when Find All found no matches
+						t("No matches found.")
+					} else if total > MAX_LISTED_RESULTS {
+						// TRANSLATORS: Status shown when Find All found more matches than the list shows; the first {} is
+						// the total number of matches, the second how many are listed
+						t("{} matches found; showing the first {}.").replacen("{}", &total.to_string(), 1).replacen(
+							"{}",
+							&MAX_LISTED_RESULTS.to_string(),
+							1,
+						)
+					} else {
+						// TRANSLATORS: Status shown when Find All has finished; {} is the total number of matches
+						t("{} matches found.").replace("{}", &total.to_string())
+					};
+					status_label.set_label(&status);
+				}
+			}
+		}
+	});
+}
+
+fn bind_find_results_selection(dialog: Dialog, results_list: ListBox, jump_button: Button, selected: &Rc<Cell<i32>>) {
+	let selected_for_change = Rc::clone(selected);
+	results_list.on_selection_changed(move |event| {
+		let selection = event.get_selection().unwrap_or(-1);
+		selected_for_change.set(selection);
+		jump_button.enable(selection >= 0);
+	});
+	let selected_for_activate = Rc::clone(selected);
+	results_list.on_item_double_clicked(move |event| {
+		let selection = event.get_selection().unwrap_or(-1);
+		if selection >= 0 {
+			selected_for_activate.set(selection);
+			dialog.end_modal(ID_OK);
+		}
+	});
+	let selected_for_jump = Rc::clone(selected);
+	jump_button.on_click(move |_| {
+		if selected_for_jump.get() >= 0 {
+			dialog.end_modal(ID_OK);
+		}
+	});
+}
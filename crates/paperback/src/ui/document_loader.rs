@@ -0,0 +1,163 @@
+use std::{
+	num::NonZeroUsize,
+	path::PathBuf,
+	sync::{
+		Arc, Mutex, PoisonError,
+		atomic::{AtomicBool, Ordering},
+		mpsc::{self, Receiver, Sender},
+	},
+	thread,
+};
+
+use paperback_core::{document::DocumentChunk, session::DocumentSession};
+
+/// Upper bound on concurrent parses; parsing is memory-heavy, so more workers than this mostly adds pressure.
+const MAX_LOAD_WORKERS: usize = 4;
+
+/// Everything a worker needs to parse one document, captured on the UI thread.
+#[derive(Clone, Debug)]
+pub struct LoadRequest {
+	pub id: u64,
+	pub path: PathBuf,
+	pub password: String,
+	pub forced_extension: String,
+	pub render_tables_inline: bool,
+	pub cancelled: Arc<AtomicBool>,
+}
+
+pub enum LoadEvent {
+	/// A page or section that has been parsed ahead of the rest of the document.
+	Chunk {
+		id: u64,
+		chunk: DocumentChunk,
+	},
+	Finished {
+		id: u64,
+		outcome: Result<DocumentSession, String>,
+	},
+}
+
+/// A small pool of parser threads fed from a shared job queue.
+///
+/// Each request streams its chunks followed by one `Finished` event. Nothing more is delivered for a request once it
+/// is cancelled, so the UI never has to reconcile a session for a tab that has already been closed.
+pub struct DocumentLoader {
+	jobs: Sender<LoadRequest>,
+	events: Receiver<LoadEvent>,
+}
+
+impl DocumentLoader {
+	/// Starts `workers` parser threads (at least one); see [`default_worker_count`].
+	pub fn new(workers: usize) -> Self {
+		let (jobs, job_rx) = mpsc::channel::<LoadRequest>();
+		let (event_tx, events) = mpsc::channel();
+		let job_rx = Arc::new(Mutex::new(job_rx));
+		for index in 0..workers.max(1) {
+			let job_rx = Arc::clone(&job_rx);
+			let event_tx = event_tx.clone();
+			let spawned = thread::Builder::new()
+				.name(format!("document-loader-{index}"))
+				.spawn(move || run_worker(&job_rx, &event_tx));
+			if let Err(err) = spawned {
+				tracing::error!(error = %err, "failed to spawn document loader thread");
+			}
+		}
+		Self { jobs, events }
+	}
+
+	pub fn submit(&self, request: LoadRequest) {
+		tracing::debug!(id = request.id, path = %request.path.display(), "queueing document load");
+		let _ = self.jobs.send(request);
+	}
+
+	pub fn try_recv(&self) -> Option<LoadEvent> {
+		self.events.try_recv().ok()
+	}
+}
+
+pub fn default_worker_count() -> usize {
+	thread::available_parallelism().map_or(1, NonZeroUsize::get).clamp(1, MAX_LOAD_WORKERS)
+}
+
+fn run_worker(jobs: &Mutex<Receiver<LoadRequest>>, events: &Sender<LoadEvent>) {
+	loop {
+		let request = {
+			let jobs = jobs.lock().unwrap_or_else(PoisonError::into_inner);
+			jobs.recv()
+		};
+		let Ok(request) = request else {
+			return;
+		};
+		if request.cancelled.load(Ordering::Relaxed) {
+			continue;
+		}
+		let path_str = request.path.to_string_lossy();
+		let mut on_chunk = |chunk| {
+			if !request.cancelled.load(Ordering::Relaxed) {
+				let _ = events.send(LoadEvent::Chunk { id: request.id, chunk });
+			}
+		};
+		let outcome = DocumentSession::new_streaming(
+			&path_str,
+			&request.password,
+			&request.forced_extension,
+			request.render_tables_inline,
+			&mut on_chunk,
+		);
+		if request.cancelled.load(Ordering::Relaxed) {
+			tracing::debug!(id = request.id, path = %request.path.display(), "discarding cancelled document load");
+			continue;
+		}
+		if events.send(LoadEvent::Finished { id: request.id, outcome }).is_err() {
+			return;
+		}
+	}
+}
+
+#[cfg(test)]
+mod tests {
+	use std::time::Duration;
+
+	use super::*;
+
+	fn request(id: u64, path: &str) -> LoadRequest {
+		LoadRequest {
+			id,
+			path: PathBuf::from(path),
+			password: String::new(),
+			forced_extension: String::new(),
+			render_tables_inline: true,
+			cancelled: Arc::new(AtomicBool::new(false)),
+		}
+	}
+
+	fn recv_finished(loader: &DocumentLoader) -> (u64, Result<DocumentSession, String>) {
+		for _ in 0..500 {
+			if let Some(LoadEvent::Finished { id, outcome }) = loader.try_recv() {
+				return (id, outcome);
+			}
+			thread::sleep(Duration::from_millis(10));
+		}
+		panic!("document loader produced no result");
+	}
+
+	#[test]
+	fn failed_parse_is_reported_with_its_request_id() {
+		let loader = DocumentLoader::new(2);
+		loader.submit(request(7, "/nonexistent/paperback/missing.txt"));
+		let (id, outcome) = recv_finished(&loader);
+		assert_eq!(id, 7);
+		assert!(outcome.is_err());
+	}
+
+	#[test]
+	fn cancelled_request_produces_no_result() {
+		let loader = DocumentLoader::new(1);
+		let cancelled = request(1, "/nonexistent/paperback/first.txt");
+		cancelled.cancelled.store(true, Ordering::Relaxed);
+		loader.submit(cancelled);
+		loader.submit(request(2, "/nonexistent/paperback/second.txt"));
+		assert_eq!(recv_finished(&loader).0, 2);
+		assert!(loader.try_recv().is_none());
+	}
+}
@@ -6,25 +6,33 @@ use std::{
 	cell::Cell,
 	path::{Path, PathBuf},
 	rc::Rc,
-	sync::{Mutex, atomic::Ordering},
+	sync::{
+		Arc, Mutex,
+		atomic::{AtomicBool, Ordering},
+	},
 	time::Instant,
 };
 
 use paperback_core::{
 	config::{ConfigManager, ReadabilityFont},
+	document::DocumentChunk,
+	follow::FollowUpdate,
 	parser::PASSWORD_REQUIRED_ERROR_PREFIX,
 	session::DocumentSession,
+	util::text::display_len,
 };
 use patois::t;
 use wxdragon::{
 	color::Colour,
 	event::{EventType, WindowEventData},
 	prelude::*,
+	timer::Timer,
 };
 
 #[cfg(target_os = "windows")]
 use super::rtf_write::{self, RtfFontInfo};
 use super::{
+	document_loader::{self, DocumentLoader, LoadEvent, LoadRequest},
 	main_window::{SLEEP_TIMER_DURATION_MINUTES, SLEEP_TIMER_START_MS},
 	menu_ids, status,
 };
@@ -35,6 +43,9 @@ pub struct DocumentTab {
 	pub session: DocumentSession,
 	pub file_path: PathBuf,
 	pub track: bool,
+	/// Id of the load that opened the tab. Tabs are kept in ascending order of it, which is the order they were
+	/// requested in, however their parses finish.
+	pub load_id: u64,
 }
 
 pub fn title_or_filename(title: String, path: &Path) -> String {
@@ -49,7 +60,28 @@ pub fn display_title(tab: &DocumentTab) -> String {
 	title_or_filename(tab.session.title(), &tab.file_path)
 }
 
+/// A notebook page shown while its document is parsed on the loader pool.
+///
+/// Until the first chunk arrives the page shows a status label; after that it shows a read-only preview that grows
+/// as chunks land, so the start of the document (or the saved reading position) is readable before the parse ends.
+struct PendingLoad {
+	request: LoadRequest,
+	panel: Panel,
+	status_label: Option<StaticText>,
+	preview: Option<TextCtrl>,
+	preview_end: usize,
+	resume_position: i64,
+	resume_reached: bool,
+	track: bool,
+	title_override: Option<String>,
+	initial_position: Option<i64>,
+	password_retried: bool,
+	outcome: Option<Result<DocumentSession, String>>,
+}
+
 const POSITION_SAVE_INTERVAL_SECS: u64 = 3;
+const LOAD_POLL_INTERVAL_MS: i32 = 50;
+const FOLLOW_POLL_INTERVAL_MS: i32 = 500;
 const WXK_F10: i32 = 349;
 const WXK_WINDOWS_MENU: i32 = 395;
 #[cfg(target_os = "windows")]
@@ -61,6 +93,12 @@ pub struct DocumentManager {
 	frame: Frame,
 	notebook: Notebook,
 	tabs: Vec<DocumentTab>,
+	/// Documents still being parsed; their placeholder pages follow every open tab in the notebook.
+	pending: Vec<PendingLoad>,
+	loader: DocumentLoader,
+	load_timer: Timer,
+	follow_timer: Timer,
+	next_load_id: u64,
 	config: Rc<Mutex<ConfigManager>>,
 	live_region_label: StaticText,
 	last_position_save: Cell<Option<Instant>>,
@@ -78,10 +116,16 @@ impl DocumentManager {
 		config: Rc<Mutex<ConfigManager>>,
 		live_region_label: StaticText,
 	) -> Self {
-		Self {
+		let following = config.lock().unwrap().get_app_bool("follow_files", false);
+		let manager = Self {
 			frame,
 			notebook,
 			tabs: Vec::new(),
+			pending: Vec::new(),
+			loader: DocumentLoader::new(document_loader::default_worker_count()),
+			load_timer: Timer::new(&frame),
+			follow_timer: Timer::new(&frame),
+			next_load_id: 0,
 			config,
 			live_region_label,
 			last_position_save: Cell::new(None),
@@ -90,33 +134,38 @@ impl DocumentManager {
 			recently_closed: Vec::new(),
 			#[cfg(target_os = "linux")]
 			navigation_key_map: Rc::new(build_navigation_key_map()),
-		}
+		};
+		manager.set_following(following);
+		manager
 	}
 
-	pub fn open_file(&mut self, self_rc: &Rc<Mutex<Self>>, path: &Path) -> bool {
-		self.open_file_impl(self_rc, path, true, false, None)
+	/// Starts opening `path` in a loading tab; the document is parsed in the background and the tab is filled in
+	/// by [`Self::poll_loads`]. Returns `false` if the open could not be started.
+	pub fn open_file(&mut self, path: &Path) -> bool {
+		self.open_file_impl(path, true, false, None, None)
 	}
 
-	pub fn open_file_restore(&mut self, self_rc: &Rc<Mutex<Self>>, path: &Path) -> bool {
-		self.open_file_impl(self_rc, path, true, true, None)
+	pub fn open_file_restore(&mut self, path: &Path) -> bool {
+		self.open_file_impl(path, true, true, None, None)
 	}
 
-	pub fn open_help_file(&mut self, self_rc: &Rc<Mutex<Self>>, path: &Path) -> bool {
-		self.open_file_impl(self_rc, path, false, false, None)
+	pub fn open_help_file(&mut self, path: &Path) -> bool {
+		self.open_file_impl(path, false, false, None, None)
 	}
 
-	/// Opens a synthetic source-view document (untracked) with an explicit tab title.
-	pub fn open_source_file(&mut self, self_rc: &Rc<Mutex<Self>>, path: &Path, title: &str) -> bool {
-		self.open_file_impl(self_rc, path, false, false, Some(title))
+	/// Opens a synthetic source-view document (untracked) with an explicit tab title, placing the caret at
+	/// `caret` once it has loaded.
+	pub fn open_source_file(&mut self, path: &Path, title: &str, caret: i64) -> bool {
+		self.open_file_impl(path, false, false, Some(title), Some(caret))
 	}
 
 	fn open_file_impl(
 		&mut self,
-		self_rc: &Rc<Mutex<Self>>,
 		path: &Path,
 		track: bool,
 		is_restore: bool,
 		title_override: Option<&str>,
+		initial_position: Option<i64>,
 	) -> bool {
 		if !path.exists() {
 			// TRANSLATORS: Error message shown when the requested document file does not exist; {} is the file path
@@ -127,6 +176,11 @@ impl DocumentManager {
 		}
 		if let Some(index) = self.find_tab_by_path(path) {
 			self.notebook.set_selection(index);
+			if let (Some(tab), Some(position)) = (self.tabs.get(index), initial_position) {
+				let position = position.clamp(0, tab.text_ctrl.get_last_position());
+				tab.text_ctrl.set_insertion_point(position);
+				tab.text_ctrl.show_position(position);
+			}
 			return true;
 		}
 
@@ -143,64 +197,309 @@ impl DocumentManager {
 			}
 		}
 
-		let (password, forced_extension, render_tables_inline) = {
+		let (password, forced_extension, render_tables_inline, resume_position) = {
 			let config = self.config.lock().unwrap();
 			let path_str = path.to_string_lossy();
 			config.refresh_document_hash(&path_str);
 			let forced_extension = config.get_document_format(&path_str);
 			let password = config.get_document_password(&path_str);
 			let render_tables_inline = config.get_app_bool("render_tables_inline", true);
+			let resume_position = initial_position.unwrap_or_else(|| config.get_document_position(&path_str));
 			drop(config);
-			(password, forced_extension, render_tables_inline)
+			(password, forced_extension, render_tables_inline, resume_position)
 		};
-		let path_str = path.to_string_lossy().to_string();
 		tracing::info!(path = %path.display(), "opening document");
-		match DocumentSession::new(&path_str, &password, &forced_extension, render_tables_inline) {
-			Ok(session) => self.add_session_tab(self_rc, path, session, &password, track, title_override),
-			Err(err) => {
-				if err.starts_with(PASSWORD_REQUIRED_ERROR_PREFIX) {
+		self.next_load_id += 1;
+		let request = LoadRequest {
+			id: self.next_load_id,
+			path: path.to_path_buf(),
+			password,
+			forced_extension,
+			render_tables_inline,
+			cancelled: Arc::new(AtomicBool::new(false)),
+		};
+		let title = title_override.map_or_else(|| title_or_filename(String::new(), path), ToString::to_string);
+		let panel = Panel::builder(&self.notebook).build();
+		// TRANSLATORS: Shown in a document's tab while it is still being opened; {} is the file name
+		let loading_text = t("Loading {}...").replace("{}", &title);
+		let status_label = StaticText::builder(&panel).with_label(&loading_text).build();
+		let sizer = BoxSizer::builder(Orientation::Vertical).build();
+		sizer.add(&status_label, 0, SizerFlag::Expand | SizerFlag::All, 0);
+		panel.set_sizer(sizer, true);
+		self.notebook.add_page(&panel, &title, true, None);
+		self.loader.submit(request.clone());
+		if self.pending.is_empty() {
+			self.load_timer.start(LOAD_POLL_INTERVAL_MS, false);
+		}
+		self.pending.push(PendingLoad {
+			request,
+			panel,
+			status_label: Some(status_label),
+			preview: None,
+			preview_end: 0,
+			resume_position,
+			resume_reached: false,
+			track,
+			title_override: title_override.map(ToString::to_string),
+			initial_position,
+			password_retried: false,
+			outcome: None,
+		});
+		true
+	}
+
+	pub const fn load_timer(&self) -> &Timer {
+		&self.load_timer
+	}
+
+	pub const fn follow_timer(&self) -> &Timer {
+		&self.follow_timer
+	}
+
+	/// Starts or stops checking open text files for appended text.
+	pub fn set_following(&self, enabled: bool) {
+		if enabled {
+			self.follow_timer.start(FOLLOW_POLL_INTERVAL_MS, false);
+		} else {
+			self.follow_timer.stop();
+		}
+	}
+
+	/// Appends whatever has been written to followed files since the last poll. The caret stays where the reader left
+	/// it, unless "stay at end" is on and it was already at the end, in which case it moves to the new end.
+	pub fn poll_follows(&mut self) {
+		let stay_at_end = self.config.lock().unwrap().get_app_bool("follow_stay_at_end", false);
+		for tab in &mut self.tabs {
+			if !tab.session.supports_follow() {
+				continue;
+			}
+			match tab.session.poll_follow() {
+				FollowUpdate::Appended(text) => {
+					let caret = tab.text_ctrl.get_insertion_point();
+					let at_end = caret >= tab.text_ctrl.get_last_position();
+					tab.text_ctrl.append_text(&text);
+					if stay_at_end && at_end {
+						let end = tab.text_ctrl.get_last_position();
+						tab.text_ctrl.set_insertion_point(end);
+						tab.text_ctrl.show_position(end);
+					} else {
+						tab.text_ctrl.set_insertion_point(caret);
+					}
+				}
+				FollowUpdate::Truncated => {
+					// TRANSLATORS: Announced when a followed file is truncated or replaced; {} is the document title
+					let msg = t("{} was truncated; no longer following it.").replace("{}", &display_title(tab));
+					live_region::announce(self.live_region_label, &msg);
+				}
+				FollowUpdate::Unchanged => {}
+			}
+		}
+	}
+
+	pub const fn has_pending_loads(&self) -> bool {
+		!self.pending.is_empty()
+	}
+
+	/// Applies streamed chunks to loading previews, then turns finished parses into document tabs.
+	///
+	/// Each load is committed as soon as its parse finishes, so a small file is not held up behind a slow one requested
+	/// before it. Its page moves from among the pending placeholders to its place among the open tabs, which stay in
+	/// request order, so a restored session keeps its tab order. A load that needs a password prompts for it here and
+	/// is resubmitted. Returns the indices of the tabs that were opened.
+	pub fn poll_loads(&mut self, self_rc: &Rc<Mutex<Self>>) -> Vec<usize> {
+		while let Some(event) = self.loader.try_recv() {
+			match event {
+				LoadEvent::Chunk { id, chunk } => {
+					if let Some(load_index) = self.pending.iter().position(|load| load.request.id == id) {
+						self.append_preview_chunk(load_index, &chunk);
+					}
+				}
+				LoadEvent::Finished { id, outcome } => {
+					if let Some(load) = self.pending.iter_mut().find(|load| load.request.id == id) {
+						load.outcome = Some(outcome);
+					}
+				}
+			}
+		}
+		let mut opened = Vec::new();
+		let mut load_index = 0;
+		while load_index < self.pending.len() {
+			let Some(outcome) = self.pending[load_index].outcome.take() else {
+				load_index += 1;
+				continue;
+			};
+			let path = self.pending[load_index].request.path.clone();
+			match outcome {
+				Ok(session) => {
+					let page = self.commit_load(self_rc, load_index, session);
+					for index in &mut opened {
+						if *index >= page {
+							*index += 1;
+						}
+					}
+					opened.push(page);
+				}
+				Err(err)
+					if err.starts_with(PASSWORD_REQUIRED_ERROR_PREFIX)
+						&& !self.pending[load_index].password_retried =>
+				{
 					let config = self.config.lock().unwrap();
-					config.set_document_password(&path_str, "");
+					config.set_document_password(&path.to_string_lossy(), "");
 					drop(config);
-					let password = prompt_for_password(&self.notebook);
-					let Some(password) = password else {
+					let Some(password) = prompt_for_password(&self.notebook) else {
 						show_error_dialog(&self.notebook, &t("Password is required."), &t("Error"));
-						return false;
+						self.pending.remove(load_index);
+						self.remove_placeholder(load_index);
+						continue;
 					};
-					match DocumentSession::new(&path_str, &password, &forced_extension, render_tables_inline) {
-						Ok(session) => self.add_session_tab(self_rc, path, session, &password, track, title_override),
-						Err(retry_error) => {
-							tracing::error!(path = %path.display(), error = %retry_error, "failed to open document");
-							let message = build_document_load_error_message(path, &retry_error);
-							show_error_dialog(&self.notebook, &message, &t("Error"));
-							false
-						}
-					}
-				} else {
+					let load = &mut self.pending[load_index];
+					load.request.password = password;
+					load.password_retried = true;
+					self.loader.submit(load.request.clone());
+					load_index += 1;
+				}
+				Err(err) => {
 					tracing::error!(path = %path.display(), error = %err, "failed to open document");
-					let message = build_document_load_error_message(path, &err);
+					let message = build_document_load_error_message(&path, &err);
 					show_error_dialog(&self.notebook, &message, &t("Error"));
-					false
+					self.pending.remove(load_index);
+					self.remove_placeholder(load_index);
 				}
 			}
 		}
+		opened
 	}
 
-	pub fn add_session_tab(
+	/// Turns the pending load at `load_index` into a document tab for `session`, inserted after every tab requested
+	/// before it. Returns the tab's index.
+	fn commit_load(&mut self, self_rc: &Rc<Mutex<Self>>, load_index: usize, session: DocumentSession) -> usize {
+		let placeholder = self.tabs.len() + load_index;
+		let mut load = self.pending.remove(load_index);
+		if let Some(label) = load.status_label.take() {
+			label.destroy();
+		}
+		if let Some(preview) = load.preview.take() {
+			// Keep wherever the user has moved to while reading the preview.
+			if load.resume_reached {
+				load.initial_position = Some(preview.get_insertion_point());
+			}
+			preview.destroy();
+		}
+		let path = load.request.path.clone();
+		let title = load.title_override.clone().unwrap_or_else(|| title_or_filename(session.title(), &path));
+		let page = self.tabs.partition_point(|tab| tab.load_id < load.request.id);
+		if page == placeholder {
+			self.notebook.set_page_text(page, &title);
+		} else {
+			let selected = self.selected_page_index();
+			self.notebook.remove_page(placeholder);
+			self.notebook.insert_page(page, &load.panel, &title, selected == Some(placeholder), None);
+			// The pages between the tab's new place and its placeholder have each moved one to the right.
+			if let Some(selected) = selected.filter(|selected| (page..placeholder).contains(selected))
+				&& self.selected_page_index() != Some(selected + 1)
+			{
+				self.notebook.set_selection(selected + 1);
+			}
+		}
+		self.attach_session(self_rc, page, &load, session);
+		if let Some(position) = load.initial_position {
+			let tab = &self.tabs[page];
+			let position = position.clamp(0, tab.text_ctrl.get_last_position());
+			tab.text_ctrl.set_insertion_point(position);
+			tab.text_ctrl.show_position(position);
+		}
+		page
+	}
+
+	/// Appends a streamed chunk to the load's preview, creating the preview on the first chunk and moving its caret
+	/// to the saved reading position as soon as the text containing it has arrived.
+	fn append_preview_chunk(&mut self, load_index: usize, chunk: &DocumentChunk) {
+		let selected = self.selected_page_index() == Some(self.tabs.len() + load_index);
+		let load = &mut self.pending[load_index];
+		let preview = if let Some(preview) = load.preview {
+			preview
+		} else {
+			let config = self.config.lock().unwrap();
+			let wrap =
+				if config.get_app_bool("word_wrap", false) { TextCtrlStyle::WordWrap } else { TextCtrlStyle::DontWrap };
+			let preview = TextCtrl::builder(&load.panel)
+				.with_style(TextCtrlStyle::MultiLine | TextCtrlStyle::ReadOnly | TextCtrlStyle::Rich2 | wrap)
+				.build();
+			let rf = config.get_readability_font();
+			if let Some(font) = build_font_from_readability(&rf) {
+				preview.set_font(&font);
+			}
+			apply_foreground_color_to_ctrl(preview, rf.color);
+			apply_bg_color_to_ctrl(preview, config.get_bg_color());
+			drop(config);
+			if let Some(label) = load.status_label.take() {
+				label.destroy();
+			}
+			let sizer = BoxSizer::builder(Orientation::Vertical).build();
+			sizer.add(&preview, 1, SizerFlag::Expand | SizerFlag::All, 0);
+			load.panel.set_sizer(sizer, true);
+			load.panel.layout();
+			load.preview = Some(preview);
+			if selected {
+				preview.set_focus();
+			}
+			preview
+		};
+		// Appending moves the caret to the end; keep it where the reader left it.
+		let caret = preview.get_insertion_point();
+		preview.append_text(&chunk.text);
+		load.preview_end = chunk.start + display_len(&chunk.text);
+		if !load.resume_reached && usize::try_from(load.resume_position).unwrap_or(0) < load.preview_end {
+			load.resume_reached = true;
+			let position = load.resume_position.clamp(0, preview.get_last_position());
+			preview.set_insertion_point(position);
+			preview.show_position(position);
+		} else {
+			preview.set_insertion_point(caret);
+		}
+	}
+
+	/// Cancels the pending load at `load_index`; a parse already in flight finishes but its result is dropped.
+	fn cancel_load(&mut self, load_index: usize) -> bool {
+		let Some(load) = self.pending.get(load_index) else {
+			return false;
+		};
+		tracing::info!(path = %load.request.path.display(), "cancelling document load");
+		load.request.cancelled.store(true, Ordering::Relaxed);
+		let path_str = load.request.path.to_string_lossy();
+		let config = self.config.lock().unwrap();
+		config.remove_opened_document(&path_str);
+		config.flush();
+		drop(config);
+		self.pending.remove(load_index);
+		self.remove_placeholder(load_index);
+		true
+	}
+
+	/// Removes the notebook page of a placeholder that is no longer in `pending`.
+	fn remove_placeholder(&self, load_index: usize) {
+		let index = self.tabs.len() + load_index;
+		self.notebook.remove_page(index);
+		let count = self.tabs.len() + self.pending.len();
+		if count > 0 {
+			self.notebook.set_selection(index.min(count - 1));
+		}
+		if self.pending.is_empty() {
+			self.load_timer.stop();
+		}
+	}
+
+	/// Fills the panel of `load` (already the notebook page at `tab_index`) with a text control for `session` and
+	/// registers the tab there, restoring its saved position and history.
+	fn attach_session(
 		&mut self,
 		self_rc: &Rc<Mutex<Self>>,
-		path: &Path,
+		tab_index: usize,
+		load: &PendingLoad,
 		session: DocumentSession,
-		password: &str,
-		track: bool,
-		title_override: Option<&str>,
-	) -> bool {
-		if let Some(index) = self.find_tab_by_path(path) {
-			self.notebook.set_selection(index);
-			return true;
-		}
-		let title = title_override.map_or_else(|| title_or_filename(session.title(), path), ToString::to_string);
-		let panel = Panel::builder(&self.notebook).build();
+	) {
+		let panel = load.panel;
+		let path = load.request.path.as_path();
 		let config = self.config.lock().unwrap();
 		let mut session = session;
 		let word_wrap = config.get_app_bool("word_wrap", false);
@@ -226,15 +525,17 @@ impl DocumentManager {
 			config.get_letter_spacing(),
 			config.get_text_alignment(),
 		);
-		self.notebook.add_page(&panel, &title, true, None);
+		panel.layout();
 		let path_str = path.to_string_lossy();
 		let nav_history = config.get_navigation_history(&path_str);
 		session.set_history(&nav_history.positions, nav_history.index);
-		self.tabs.push(DocumentTab { panel, text_ctrl, session, file_path: path.to_path_buf(), track });
-		if !password.is_empty() {
-			config.set_document_password(&path_str, password);
+		let track = load.track;
+		let tab =
+			DocumentTab { panel, text_ctrl, session, file_path: path.to_path_buf(), track, load_id: load.request.id };
+		self.tabs.insert(tab_index, tab);
+		if !load.request.password.is_empty() {
+			config.set_document_password(&path_str, &load.request.password);
 		}
-		let tab_index = self.tabs.len() - 1;
 		let max_pos = self.tabs[tab_index].text_ctrl.get_last_position();
 		let saved_pos = config.get_validated_document_position(&path_str, max_pos);
 		let initial_pos = if saved_pos >= 0 {
@@ -253,12 +554,11 @@ impl DocumentManager {
 			config.add_opened_document(&path_str);
 		}
 		config.flush();
-		true
 	}
 
 	pub fn close_document(&mut self, index: usize, save_state: bool) -> bool {
-		if index >= self.tabs.len() {
-			return false;
+		if let Some(load_index) = index.checked_sub(self.tabs.len()) {
+			return self.cancel_load(load_index);
 		}
 		if let Some(tab) = self.tabs.get(index) {
 			tracing::info!(path = %tab.file_path.display(), "closing document");
@@ -278,7 +578,7 @@ impl DocumentManager {
 		let _page = self.notebook.get_page(index);
 		self.notebook.remove_page(index);
 		self.tabs.remove(index);
-		let count = self.tabs.len();
+		let count = self.tabs.len() + self.pending.len();
 		if count > 0 {
 			let new_index = index.min(count - 1);
 			self.notebook.set_selection(new_index);
@@ -299,6 +599,9 @@ impl DocumentManager {
 		while !self.tabs.is_empty() {
 			self.close_document(0, true);
 		}
+		while !self.pending.is_empty() {
+			self.cancel_load(0);
+		}
 	}
 
 	pub fn save_all_positions(&self) {
@@ -313,7 +616,8 @@ impl DocumentManager {
 			let (history, history_index) = tab.session.get_history();
 			config.set_navigation_history(&path_str, history, history_index);
 		}
-		config.flush();
+		// Called on the way out, and exiting from the menu ends the process without dropping the config.
+		config.sync();
 	}
 
 	pub fn save_position_throttled(&self) {
@@ -335,11 +639,17 @@ impl DocumentManager {
 		self.last_position_save.set(Some(now));
 	}
 
-	pub fn active_tab_index(&self) -> Option<usize> {
+	/// Index of the selected notebook page, which may be a document that is still loading.
+	pub fn selected_page_index(&self) -> Option<usize> {
 		let selection = self.notebook.selection();
 		if selection >= 0 { usize::try_from(selection).ok() } else { None }
 	}
 
+	/// Index of the selected document tab; `None` while a loading page is selected.
+	pub fn active_tab_index(&self) -> Option<usize> {
+		self.selected_page_index().filter(|&index| index < self.tabs.len())
+	}
+
 	pub fn active_tab(&self) -> Option<&DocumentTab> {
 		self.active_tab_index().and_then(|i| self.tabs.get(i))
 	}
@@ -360,9 +670,14 @@ impl DocumentManager {
 		self.tabs.iter().map(|tab| tab.file_path.to_string_lossy().to_string()).collect()
 	}
 
+	/// Returns the notebook page showing `path`, including a page whose document is still loading.
 	pub fn find_tab_by_path(&self, path: &Path) -> Option<usize> {
 		let target = normalized_path_key(path);
-		self.tabs.iter().position(|tab| normalized_path_key(&tab.file_path) == target)
+		self.tabs
+			.iter()
+			.map(|tab| tab.file_path.as_path())
+			.chain(self.pending.iter().map(|load| load.request.path.as_path()))
+			.position(|tab_path| normalized_path_key(tab_path) == target)
 	}
 
 	pub fn restore_focus(&self) {
@@ -459,25 +774,13 @@ impl DocumentManager {
 		if prev == position {
 			return;
 		}
-		let path_str = tab.file_path.to_string_lossy().to_string();
-		let bookmarks = config.get_bookmarks(&path_str);
+		let path_str = tab.file_path.to_string_lossy();
+		let (has_bookmark, has_note) = config.with_bookmark_index(&path_str, |index| {
+			index.entered(prev, position).fold((false, false), |(has_bookmark, has_note), bm| {
+				(has_bookmark || bm.note.is_empty(), has_note || !bm.note.is_empty())
+			})
+		});
 		drop(config);
-
-		let mut has_note = false;
-		let mut has_bookmark = false;
-		for bm in &bookmarks {
-			let was_inside = if bm.start == bm.end { prev == bm.start } else { prev >= bm.start && prev < bm.end };
-			let is_inside =
-				if bm.start == bm.end { position == bm.start } else { position >= bm.start && position < bm.end };
-			let triggered = is_inside && !was_inside;
-			if triggered {
-				if bm.note.is_empty() {
-					has_bookmark = true;
-				} else {
-					has_note = true;
-				}
-			}
-		}
 		if has_note || has_bookmark {
 			super::sounds::play_bookmark_sound(has_note);
 		}
@@ -5,7 +5,7 @@ use paperback_core::{config::ConfigManager, reader_core, util::text::display_len
 use patois::t;
 use wxdragon::prelude::*;
 
-use super::document_manager::DocumentManager;
+use super::{dialogs, document_manager::DocumentManager};
 
 const DIALOG_PADDING: i32 = 10;
 const MAX_FIND_HISTORY_SIZE: usize = 10;
@@ -32,6 +32,11 @@ pub fn find_text_with_wrap(haystack: &str, needle: &str, start: i64, options: Fi
 	if needle.is_empty() {
 		return SearchResult::default();
 	}
+	let result = reader_core::reader_search_with_wrap(haystack, needle, start, search_options(options));
+	SearchResult { found: result.found, wrapped: result.wrapped, position: result.position }
+}
+
+fn search_options(options: FindOptions) -> reader_core::SearchOptions {
 	let mut search_options = reader_core::SearchOptions::empty();
 	if options.contains(FindOptions::FORWARD) {
 		search_options |= reader_core::SearchOptions::FORWARD;
@@ -45,8 +50,7 @@ pub fn find_text_with_wrap(haystack: &str, needle: &str, start: i64, options: Fi
 	if options.contains(FindOptions::USE_REGEX) {
 		search_options |= reader_core::SearchOptions::REGEX;
 	}
-	let result = reader_core::reader_search_with_wrap(haystack, needle, start, search_options);
-	SearchResult { found: result.found, wrapped: result.wrapped, position: result.position }
+	search_options
 }
 
 #[derive(Clone)]
@@ -75,6 +79,7 @@ impl FindDialogState {
 			use_regex,
 			find_prev_btn,
 			find_next_btn,
+			find_all_btn,
 			cancel_btn,
 		} = build_find_dialog_ui(dialog);
 		bind_find_dialog_actions(FindDialogActionParams {
@@ -83,6 +88,7 @@ impl FindDialogState {
 			find_combo,
 			find_prev_btn,
 			find_next_btn,
+			find_all_btn,
 			cancel_btn,
 			config: Rc::clone(config),
 			doc_manager: Rc::clone(doc_manager),
@@ -141,6 +147,23 @@ impl FindDialogState {
 		self.find_combo.set_text_selection(0, len);
 	}
 
+	fn find_options(&self, forward: bool) -> FindOptions {
+		let mut options = FindOptions::default();
+		if forward {
+			options |= FindOptions::FORWARD;
+		}
+		if self.match_case.is_checked() {
+			options |= FindOptions::MATCH_CASE;
+		}
+		if self.whole_word.is_checked() {
+			options |= FindOptions::MATCH_WHOLE_WORD;
+		}
+		if self.use_regex.is_checked() {
+			options |= FindOptions::USE_REGEX;
+		}
+		options
+	}
+
 	pub fn try_begin_find(&self) -> Option<FindInProgressGuard> {
 		if self.in_progress.replace(true) {
 			return None;
@@ -156,6 +179,7 @@ struct FindDialogWidgets {
 	use_regex: CheckBox,
 	find_prev_btn: Button,
 	find_next_btn: Button,
+	find_all_btn: Button,
 	cancel_btn: Button,
 }
 
@@ -165,6 +189,7 @@ struct FindDialogActionParams {
 	find_combo: ComboBox,
 	find_prev_btn: Button,
 	find_next_btn: Button,
+	find_all_btn: Button,
 	cancel_btn: Button,
 	config: Rc<Mutex<ConfigManager>>,
 	doc_manager: Rc<Mutex<DocumentManager>>,
@@ -190,6 +215,8 @@ fn build_find_dialog_ui(dialog: Dialog) -> FindDialogWidgets {
 	options_box.add(&use_regex, 0, SizerFlag::All, option_padding);
 	let find_prev_btn = Button::builder(&dialog).with_label(&t("Find &Previous")).build();
 	let find_next_btn = Button::builder(&dialog).with_id(ID_OK).with_label(&t("Find &Next")).build();
+	// TRANSLATORS: Label for the button that lists every match of the search in the Find dialog
+	let find_all_btn = Button::builder(&dialog).with_label(&t("Find &All")).build();
 	let cancel_btn = Button::builder(&dialog).with_id(ID_CANCEL).with_label(&t("Cancel")).build();
 	dialog.set_escape_id(ID_CANCEL);
 	dialog.set_affirmative_id(ID_OK);
@@ -199,6 +226,7 @@ fn build_find_dialog_ui(dialog: Dialog) -> FindDialogWidgets {
 	let button_sizer = BoxSizer::builder(Orientation::Horizontal).build();
 	button_sizer.add(&find_prev_btn, 0, SizerFlag::Right, button_spacing);
 	button_sizer.add(&find_next_btn, 0, SizerFlag::Right, button_spacing);
+	button_sizer.add(&find_all_btn, 0, SizerFlag::Right, button_spacing);
 	button_sizer.add_stretch_spacer(1);
 	button_sizer.add(&cancel_btn, 0, SizerFlag::All, 0);
 	let main_sizer = BoxSizer::builder(Orientation::Vertical).build();
@@ -217,7 +245,16 @@ fn build_find_dialog_ui(dialog: Dialog) -> FindDialogWidgets {
 	);
 	dialog.set_sizer_and_fit(main_sizer, true);
 	dialog.centre();
-	FindDialogWidgets { find_combo, match_case, whole_word, use_regex, find_prev_btn, find_next_btn, cancel_btn }
+	FindDialogWidgets {
+		find_combo,
+		match_case,
+		whole_word,
+		use_regex,
+		find_prev_btn,
+		find_next_btn,
+		find_all_btn,
+		cancel_btn,
+	}
 }
 
 fn bind_find_dialog_actions(params: FindDialogActionParams) {
@@ -227,6 +264,7 @@ fn bind_find_dialog_actions(params: FindDialogActionParams) {
 		find_combo,
 		find_prev_btn,
 		find_next_btn,
+		find_all_btn,
 		cancel_btn,
 		config,
 		doc_manager,
@@ -261,6 +299,13 @@ fn bind_find_dialog_actions(params: FindDialogActionParams) {
 			false,
 		);
 	});
+	let frame_for_all = frame;
+	let find_dialog_for_all = Rc::clone(&find_dialog);
+	let doc_manager_for_all = Rc::clone(&doc_manager);
+	let config_for_all = Rc::clone(&config);
+	find_all_btn.on_click(move |_| {
+		handle_find_all(&frame_for_all, &doc_manager_for_all, &config_for_all, &find_dialog_for_all);
+	});
 	let dialog_for_cancel = dialog;
 	let find_dialog_for_cancel = Rc::clone(&find_dialog);
 	let config_for_cancel = Rc::clone(&config);
@@ -396,20 +441,13 @@ fn do_find(
 	config: &Rc<Mutex<ConfigManager>>,
 	live_region_label: StaticText,
 ) {
-	let (text_ctrl, raw_text) = {
+	let text_ctrl = {
 		let dm = doc_manager.lock().unwrap();
 		match dm.active_tab() {
-			Some(tab) => (tab.text_ctrl, tab.session.content()),
+			Some(tab) => tab.text_ctrl,
 			None => return,
 		}
 	};
-	// On Windows the Rich Edit control normalizes line endings to \n, so
-	// positions from get_selection() / set_selection() are in \n-only space.
-	// session.content() may contain raw \r\n (e.g. Windows .txt files), which
-	// would cause search positions to drift by one per newline after the first
-	// match.  Normalize to \n so the haystack coordinate system matches the
-	// text control's coordinate system.
-	let text = if raw_text.contains('\r') { raw_text.replace("\r\n", "\n").replace('\r', "\n") } else { raw_text };
 	if !text_ctrl.is_valid() {
 		return;
 	}
@@ -422,22 +460,31 @@ fn do_find(
 	};
 	state.save_settings(config);
 	state.add_to_history(config, &query);
-	let mut options = FindOptions::default();
-	if forward {
-		options |= FindOptions::FORWARD;
-	}
-	if state.match_case.is_checked() {
-		options |= FindOptions::MATCH_CASE;
-	}
-	if state.whole_word.is_checked() {
-		options |= FindOptions::MATCH_WHOLE_WORD;
-	}
-	if state.use_regex.is_checked() {
-		options |= FindOptions::USE_REGEX;
-	}
+	let options = state.find_options(forward);
 	let (sel_start, sel_end) = text_ctrl.get_selection();
 	let start_pos = if forward { sel_end } else { sel_start };
-	let result = find_text_with_wrap(&text, &query, start_pos, options);
+	let result = {
+		let dm = doc_manager.lock().unwrap();
+		let Some(tab) = dm.active_tab() else {
+			return;
+		};
+		let buffer = &tab.session.handle().document().buffer;
+		if buffer.has_carriage_returns() {
+			// On Windows the Rich Edit control normalizes line endings to \n, so
+			// positions from get_selection() / set_selection() are in \n-only space.
+			// The content may contain raw \r\n (e.g. Windows .txt files), which
+			// would cause search positions to drift by one per newline after the first
+			// match.  Normalize to \n so the haystack coordinate system matches the
+			// text control's coordinate system.
+			let text = buffer.content.replace("\r\n", "\n").replace('\r', "\n");
+			find_text_with_wrap(&text, &query, start_pos, options)
+		} else {
+			// The session caches the compiled query and its match positions, so repeated
+			// find next/previous is a binary search instead of a rescan.
+			let result = tab.session.search(&query, start_pos, search_options(options));
+			SearchResult { found: result.found, wrapped: result.wrapped, position: result.position }
+		}
+	};
 	tracing::debug!(query = %query, forward, found = result.found, wrapped = result.wrapped, "find search");
 	if !result.found {
 		live_region::announce(live_region_label, &t("Not found."));
@@ -464,3 +511,71 @@ fn do_find(
 	text_ctrl.show_position(start);
 	state.dialog.show(false);
 }
+
+fn handle_find_all(
+	frame: &Frame,
+	doc_manager: &Rc<Mutex<DocumentManager>>,
+	config: &Rc<Mutex<ConfigManager>>,
+	find_dialog: &Rc<Mutex<Option<FindDialogState>>>,
+) {
+	let state = {
+		let dialog_state = find_dialog.lock().unwrap();
+		dialog_state.as_ref().cloned()
+	};
+	let Some(state) = state else {
+		return;
+	};
+	let query = state.find_text();
+	if query.trim().is_empty() {
+		state.focus_find_text();
+		return;
+	}
+	let Some(_find_guard) = state.try_begin_find() else {
+		return;
+	};
+	state.save_settings(config);
+	state.add_to_history(config, &query);
+	let options = search_options(state.find_options(true));
+	// The document manager stays unlocked while the results dialog runs its modal loop, so timers and other handlers
+	// that lock it keep working. The tab is looked up again by path for the jump.
+	let (search, file_path) = {
+		let dm = doc_manager.lock().unwrap();
+		let Some(tab) = dm.active_tab() else {
+			return;
+		};
+		if !tab.text_ctrl.is_valid() {
+			return;
+		}
+		(dialogs::start_find_all(&tab.session, &query, options), tab.file_path.clone())
+	};
+	state.dialog.show(false);
+	let Some(hit) = dialogs::show_find_results_dialog(frame, search) else {
+		state.dialog.show(true);
+		state.focus_find_text();
+		return;
+	};
+	let mut dm = doc_manager.lock().unwrap();
+	let Some(tab) = dm.active_tab_mut().filter(|tab| tab.file_path == file_path && tab.text_ctrl.is_valid()) else {
+		return;
+	};
+	tracing::debug!(query = %query, position = hit.position, "find all jump");
+	let (start, end) = {
+		// The text control counts \r\n as a single \n (see do_find), so drop the \r units before each end.
+		let buffer = &tab.session.handle().document().buffer;
+		let control_position = |position: i64| {
+			let byte = buffer.byte_index_for_display(usize::try_from(position.max(0)).unwrap_or(0));
+			position - i64::try_from(buffer.content[..byte].matches("\r\n").count()).unwrap_or(0)
+		};
+		(control_position(hit.position), control_position(hit.position + hit.length))
+	};
+	let last_pos = tab.text_ctrl.get_last_position();
+	let start = start.clamp(0, last_pos.max(0));
+	let end = end.clamp(start, last_pos.max(start));
+	tab.text_ctrl.set_focus();
+	tab.text_ctrl.set_selection(start, end);
+	tab.text_ctrl.show_position(start);
+	tab.session.check_and_record_history(start);
+	let (history, history_index) = tab.session.get_history();
+	let path_str = tab.file_path.to_string_lossy();
+	config.lock().unwrap().set_navigation_history(&path_str, history, history_index);
+}
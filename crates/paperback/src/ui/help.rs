@@ -129,7 +129,7 @@ pub fn handle_view_help_paperback(
 	if !ensure_parser_ready_for_path(frame, &path, config) {
 		return false;
 	}
-	doc_manager.lock().unwrap().open_help_file(doc_manager, &path)
+	doc_manager.lock().unwrap().open_help_file(&path)
 }
 
 pub fn handle_donate(frame: &Frame) {
@@ -206,6 +206,8 @@ impl MainWindow {
 				}
 			});
 		}
+		Self::bind_document_loads(frame, &doc_manager, &config);
+		Self::bind_document_follows(&doc_manager);
 		Self::schedule_restore_documents(frame, Rc::clone(&doc_manager), Rc::clone(&config));
 		Self {
 			frame,
@@ -243,7 +245,7 @@ impl MainWindow {
 		if !self.ensure_parser_ready(path) {
 			return false;
 		}
-		let result = self.doc_manager.lock().unwrap().open_file(&self.doc_manager, path);
+		let result = self.doc_manager.lock().unwrap().open_file(path);
 		if result {
 			self.update_title();
 			self.update_recent_documents_menu();
@@ -435,6 +437,45 @@ impl MainWindow {
 		menu::update_reopen_state(&self.frame, has_reopen);
 	}
 
+	/// Polls the document manager's background loads, refreshing the title and menus whenever a tab finishes
+	/// opening. Focus only moves into a new tab if it is the one the user is looking at.
+	fn bind_document_loads(frame: Frame, doc_manager: &Rc<Mutex<DocumentManager>>, config: &Rc<Mutex<ConfigManager>>) {
+		let dm = Rc::clone(doc_manager);
+		let config = Rc::clone(config);
+		doc_manager.lock().unwrap().load_timer().on_tick(move |_| {
+			let Ok(mut dm_ref) = dm.try_lock() else {
+				return;
+			};
+			let opened = dm_ref.poll_loads(&dm);
+			if !dm_ref.has_pending_loads() {
+				dm_ref.load_timer().stop();
+			}
+			if opened.is_empty() {
+				return;
+			}
+			update_title_from_manager(&frame, &dm_ref);
+			if dm_ref.active_tab_index().is_some_and(|index| opened.contains(&index)) {
+				dm_ref.restore_focus();
+			}
+			let has_reopen = dm_ref.has_recently_closed();
+			drop(dm_ref);
+			let menu_bar = menu::create_menu_bar(&config.lock().unwrap());
+			frame.set_menu_bar(menu_bar);
+			menu::update_menu_item_states(&frame, true);
+			menu::update_reopen_state(&frame, has_reopen);
+		});
+	}
+
+	/// Polls open text files for appended text while follow mode is on.
+	fn bind_document_follows(doc_manager: &Rc<Mutex<DocumentManager>>) {
+		let dm = Rc::clone(doc_manager);
+		doc_manager.lock().unwrap().follow_timer().on_tick(move |_| {
+			if let Ok(mut dm_ref) = dm.try_lock() {
+				dm_ref.poll_follows();
+			}
+		});
+	}
+
 	fn schedule_restore_documents(
 		frame: Frame,
 		doc_manager: Rc<Mutex<DocumentManager>>,
@@ -461,7 +502,7 @@ impl MainWindow {
 			}
 			state.restored = true;
 			drop(state);
-			let pre_restore_active = doc_manager.lock().unwrap().active_tab_index();
+			let pre_restore_active = doc_manager.lock().unwrap().selected_page_index();
 			let active_path = config.lock().unwrap().get_app_string("active_document", "");
 			let paths = config.lock().unwrap().get_opened_documents_existing();
 			tracing::info!(count = paths.len(), "restoring previously open documents");
@@ -470,7 +511,7 @@ impl MainWindow {
 				if !ensure_parser_ready_for_path(&frame, path, &config) {
 					continue;
 				}
-				let _ = doc_manager.lock().unwrap().open_file_restore(&doc_manager, path);
+				let _ = doc_manager.lock().unwrap().open_file_restore(path);
 			}
 			let mut target_idx = pre_restore_active;
 			if target_idx.is_none() && !active_path.is_empty() {
@@ -505,7 +546,7 @@ impl MainWindow {
 			if !ensure_parser_ready_for_path(frame, path, config) {
 				return;
 			}
-			if doc_manager.lock().unwrap().open_file(doc_manager, path) {
+			if doc_manager.lock().unwrap().open_file(path) {
 				let Ok(dm_ref) = doc_manager.try_lock() else {
 					return;
 				};
@@ -622,7 +663,7 @@ impl MainWindow {
 							dm.lock().unwrap().push_recently_closed(path);
 							return;
 						}
-						if dm.lock().unwrap().open_file(&dm, &path) {
+						if dm.lock().unwrap().open_file(&path) {
 							let dm_ref = dm.lock().unwrap();
 							update_title_from_manager(&frame_copy, &dm_ref);
 							dm_ref.restore_focus();
@@ -994,6 +1035,35 @@ impl MainWindow {
 					live_region::announce(live_region_label, &msg);
 					dm.lock().unwrap().restore_focus();
 				}
+				menu_ids::TOGGLE_FOLLOW => {
+					let new_state = {
+						let cfg = config.lock().unwrap();
+						let v = !cfg.get_app_bool("follow_files", false);
+						cfg.set_app_bool("follow_files", v);
+						cfg.flush();
+						v
+					};
+					dm.lock().unwrap().set_following(new_state);
+					if let Some(menu_bar) = frame_copy.get_menu_bar() {
+						menu_bar.check_item(menu_ids::TOGGLE_FOLLOW, new_state);
+					}
+					let msg = if new_state { t("Following growing files.") } else { t("Not following growing files.") };
+					live_region::announce(live_region_label, &msg);
+				}
+				menu_ids::TOGGLE_FOLLOW_STAY_AT_END => {
+					let new_state = {
+						let cfg = config.lock().unwrap();
+						let v = !cfg.get_app_bool("follow_stay_at_end", false);
+						cfg.set_app_bool("follow_stay_at_end", v);
+						cfg.flush();
+						v
+					};
+					if let Some(menu_bar) = frame_copy.get_menu_bar() {
+						menu_bar.check_item(menu_ids::TOGGLE_FOLLOW_STAY_AT_END, new_state);
+					}
+					let msg = if new_state { t("Stay at end on.") } else { t("Stay at end off.") };
+					live_region::announce(live_region_label, &msg);
+				}
 				menu_ids::VIEW_NOTE_TEXT => {
 					navigation::handle_view_note_text(&frame_copy, &dm, &config);
 				}
@@ -1413,14 +1483,7 @@ impl MainWindow {
 					match outcome {
 						Some(Some((view, orig_name))) => {
 							let title = format!("{} {orig_name}", t("Source:"));
-							let opened = dm.lock().unwrap().open_source_file(&dm, Path::new(&view.path), &title);
-							if opened {
-								let dm_ref = dm.lock().unwrap();
-								if let Some(tab) = dm_ref.active_tab() {
-									tab.text_ctrl.set_insertion_point(view.caret);
-									tab.text_ctrl.show_position(view.caret);
-								}
-							}
+							dm.lock().unwrap().open_source_file(Path::new(&view.path), &title, view.caret);
 						}
 						unavailable => {
 							let message = if unavailable.is_none() {
@@ -1648,7 +1711,7 @@ impl MainWindow {
 							if !ensure_parser_ready_for_path(&frame_copy, path, &config) {
 								return;
 							}
-							if dm.lock().unwrap().open_file(&dm, path) {
+							if dm.lock().unwrap().open_file(path) {
 								{
 									let dm_ref = dm.lock().unwrap();
 									update_title_from_manager(&frame_copy, &dm_ref);
@@ -1692,7 +1755,7 @@ impl MainWindow {
 							if !ensure_parser_ready_for_path(&frame_copy, path, &config) {
 								return;
 							}
-							if dm.lock().unwrap().open_file(&dm, path) {
+							if dm.lock().unwrap().open_file(path) {
 								{
 									let dm_ref = dm.lock().unwrap();
 									update_title_from_manager(&frame_copy, &dm_ref);
@@ -1790,7 +1853,7 @@ fn ensure_parser_for_unknown_file(parent: &Frame, path: &Path, config: &ConfigMa
 /// and this function announces the new focus itself instead, before the focus change
 /// actually happens.
 fn close_active_document_announced(dm: &mut DocumentManager, live_region_label: StaticText) {
-	let Some(index) = dm.active_tab_index() else {
+	let Some(index) = dm.selected_page_index() else {
 		return;
 	};
 	let next = dm.active_index_after_closing(index).and_then(|i| dm.get_tab(i)).map(display_title);
@@ -811,6 +811,18 @@ pub fn create_tools_menu(config: &ConfigManager) -> Menu {
 	let word_wrap_help = t("Toggle word wrap");
 	menu.append(menu_ids::TOGGLE_WORD_WRAP, &word_wrap_label, &word_wrap_help, ItemKind::Check);
 	menu.check_item(menu_ids::TOGGLE_WORD_WRAP, config.get_app_bool("word_wrap", false));
+	// TRANSLATORS: Menu item label for showing text appended to open text and log files as they grow
+	let follow_label = t("Fo&llow growing files");
+	// TRANSLATORS: Status bar help text for the "Follow growing files" menu item
+	let follow_help = t("Show text appended to open text and log files");
+	menu.append(menu_ids::TOGGLE_FOLLOW, &follow_label, &follow_help, ItemKind::Check);
+	menu.check_item(menu_ids::TOGGLE_FOLLOW, config.get_app_bool("follow_files", false));
+	// TRANSLATORS: Menu item label for keeping the caret at the end of a followed file as text is appended
+	let stay_at_end_label = t("Stay at en&d while following");
+	// TRANSLATORS: Status bar help text for the "Stay at end while following" menu item
+	let stay_at_end_help = t("Move to new text when the cursor is at the end of a followed file");
+	menu.append(menu_ids::TOGGLE_FOLLOW_STAY_AT_END, &stay_at_end_label, &stay_at_end_help, ItemKind::Check);
+	menu.check_item(menu_ids::TOGGLE_FOLLOW_STAY_AT_END, config.get_app_bool("follow_stay_at_end", false));
 	menu.append_separator();
 	// TRANSLATORS: Menu item label to open the application options/preferences dialog
 	let options_label = t("&Options\tCtrl+,");
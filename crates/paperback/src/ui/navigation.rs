@@ -365,9 +365,8 @@ pub fn handle_bookmark_navigation(
 		let path_str = tab.file_path.to_string_lossy().to_string();
 		let (result, has_items) = {
 			let cfg = config.lock().unwrap();
-			let bookmarks = cfg.get_bookmarks(&path_str);
-			let has_items =
-				if notes_only { bookmarks.iter().any(|bm| !bm.note.is_empty()) } else { !bookmarks.is_empty() };
+			let has_items = cfg
+				.with_bookmark_index(&path_str, |index| if notes_only { index.has_notes() } else { !index.is_empty() });
 			let result = if notes_only {
 				tab.session.navigate_note(&cfg, current_pos, wrap, next)
 			} else {
@@ -497,7 +496,7 @@ pub fn handle_toggle_bookmark(
 		(start, end, path_str)
 	};
 	let cfg = config.lock().unwrap();
-	let existed = cfg.get_bookmarks(&path_str).iter().any(|bm| bm.start == start && bm.end == end);
+	let existed = cfg.with_bookmark_index(&path_str, |index| index.starting_at(start).any(|bm| bm.end == end));
 	cfg.toggle_bookmark(&path_str, start, end, "");
 	cfg.flush();
 	drop(cfg);
@@ -526,7 +525,7 @@ pub fn handle_bookmark_with_note(
 	};
 	let existing = {
 		let cfg = config.lock().unwrap();
-		cfg.get_bookmarks(&path_str).into_iter().find(|bm| bm.start == start && bm.end == end)
+		cfg.with_bookmark_index(&path_str, |index| index.starting_at(start).find(|bm| bm.end == end).cloned())
 	};
 	let existing_note = existing.as_ref().map(|bm| bm.note.clone()).unwrap_or_default();
 	let Some(note) =